@@ -0,0 +1,227 @@
+#include "core/container/Collection.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+	using Collection = core::container::Collection
+	<
+		unsigned int,
+		utility::heap_storage_traits,
+		utility::heap_storage<int>
+	>;
+
+	// what the lookup used to be, for comparison
+	//
+	// it gives up after a handful of probes and grows the table
+	// instead, with sequential keys it already needs a table of 32M
+	// buckets to hold 10k keys, and goes out of memory not long after
+	class OldLookup
+	{
+	private:
+		std::vector<unsigned int> keys_;
+
+	public:
+		bool emplace(unsigned int key)
+		{
+			while (true)
+			{
+				const auto bucket = find_bucket(0, key);
+				if (bucket != std::size_t(-1))
+				{
+					keys_[bucket] = key;
+					return true;
+				}
+
+				if (!grow(keys_.empty() ? 1 : keys_.size() * 2))
+					return false;
+			}
+		}
+
+		bool contains(unsigned int key) const
+		{
+			return find_bucket(key, key) != std::size_t(-1);
+		}
+
+	private:
+		std::size_t find_bucket(unsigned int key, unsigned int hash_key) const
+		{
+			const auto nkeys = keys_.size();
+			if (nkeys == 0)
+				return std::size_t(-1);
+
+			const auto first_bucket = (std::size_t(hash_key) * hash_key) % nkeys;
+			auto bucket = first_bucket;
+			for (std::size_t count = 0; keys_[bucket] != key;)
+			{
+				if (count >= 4)
+					return std::size_t(-1);
+
+				count++;
+				bucket = (first_bucket + count * count) % nkeys;
+			}
+			return bucket;
+		}
+
+		bool grow(std::size_t size)
+		{
+			std::vector<unsigned int> old_keys;
+			old_keys.swap(keys_);
+
+			for (; size <= (std::size_t(1) << 26); size *= 2)
+			{
+				keys_.assign(size, 0);
+
+				bool fits = true;
+				for (auto key : old_keys)
+				{
+					if (key == 0)
+						continue;
+
+					const auto bucket = find_bucket(0, key);
+					if (bucket == std::size_t(-1))
+					{
+						fits = false;
+						break;
+					}
+					keys_[bucket] = key;
+				}
+				if (fits)
+					return true;
+			}
+			return false;
+		}
+	};
+
+	// entities and tokens are handed out in order
+	std::vector<unsigned int> make_keys(unsigned int count)
+	{
+		std::vector<unsigned int> keys(count);
+		for (unsigned int i = 0; i < count; i++)
+		{
+			keys[i] = i + 1;
+		}
+		return keys;
+	}
+
+	void benchmark_collection(const std::vector<unsigned int> & keys)
+	{
+		const auto count = std::to_string(keys.size());
+
+		BENCHMARK_ADVANCED("emplace " + count + " Collection")(Catch::Benchmark::Chronometer meter)
+		{
+			std::vector<Collection> collections(meter.runs());
+			meter.measure([&](int i)
+			              {
+				              int emplaced = 0;
+				              for (auto key : keys)
+				              {
+					              emplaced += collections[i].emplace<int>(key, 0) != nullptr;
+				              }
+				              return emplaced;
+			              });
+		};
+
+		BENCHMARK_ADVANCED("find " + count + " Collection")(Catch::Benchmark::Chronometer meter)
+		{
+			Collection collection;
+			for (auto key : keys)
+			{
+				REQUIRE(collection.emplace<int>(key, 0));
+			}
+
+			meter.measure([&]()
+			              {
+				              int found = 0;
+				              for (auto key : keys)
+				              {
+					              found += find(collection, key) != collection.end();
+				              }
+				              return found;
+			              });
+		};
+
+		BENCHMARK_ADVANCED("emplace " + count + " std::unordered_map")(Catch::Benchmark::Chronometer meter)
+		{
+			std::vector<std::unordered_map<unsigned int, int>> maps(meter.runs());
+			meter.measure([&](int i)
+			              {
+				              for (auto key : keys)
+				              {
+					              maps[i].emplace(key, 0);
+				              }
+			              });
+		};
+
+		BENCHMARK_ADVANCED("find " + count + " std::unordered_map")(Catch::Benchmark::Chronometer meter)
+		{
+			std::unordered_map<unsigned int, int> map;
+			for (auto key : keys)
+			{
+				map.emplace(key, 0);
+			}
+
+			meter.measure([&]()
+			              {
+				              int found = 0;
+				              for (auto key : keys)
+				              {
+					              found += map.find(key) != map.end();
+				              }
+				              return found;
+			              });
+		};
+	}
+}
+
+TEST_CASE("collection lookup with 10k keys", "")
+{
+	const auto keys = make_keys(10000);
+
+	benchmark_collection(keys);
+
+	BENCHMARK_ADVANCED("emplace 10000 old lookup")(Catch::Benchmark::Chronometer meter)
+	{
+		std::vector<OldLookup> lookups(meter.runs());
+		meter.measure([&](int i)
+		              {
+			              for (auto key : keys)
+			              {
+				              lookups[i].emplace(key);
+			              }
+		              });
+	};
+
+	BENCHMARK_ADVANCED("find 10000 old lookup")(Catch::Benchmark::Chronometer meter)
+	{
+		OldLookup lookup;
+		for (auto key : keys)
+		{
+			lookup.emplace(key);
+		}
+
+		meter.measure([&]()
+		              {
+			              int found = 0;
+			              for (auto key : keys)
+			              {
+				              found += lookup.contains(key);
+			              }
+			              return found;
+		              });
+	};
+}
+
+TEST_CASE("collection lookup with 100k keys", "")
+{
+	benchmark_collection(make_keys(100000));
+}
+
+TEST_CASE("collection lookup with 1M keys", "")
+{
+	benchmark_collection(make_keys(1000000));
+}
@@ -0,0 +1,109 @@
+#include "core/async/delay.hpp"
+#include "core/async/Thread.hpp"
+#include "core/container/Queue.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <numeric>
+
+namespace
+{
+	// about what a busy frame during level load sends to the renderer
+	constexpr int message_count = 4096;
+
+	template <typename Queue>
+	void push_pop_one_at_a_time(Queue & queue, const int * values, int * results)
+	{
+		for (int i = 0; i < message_count; i++)
+		{
+			queue.try_push(values[i]);
+		}
+		for (int i = 0; i < message_count; i++)
+		{
+			queue.try_pop(results[i]);
+		}
+	}
+
+	template <typename Queue>
+	void push_pop_batched(Queue & queue, const int * values, int * results)
+	{
+		queue.try_push_range(values, values + message_count);
+		queue.try_pop_n(results, message_count);
+	}
+
+	template <typename Queue>
+	struct Writer
+	{
+		Queue & queue;
+		const int * values;
+
+		static core::async::thread_return thread_decl push_all(core::async::thread_param arg)
+		{
+			Writer & writer = *static_cast<Writer *>(arg);
+
+			for (int i = 0; i < message_count; i++)
+			{
+				while (!writer.queue.try_push(writer.values[i]))
+				{
+					core::async::yield();
+				}
+			}
+			return core::async::thread_return{};
+		}
+	};
+
+	// the reader and the writer on different threads, which is how the
+	// queues are used, and where their indices fight over cache lines
+	template <typename Queue>
+	void push_pop_concurrently(Queue & queue, const int * values, int * results)
+	{
+		Writer<Queue> data{queue, values};
+
+		core::async::Thread writer(Writer<Queue>::push_all, &data);
+		for (int i = 0; i < message_count; i++)
+		{
+			while (!queue.try_pop(results[i]))
+			{
+				core::async::yield();
+			}
+		}
+		writer.join();
+	}
+}
+
+TEST_CASE("queue push and pop", "")
+{
+	int values[message_count];
+	std::iota(values, values + message_count, 0);
+	int results[message_count];
+
+	BENCHMARK_ADVANCED("SimpleQueue one at a time")(Catch::Benchmark::Chronometer meter)
+	{
+		core::container::SimpleQueue<utility::heap_storage<int>> queue(message_count + 1);
+		meter.measure([&](){ push_pop_one_at_a_time(queue, values, results); return results[message_count - 1]; });
+	};
+
+	BENCHMARK_ADVANCED("SimpleQueue batched")(Catch::Benchmark::Chronometer meter)
+	{
+		core::container::SimpleQueue<utility::heap_storage<int>> queue(message_count + 1);
+		meter.measure([&](){ push_pop_batched(queue, values, results); return results[message_count - 1]; });
+	};
+
+	BENCHMARK_ADVANCED("PageQueue one at a time")(Catch::Benchmark::Chronometer meter)
+	{
+		core::container::PageQueue<utility::heap_storage<int>> queue(message_count + 1);
+		meter.measure([&](){ push_pop_one_at_a_time(queue, values, results); return results[message_count - 1]; });
+	};
+
+	BENCHMARK_ADVANCED("PageQueue batched")(Catch::Benchmark::Chronometer meter)
+	{
+		core::container::PageQueue<utility::heap_storage<int>> queue(message_count + 1);
+		meter.measure([&](){ push_pop_batched(queue, values, results); return results[message_count - 1]; });
+	};
+
+	BENCHMARK_ADVANCED("SimpleQueue concurrently")(Catch::Benchmark::Chronometer meter)
+	{
+		core::container::SimpleQueue<utility::heap_storage<int>> queue(64);
+		meter.measure([&](){ push_pop_concurrently(queue, values, results); return results[message_count - 1]; });
+	};
+}
@@ -0,0 +1,140 @@
+#include "core/async/Thread.hpp"
+#include "core/sync/Event.hpp"
+#include "core/sync/Semaphore.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+
+namespace
+{
+	// what the event used to be, for comparison
+	class CondvarEvent
+	{
+	private:
+
+		std::mutex mutex_;
+		std::condition_variable cond_;
+		bool is_set_ = false;
+
+	public:
+
+		void set()
+		{
+			std::lock_guard<std::mutex> lock(mutex_);
+			is_set_ = true;
+			cond_.notify_one();
+		}
+
+		void wait()
+		{
+			std::unique_lock<std::mutex> lock(mutex_);
+			cond_.wait(lock, [this](){ return is_set_; });
+			is_set_ = false;
+		}
+	};
+
+	// signals pong every time ping is signaled, until told to stop
+	template <typename T>
+	struct PingPong
+	{
+		T ping;
+		T pong;
+
+		std::atomic_bool stop{false};
+
+		core::async::Thread thread;
+
+		static core::async::thread_return thread_decl echo(core::async::thread_param arg)
+		{
+			PingPong & pingpong = *static_cast<PingPong *>(arg);
+
+			while (true)
+			{
+				pingpong.ping.wait();
+				if (pingpong.stop.load(std::memory_order_relaxed))
+					break;
+
+				pingpong.pong.signal();
+			}
+
+			return core::async::thread_return{};
+		}
+
+		PingPong()
+			: thread(echo, this)
+		{}
+
+		~PingPong()
+		{
+			stop.store(true, std::memory_order_relaxed);
+			ping.signal();
+			thread.join();
+		}
+
+		void roundtrip()
+		{
+			ping.signal();
+			pong.wait();
+		}
+	};
+
+	template <typename E>
+	struct SignalAsSet
+	{
+		E event;
+
+		void signal() { event.set(); }
+		void wait() { event.wait(); }
+	};
+}
+
+TEST_CASE("event handoff", "")
+{
+	BENCHMARK_ADVANCED("roundtrip condition variable")(Catch::Benchmark::Chronometer meter)
+	{
+		PingPong<SignalAsSet<CondvarEvent>> pingpong;
+		meter.measure([&](){ pingpong.roundtrip(); });
+	};
+
+	BENCHMARK_ADVANCED("roundtrip Event<false>")(Catch::Benchmark::Chronometer meter)
+	{
+		PingPong<SignalAsSet<core::sync::Event<false>>> pingpong;
+		meter.measure([&](){ pingpong.roundtrip(); });
+	};
+
+	BENCHMARK_ADVANCED("roundtrip Semaphore")(Catch::Benchmark::Chronometer meter)
+	{
+		PingPong<core::sync::Semaphore> pingpong;
+		meter.measure([&](){ pingpong.roundtrip(); });
+	};
+}
+
+TEST_CASE("event without waiters", "")
+{
+	BENCHMARK_ADVANCED("set and wait condition variable")(Catch::Benchmark::Chronometer meter)
+	{
+		CondvarEvent event;
+		meter.measure([&](){ event.set(); event.wait(); });
+	};
+
+	BENCHMARK_ADVANCED("set and wait Event<false>")(Catch::Benchmark::Chronometer meter)
+	{
+		core::sync::Event<false> event;
+		meter.measure([&](){ event.set(); return event.wait(); });
+	};
+
+	BENCHMARK_ADVANCED("set and reset Event<true>")(Catch::Benchmark::Chronometer meter)
+	{
+		core::sync::Event<true> event;
+		meter.measure([&](){ event.set(); return event.reset(); });
+	};
+
+	BENCHMARK_ADVANCED("signal and wait Semaphore")(Catch::Benchmark::Chronometer meter)
+	{
+		core::sync::Semaphore semaphore;
+		meter.measure([&](){ semaphore.signal(); return semaphore.wait(); });
+	};
+}
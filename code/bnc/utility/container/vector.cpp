@@ -4,6 +4,40 @@
 
 #include <vector>
 
+namespace
+{
+	// the same as relocate_move, but keeps the vector from handing the
+	// relocation over to the allocator
+	struct relocate_move_always
+	{
+		template <typename Data>
+		bool operator () (Data & new_data, Data & old_data)
+		{
+			new_data.move(std::move(old_data));
+			return true;
+		}
+	};
+
+	template <typename T>
+	using heap_vector_move = utility::vector<utility::heap_storage<T>, utility::reserve_power_of_two, relocate_move_always>;
+
+	struct Matrix4x4
+	{
+		float values[16];
+	};
+
+	template <typename Vector>
+	std::size_t grow(Vector & values, int count)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			if (!values.try_emplace_back())
+				break;
+		}
+		return values.size();
+	}
+}
+
 TEST_CASE("vector emplace", "")
 {
 	BENCHMARK_ADVANCED("emplace ld array[]")(Catch::Benchmark::Chronometer meter)
@@ -147,3 +181,50 @@ TEST_CASE("vector emplace", "")
 		meter.measure([&](int i){ values.try_emplace_back(utility::no_failure, static_cast<int>(i * 3), static_cast<double>(i * 5), static_cast<char>(i * 2)); });
 	};
 }
+
+TEST_CASE("vector growth", "")
+{
+	BENCHMARK("grow std::vector<ld> to 1M")
+	{
+		std::vector<long double> values;
+		for (int i = 0; i < 1000000; i++)
+		{
+			values.emplace_back();
+		}
+		return values.size();
+	};
+
+	BENCHMARK("grow heap_vector<ld> to 1M (move)")
+	{
+		heap_vector_move<long double> values;
+		return grow(values, 1000000);
+	};
+
+	BENCHMARK("grow heap_vector<ld> to 1M (reallocate)")
+	{
+		utility::heap_vector<long double> values;
+		return grow(values, 1000000);
+	};
+
+	BENCHMARK("grow std::vector<Matrix4x4> to 100k")
+	{
+		std::vector<Matrix4x4> values;
+		for (int i = 0; i < 100000; i++)
+		{
+			values.emplace_back();
+		}
+		return values.size();
+	};
+
+	BENCHMARK("grow heap_vector<Matrix4x4> to 100k (move)")
+	{
+		heap_vector_move<Matrix4x4> values;
+		return grow(values, 100000);
+	};
+
+	BENCHMARK("grow heap_vector<Matrix4x4> to 100k (reallocate)")
+	{
+		utility::heap_vector<Matrix4x4> values;
+		return grow(values, 100000);
+	};
+}
@@ -0,0 +1,75 @@
+#include "core/async/Thread.hpp"
+
+#include "utility/spinlock.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <mutex>
+#include <string>
+
+namespace
+{
+	// every thread takes the lock this many times per run, with a
+	// little bit of work done while holding it
+	constexpr int locks_per_thread = 1000;
+
+	constexpr int max_threads = 32;
+
+	template <typename Lock>
+	struct Contender
+	{
+		Lock & lock;
+		volatile int & shared;
+
+		static core::async::thread_return thread_decl take_turns(core::async::thread_param arg)
+		{
+			Contender & contender = *static_cast<Contender *>(arg);
+
+			for (int j = 0; j < locks_per_thread; j++)
+			{
+				std::lock_guard<Lock> guard(contender.lock);
+				contender.shared = contender.shared + 1;
+			}
+			return core::async::thread_return{};
+		}
+	};
+
+	template <typename Lock>
+	void contend(Lock & lock, int thread_count, volatile int & shared)
+	{
+		Contender<Lock> contender{lock, shared};
+
+		core::async::Thread threads[max_threads];
+		for (int i = 0; i < thread_count; i++)
+		{
+			threads[i] = core::async::Thread(Contender<Lock>::take_turns, &contender);
+		}
+
+		for (int i = 0; i < thread_count; i++)
+		{
+			threads[i].join();
+		}
+	}
+
+	template <typename Lock>
+	void benchmark_lock(const char * name)
+	{
+		for (int thread_count = 2; thread_count <= max_threads; thread_count *= 2)
+		{
+			BENCHMARK_ADVANCED(std::string(name) + " " + std::to_string(thread_count) + " threads")(Catch::Benchmark::Chronometer meter)
+			{
+				Lock lock;
+				volatile int shared = 0;
+				meter.measure([&](){ contend(lock, thread_count, shared); });
+			};
+		}
+	}
+}
+
+TEST_CASE("spinlock contention", "")
+{
+	benchmark_lock<std::mutex>("std::mutex");
+	benchmark_lock<utility::spinlock>("spinlock");
+	benchmark_lock<utility::ticket_spinlock>("ticket_spinlock");
+	benchmark_lock<utility::instrumented_spinlock>("instrumented_spinlock");
+}
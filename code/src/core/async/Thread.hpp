@@ -1,5 +1,7 @@
 #pragma once
 
+#include "config.h"
+
 #if THREAD_USE_KERNEL32
 # include <Windows.h>
 #endif
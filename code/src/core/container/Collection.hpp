@@ -2,8 +2,10 @@
 
 #include "core/debug.hpp"
 
+#include "utility/algorithm.hpp"
 #include "utility/annotate.hpp"
 #include "utility/bitmanip.hpp"
+#include "utility/concepts.hpp"
 #include "utility/container/array.hpp"
 #include "utility/container/fragmentation.hpp"
 #include "utility/container/vector.hpp"
@@ -13,31 +15,24 @@
 #include "utility/type_traits.hpp"
 #include "utility/utility.hpp"
 
+#include <algorithm>
 #include <array>
+#include <cstring>
+#include <iterator>
 #include <numeric>
 #include <tuple>
 #include <utility>
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+# include <emmintrin.h>
+#endif
+
 namespace core
 {
 	namespace container
 	{
 		namespace detail
 		{
-			template <typename K>
-			auto hash_of(K key, ext::usize nkeys)
-				-> decltype(static_cast<ext::usize>(key))
-			{
-				return (static_cast<ext::usize>(key) * static_cast<ext::usize>(key)) % nkeys; // todo
-			}
-
-			template <typename K>
-			auto hash_of(K key, ext::usize nkeys)
-				-> decltype(hash_of(key.value(), nkeys))
-			{
-				return hash_of(key.value(), nkeys);
-			}
-
 			template <typename F, typename K, typename P>
 			auto call_impl_func(F && func, K key, P && p) ->
 				decltype(func(key, std::forward<P>(p)))
@@ -59,6 +54,398 @@ namespace core
 # pragma warning( pop )
 #endif
 
+			// every bucket has a control byte telling whether it is empty,
+			// erased, or full, in which case the low bits hold 7 bits of
+			// the hash of its key so that most mismatches can be ruled out
+			// without looking at the keys
+			enum : uint8_t
+			{
+				ctrl_empty = 0x00, // must be zero, see `initialize_zero`
+				ctrl_erased = 0x01,
+				ctrl_full = 0x80,
+			};
+
+			inline uint64_t mix_hash(uint64_t x)
+			{
+				// the finalizer of MurmurHash3, keys such as tokens and
+				// entities are often sequential and would otherwise all
+				// end up in the same few groups
+				x ^= x >> 33;
+				x *= 0xff51afd7ed558ccdull;
+				x ^= x >> 33;
+				x *= 0xc4ceb9fe1a85ec53ull;
+				x ^= x >> 33;
+				return x;
+			}
+
+			template <typename K>
+			auto hash_of(K key)
+				-> decltype(static_cast<uint64_t>(key))
+			{
+				return mix_hash(static_cast<uint64_t>(key));
+			}
+
+			template <typename K>
+			auto hash_of(K key)
+				-> decltype(hash_of(key.value()))
+			{
+				return hash_of(key.value());
+			}
+
+			inline uint8_t ctrl_of(uint64_t hash)
+			{
+				return static_cast<uint8_t>(ctrl_full | (hash & 0x7f));
+			}
+
+			// the control bytes of up to 16 consecutive buckets, every
+			// match returns a mask with one bit per bucket
+			class CtrlGroup
+			{
+			public:
+				enum : ext::usize { size = 16 };
+
+			private:
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+				__m128i bytes_;
+#else
+				uint8_t bytes_[size];
+#endif
+				uint32_t valid_;
+
+			public:
+				CtrlGroup(const uint8_t * ctrl, ext::usize count)
+					: valid_(count == size ? 0xffff : (uint32_t(1) << count) - 1)
+				{
+					debug_assert(0 < count && count <= size);
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+					if (count == size)
+					{
+						bytes_ = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ctrl));
+					}
+					else
+					{
+						alignas(16) uint8_t tail[size] = {};
+						std::memcpy(tail, ctrl, count);
+						bytes_ = _mm_load_si128(reinterpret_cast<const __m128i *>(tail));
+					}
+#else
+					std::memset(bytes_, 0, size);
+					std::memcpy(bytes_, ctrl, count);
+#endif
+				}
+
+			public:
+				uint32_t match(uint8_t byte) const
+				{
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+					return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes_, _mm_set1_epi8(static_cast<char>(byte))))) & valid_;
+#else
+					uint32_t mask = 0;
+					for (ext::usize i = 0; i < size; i++)
+					{
+						mask |= uint32_t(bytes_[i] == byte) << i;
+					}
+					return mask & valid_;
+#endif
+				}
+
+				uint32_t match_empty() const { return match(ctrl_empty); }
+
+				// buckets that are either empty or erased
+				uint32_t match_free() const
+				{
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+					return ~static_cast<uint32_t>(_mm_movemask_epi8(bytes_)) & valid_;
+#else
+					uint32_t mask = 0;
+					for (ext::usize i = 0; i < size; i++)
+					{
+						mask |= uint32_t((bytes_[i] & ctrl_full) == 0) << i;
+					}
+					return mask & valid_;
+#endif
+				}
+			};
+
+			// visits every group once, starting from the one the hash
+			// points to
+			class CtrlProbe
+			{
+			private:
+				ext::usize size_;
+				ext::usize ngroups_;
+				ext::usize group_;
+				ext::usize remaining_;
+
+			public:
+				CtrlProbe(uint64_t hash, ext::usize size)
+					: size_(size)
+					, ngroups_((size + CtrlGroup::size - 1) / CtrlGroup::size)
+					, remaining_(ngroups_)
+				{
+					if ((ngroups_ & (ngroups_ - 1)) == 0)
+					{
+						group_ = static_cast<ext::usize>(hash >> 7) & (ngroups_ - 1);
+					}
+					else
+					{
+						group_ = static_cast<ext::usize>(((hash >> 32) * ngroups_) >> 32);
+					}
+				}
+
+			public:
+				ext::usize offset() const { return group_ * CtrlGroup::size; }
+				ext::usize count() const { return std::min<ext::usize>(size_ - offset(), CtrlGroup::size); }
+
+				bool next()
+				{
+					if (--remaining_ == 0)
+						return false;
+
+					group_++;
+					if (group_ == ngroups_)
+					{
+						group_ = 0;
+					}
+					return true;
+				}
+			};
+
+			/**
+			 * Open addressing hash table mapping keys to slots, the
+			 * buckets are probed a group at a time, starting from the
+			 * group the hash of the key points to and moving on to the
+			 * next group only when the current one is full.
+			 *
+			 * Erasing a bucket in a group that has never been full makes
+			 * it empty again, otherwise it is marked as erased and is
+			 * reused on the next insertion or dropped on the next
+			 * rehash, which happens in place whenever erased buckets
+			 * make up most of the load.
+			 */
+			template <typename Key, typename LookupStorageTraits, typename Slot>
+			class CollectionLookup
+			{
+				using bucket_t = uint32_t;
+
+				struct relocate_rehash
+				{
+					template <typename Data>
+					bool operator () (Data & new_data, Data & old_data)
+					{
+						const auto new_size = new_data.capacity();
+						new_data.storage().memset_fill(new_data.begin_storage(), new_size, ext::byte{});
+
+						return relocate(new_data.storage().data(new_data.begin_storage()), new_size, old_data.storage().data(old_data.begin_storage()), old_data.capacity());
+					}
+				};
+
+			private:
+				utility::array<typename LookupStorageTraits::template storage_type<Slot, Key, uint8_t>, utility::initialize_zero, utility::reserve_nonempty<utility::reserve_power_of_two>::template type, relocate_rehash> buckets_;
+				ext::usize size_ = 0;
+				ext::usize erased_ = 0;
+
+			public:
+				auto slots() { return std::get<0>(buckets_.data()); }
+				auto slots() const { return std::get<0>(buckets_.data()); }
+
+				auto keys() { return std::get<1>(buckets_.data()); }
+				auto keys() const { return std::get<1>(buckets_.data()); }
+
+				annotate_nodiscard
+				constexpr std::size_t capacity() const { return buckets_.size(); }
+				annotate_nodiscard
+				ext::usize size() const { return size_; }
+
+				template <typename K>
+				annotate_nodiscard
+				bucket_t find(K key) const
+				{
+					return find_key(key, keys(), ctrl(), capacity());
+				}
+
+				// makes room for `count` keys in total, rehashing at most
+				// once
+				bool reserve(ext::usize count)
+				{
+					if (count + erased_ <= max_load(capacity()))
+						return true;
+
+					if (count <= max_load(capacity()))
+						return rehash();
+
+					if (!buckets_.try_reserve(count + count / 7 + 1))
+						return false;
+
+					erased_ = 0;
+					return true;
+				}
+
+				// finds a bucket for a key that is not in the table, the
+				// bucket is not taken until `set` is called
+				bucket_t try_place(Key key)
+				{
+					if (max_load(capacity()) <= size_ + erased_)
+					{
+						make_room();
+					}
+					return find_free(hash_of(key), ctrl(), capacity());
+				}
+
+				void set(bucket_t bucket, Key key)
+				{
+					auto & byte = ctrl()[bucket];
+					if (!(byte & ctrl_full))
+					{
+						if (byte == ctrl_erased)
+						{
+							erased_--;
+						}
+						size_++;
+					}
+					byte = ctrl_of(hash_of(key));
+					keys()[bucket] = key;
+				}
+
+				void erase(bucket_t bucket)
+				{
+					auto & byte = ctrl()[bucket];
+					if (!debug_assert(byte & ctrl_full))
+						return;
+
+					// probes only move past groups that are full, so a
+					// group with an empty bucket has never been moved past
+					const auto offset = bucket & ~bucket_t(CtrlGroup::size - 1);
+					const CtrlGroup group(ctrl() + offset, std::min<ext::usize>(capacity() - offset, CtrlGroup::size));
+					if (group.match_empty())
+					{
+						byte = ctrl_empty;
+					}
+					else
+					{
+						byte = ctrl_erased;
+						erased_++;
+					}
+					size_--;
+					keys()[bucket] = Key{};
+				}
+
+				void clear()
+				{
+					std::memset(keys(), static_cast<int>(ext::byte{}), capacity() * sizeof(Key));
+					std::memset(ctrl(), ctrl_empty, capacity());
+					size_ = 0;
+					erased_ = 0;
+				}
+
+			private:
+				auto ctrl() { return std::get<2>(buckets_.data()); }
+				auto ctrl() const { return std::get<2>(buckets_.data()); }
+
+				static constexpr ext::usize max_load(ext::usize size) { return size - size / 8; }
+
+				void make_room()
+				{
+					// growing because of erased buckets would only leave
+					// more erased buckets behind, as long as the keys
+					// themselves leave enough room it is better to get
+					// rid of them in place
+					if (erased_ > 0 && size_ < capacity() - capacity() / 4 && rehash())
+						return;
+
+					if (buckets_.try_reserve(capacity() + 1))
+					{
+						erased_ = 0;
+						return;
+					}
+
+					// the remaining buckets are still usable, it is only
+					// when there are none left that the placement fails
+					if (erased_ > 0)
+					{
+						fiw_unused(rehash());
+					}
+				}
+
+				bool rehash()
+				{
+					decltype(buckets_) new_buckets(capacity());
+					if (new_buckets.size() != capacity())
+						return false;
+
+					if (!relocate(new_buckets.data(), new_buckets.size(), buckets_.data(), capacity()))
+						return false;
+
+					buckets_ = std::move(new_buckets);
+					erased_ = 0;
+					return true;
+				}
+
+				template <typename Pointer>
+				static bool relocate(Pointer new_buckets, ext::usize new_size, Pointer old_buckets, ext::usize old_size)
+				{
+					for (auto i : ranges::index_sequence(old_size))
+					{
+						if (!(std::get<2>(old_buckets)[i] & ctrl_full))
+							continue;
+
+						const auto new_bucket = find_free(hash_of(std::get<1>(old_buckets)[i]), std::get<2>(new_buckets), new_size);
+						if (!debug_verify(new_bucket != bucket_t(-1), "collision when reallocating hash"))
+							return false;
+
+						using utility::iter_move;
+						new_buckets[new_bucket] = iter_move(old_buckets + i);
+					}
+					return true;
+				}
+
+				template <typename K>
+				static bucket_t find_key(K key, const Key * keys, const uint8_t * ctrl, ext::usize size)
+				{
+					if (size == 0)
+						return bucket_t(-1);
+
+					const auto hash = hash_of(key);
+					const auto byte = ctrl_of(hash);
+
+					CtrlProbe probe(hash, size);
+					do
+					{
+						const CtrlGroup group(ctrl + probe.offset(), probe.count());
+						for (auto mask = group.match(byte); mask != 0; mask &= mask - 1)
+						{
+							const auto bucket = probe.offset() + utility::ntz(mask);
+							if (keys[bucket] == key)
+								return static_cast<bucket_t>(bucket);
+						}
+
+						if (group.match_empty())
+							break;
+					}
+					while (probe.next());
+
+					return bucket_t(-1);
+				}
+
+				static bucket_t find_free(uint64_t hash, const uint8_t * ctrl, ext::usize size)
+				{
+					if (size == 0)
+						return bucket_t(-1);
+
+					CtrlProbe probe(hash, size);
+					do
+					{
+						const auto mask = CtrlGroup(ctrl + probe.offset(), probe.count()).match_free();
+						if (mask != 0)
+							return static_cast<bucket_t>(probe.offset() + utility::ntz(mask));
+					}
+					while (probe.next());
+
+					return bucket_t(-1);
+				}
+			};
+
 			template <typename Collection>
 			class CollectionHandle
 			{
@@ -76,95 +463,184 @@ namespace core
 				friend bool operator == (this_type x, this_type y) { return x.bucket_ == y.bucket_; }
 				friend bool operator != (this_type x, this_type y) { return !(x == y); }
 			};
-		}
-
-		/**
-		 * \tparam Key                 The identification/lookup key.
-		 * \tparam LookupStorageTraits A storage traits for the lookup table.
-		 * \tparam ComponentStorages   A storage for each component.
-		 */
-		template <typename Key, typename LookupStorageTraits, typename ...ComponentStorages>
-		class Collection
-		{
-#if !defined(_MSC_VER)
-			static_assert(mpl::conjunction<mpl::bool_constant<(utility::storage_size<ComponentStorages>::value == 1)>...>::value, "Collection does not support multi-type storages for components");
-#endif
-
-			using this_type = Collection<Key, LookupStorageTraits, ComponentStorages...>;
-
-			using component_types = mpl::type_list<typename ComponentStorages::template value_type_at<0>...>;
 
-		public:
-			using const_iterator = detail::CollectionHandle<this_type>;
-			using iterator = const_iterator;
+			// the type of the component in the top 8 bits and its index
+			// in the remaining bits
+			template <typename Value>
+			struct PackedSlot
+			{
+				using index_type = Value;
 
-		private:
-			using bucket_t = uint32_t;
-			using uint24_t = uint32_t;
+				static constexpr int index_bits = sizeof(Value) * 8 - 8;
+				static constexpr Value index_mask = (Value(1) << index_bits) - 1;
 
-		private:
-			struct slot_t
-			{
-				uint32_t value;
+				Value value;
 
 				uint8_t get_type() const
 				{
-					return value >> 24;
+					return static_cast<uint8_t>(value >> index_bits);
 				}
 
-				uint24_t get_index() const
+				index_type get_index() const
 				{
-					return value & 0x00ffffff;
+					return value & index_mask;
 				}
 
 				void set(uint8_t type, std::size_t index)
 				{
-					debug_assert(index < 0x01000000, "24 bits are not enough");
-					value = (uint32_t{type} << 24) | static_cast<uint32_t>(index);
+					debug_assert(index <= index_mask, "the slot is too narrow, use a WideCollection");
+					value = (Value{type} << index_bits) | static_cast<Value>(index);
 				}
 
 				void set_index(std::size_t index)
 				{
-					debug_assert(index < 0x01000000, "24 bits are not enough");
-					value = (value & 0xff000000) | static_cast<uint32_t>(index);
+					debug_assert(index <= index_mask, "the slot is too narrow, use a WideCollection");
+					value = (value & ~index_mask) | static_cast<Value>(index);
 				}
 			};
 
-			struct relocate_rehash
+			template <typename Value>
+			constexpr int PackedSlot<Value>::index_bits;
+			template <typename Value>
+			constexpr Value PackedSlot<Value>::index_mask;
+
+			// one bit per component telling whether it has changed, the
+			// bits past the last component are always clear
+			class ChangeBits
 			{
-				template <typename Data>
-				bool operator () (Data & new_data, Data & old_data)
+			private:
+				utility::heap_vector<uint64_t> words_;
+
+			public:
+				bool test(ext::usize index) const
 				{
-					const auto new_size = new_data.capacity();
-					new_data.storage().memset_fill(new_data.begin_storage(), new_size, ext::byte{});
+					const auto word = index / 64;
+					return word < words_.size() && (words_[word] >> (index % 64) & 1) != 0;
+				}
 
-					const auto old_size = old_data.capacity();
-					for (auto i : ranges::index_sequence(old_size))
+				bool set(ext::usize index)
+				{
+					const auto word = index / 64;
+					if (word >= words_.size() && !words_.resize(word + 1, uint64_t(0)))
+						return false;
+
+					words_[word] |= uint64_t(1) << (index % 64);
+					return true;
+				}
+
+				void reset(ext::usize index)
+				{
+					const auto word = index / 64;
+					if (word < words_.size())
 					{
-						if (old_data.storage().data(old_data.begin_storage())[i].second == Key{})
-							continue; // empty
+						words_[word] &= ~(uint64_t(1) << (index % 64));
+					}
+				}
 
-						const auto new_bucket = find_empty_bucket(old_data.storage().data(old_data.begin_storage())[i].second, new_data.storage().data(new_data.begin_storage()).second, new_size);
-						if (!debug_verify(new_bucket != bucket_t(-1), "collision when reallocating hash"))
-							return false; // todo try with bigger allocation?
+				// follows a component that is moved to a lower index, or
+				// forgets it if it is the one that is erased
+				void move(ext::usize from, ext::usize to)
+				{
+					if (from == to)
+					{
+						reset(to);
+						return;
+					}
 
-						using utility::iter_move;
-						new_data.storage().data(new_data.begin_storage())[new_bucket] = iter_move(old_data.storage().data(old_data.begin_storage()) + i);
+					const bool changed = test(from);
+					reset(from);
+					if (changed)
+					{
+						fiw_unused(set(to));
+					}
+					else
+					{
+						reset(to);
+					}
+				}
+
+				void clear()
+				{
+					std::fill(words_.begin(), words_.end(), uint64_t(0));
+				}
+
+				template <typename F>
+				void for_each(F && func) const
+				{
+					for (auto word : ranges::index_sequence(words_.size()))
+					{
+						for (auto bits = words_[word]; bits != 0; bits &= bits - 1)
+						{
+							func(word * 64 + utility::ntz(bits));
+						}
 					}
-					return true;
 				}
 			};
+		}
+
+		// at most 16M components of each type, this is enough for most
+		// things and keeps the lookup table small
+		using collection_slot32 = detail::PackedSlot<uint32_t>;
+		// for the few tools whose worlds are larger than that, at the
+		// cost of twice the memory per bucket
+		using collection_slot64 = detail::PackedSlot<uint64_t>;
+
+		/**
+		 * \tparam Slot                How components are referred to by
+		 *                             the lookup table, see
+		 *                             `collection_slot32` and
+		 *                             `collection_slot64`.
+		 * \tparam Key                 The identification/lookup key.
+		 * \tparam LookupStorageTraits A storage traits for the lookup table.
+		 * \tparam ComponentStorages   A storage for each component, a
+		 *                             storage with more than one type
+		 *                             makes a component whose fields are
+		 *                             stored in columns of their own.
+		 */
+		template <typename Slot, typename Key, typename LookupStorageTraits, typename ...ComponentStorages>
+		class BasicCollection
+		{
+			using this_type = BasicCollection<Slot, Key, LookupStorageTraits, ComponentStorages...>;
+
+			// components with more than one field, that is whose storage
+			// has more than one type, are identified by their first
+			// field
+			using component_types = mpl::type_list<typename ComponentStorages::template value_type_at<0>...>;
+
+			template <std::size_t type, std::size_t field>
+			using field_type = typename mpl::type_at<type, ComponentStorages...>::template value_type_at<field>;
+
+			template <std::size_t type>
+			using is_single_field = mpl::bool_constant<(utility::storage_size<mpl::type_at<type, ComponentStorages...>>::value == 1)>;
+
+		public:
+			using const_iterator = detail::CollectionHandle<this_type>;
+			using iterator = const_iterator;
+
+		private:
+			using bucket_t = uint32_t;
+			using index_t = typename Slot::index_type;
+
+			using slot_t = Slot;
 
 		private:
-			utility::array<typename LookupStorageTraits::template storage_type<slot_t, Key>, utility::initialize_zero, utility::reserve_nonempty<utility::reserve_power_of_two>::template type, relocate_rehash> lookup_;
+			detail::CollectionLookup<Key, LookupStorageTraits, slot_t> lookup_;
 			// todo keys before slots?
 			std::tuple<utility::vector<typename utility::storage_traits<ComponentStorages>::template append<Key>>...> arrays_;
+			// nothing is allocated for types that are never marked
+			std::array<detail::ChangeBits, component_types::size> changes_;
+
+			decltype(auto) slots() { return lookup_.slots(); }
+			decltype(auto) slots() const { return lookup_.slots(); }
 
-			decltype(auto) slots() { return lookup_.data().first; }
-			decltype(auto) slots() const { return lookup_.data().first; }
+			decltype(auto) keys() { return lookup_.keys(); }
+			decltype(auto) keys() const { return lookup_.keys(); }
 
-			decltype(auto) keys() { return lookup_.data().second; }
-			decltype(auto) keys() const { return lookup_.data().second; }
+			// every field has a column of its own, and the keys come last
+			template <typename Array, std::size_t field = 0>
+			static auto column_of(Array & array, mpl::index_constant<field> = {}) { return std::get<field>(array.data()); }
+			template <typename Array>
+			static auto keys_of(Array & array) { return std::get<(ext::tuple_size<decltype(array.data())>::value - 1)>(array.data()); }
 
 		public:
 			annotate_nodiscard
@@ -182,25 +658,32 @@ namespace core
 				return slots()[it.bucket_].get_type() == type;
 			}
 
-			template <typename C>
+			/**
+			 * \tparam field The column to get, for components with more
+			 *               than one field.
+			 */
+			template <typename C, std::size_t field = 0,
+			          typename F = field_type<mpl::index_of<C, component_types>::value, field>>
 			annotate_nodiscard
-			utility::span<C> get()
+			utility::span<F> get()
 			{
 				auto & array = std::get<mpl::index_of<C, component_types>::value>(arrays_);
-				return utility::span<C>(array.data().first, array.size());
+				return utility::span<F>(column_of(array, mpl::index_constant<field>{}), array.size());
 			}
 
-			template <typename C>
+			template <typename C, std::size_t field = 0,
+			          typename F = field_type<mpl::index_of<C, component_types>::value, field>>
 			annotate_nodiscard
-			utility::span<const C> get() const
+			utility::span<const F> get() const
 			{
 				const auto & array = std::get<mpl::index_of<C, component_types>::value>(arrays_);
-				return utility::span<const C>(array.data().first, array.size());
+				return utility::span<const F>(column_of(array, mpl::index_constant<field>{}), array.size());
 			}
 
-			template <typename C>
+			template <typename C, std::size_t field = 0,
+			          typename F = field_type<mpl::index_of<C, component_types>::value, field>>
 			annotate_nodiscard
-			C * get(const_iterator it)
+			F * get(const_iterator it)
 			{
 				constexpr auto type = mpl::index_of<C, component_types>::value;
 
@@ -211,12 +694,13 @@ namespace core
 					return nullptr;
 
 				const auto index = slots()[it.bucket_].get_index();
-				return &std::get<type>(arrays_)[index].first;
+				return column_of(std::get<type>(arrays_), mpl::index_constant<field>{}) + index;
 			}
 
-			template <typename C>
+			template <typename C, std::size_t field = 0,
+			          typename F = field_type<mpl::index_of<C, component_types>::value, field>>
 			annotate_nodiscard
-			const C * get(const_iterator it) const
+			const F * get(const_iterator it) const
 			{
 				constexpr auto type = mpl::index_of<C, component_types>::value;
 
@@ -227,7 +711,7 @@ namespace core
 					return nullptr;
 
 				const auto index = slots()[it.bucket_].get_index();
-				return &std::get<type>(arrays_)[index].first;
+				return column_of(std::get<type>(arrays_), mpl::index_constant<field>{}) + index;
 			}
 
 			template <typename C>
@@ -237,11 +721,79 @@ namespace core
 				constexpr auto type = mpl::index_of<C, component_types>::value;
 
 				const auto & array = std::get<type>(arrays_);
-				const auto index = &component - array.data().first;
+				const auto index = &component - column_of(array);
 				if (!debug_assert(index < array.size()))
 					return Key{};
 
-				return array[index].second;
+				return keys_of(array)[index];
+			}
+
+			/**
+			 * Marks the component as changed, it stays marked until
+			 * `clear_changed` is called (or until it is erased).
+			 *
+			 * Components are not marked when they are emplaced, mark
+			 * them as well if the systems looking for changes have to
+			 * know about them.
+			 */
+			template <typename C>
+			void mark_changed(const C & component)
+			{
+				constexpr auto type = mpl::index_of<C, component_types>::value;
+
+				const auto & array = std::get<type>(arrays_);
+				const auto index = &component - column_of(array);
+				if (!debug_assert(0 <= index && static_cast<ext::usize>(index) < array.size()))
+					return;
+
+				fiw_unused(debug_verify(changes_[type].set(index)));
+			}
+
+			template <typename C>
+			void mark_changed(const_iterator it)
+			{
+				if (const C * const component = get<C>(it))
+				{
+					mark_changed(*component);
+				}
+			}
+
+			template <typename C>
+			annotate_nodiscard
+			bool is_changed(const C & component) const
+			{
+				constexpr auto type = mpl::index_of<C, component_types>::value;
+
+				const auto & array = std::get<type>(arrays_);
+				const auto index = &component - column_of(array);
+				if (!debug_assert(0 <= index && static_cast<ext::usize>(index) < array.size()))
+					return false;
+
+				return changes_[type].test(index);
+			}
+
+			/**
+			 * Calls `func` with every component that is marked as
+			 * changed, and optionally its key, in the order they are
+			 * stored in.
+			 *
+			 * Components must not be emplaced or erased meanwhile.
+			 */
+			template <typename C, typename F>
+			void for_each_changed(F && func)
+			{
+				constexpr auto type = mpl::index_of<C, component_types>::value;
+
+				auto & array = std::get<type>(arrays_);
+				changes_[type].for_each([&](ext::usize index){ detail::call_impl_func(func, keys_of(array)[index], column_of(array)[index]); });
+			}
+
+			template <typename C>
+			void clear_changed()
+			{
+				constexpr auto type = mpl::index_of<C, component_types>::value;
+
+				changes_[type].clear();
 			}
 
 			annotate_nodiscard
@@ -259,7 +811,7 @@ namespace core
 				debug_expression(Key * const buffer_end = buffer + size);
 				fiw_unused(size);
 
-				for (auto it = lookup_.data().second; it != lookup_.data().second + lookup_.size(); ++it)
+				for (auto it = keys(); it != keys() + lookup_.capacity(); ++it)
 				{
 					const auto key = *it;
 					if (key == Key{})
@@ -274,7 +826,7 @@ namespace core
 			}
 
 			annotate_nodiscard
-			constexpr std::size_t table_size() const { return lookup_.size(); }
+			constexpr std::size_t table_size() const { return lookup_.capacity(); }
 
 			void clear()
 			{
@@ -283,11 +835,121 @@ namespace core
 					[](auto & array)
 					{
 						// todo add memset to ext
-						std::memset(array.data().second, static_cast<int>(ext::byte{}), array.size() * sizeof(Key));
+						std::memset(keys_of(array), static_cast<int>(ext::byte{}), array.size() * sizeof(Key));
 						array.clear();
 					});
 
-				std::memset(keys(), static_cast<int>(ext::byte{}), lookup_.size() * sizeof(Key));
+				for (auto & changes : changes_)
+				{
+					changes.clear();
+				}
+
+				lookup_.clear();
+			}
+
+			/**
+			 * Makes room for `count` keys, and `count` components of
+			 * each type.
+			 */
+			annotate_nodiscard
+			bool reserve(ext::usize count)
+			{
+				bool reserved = lookup_.reserve(count);
+				utl::for_each(arrays_, [&](auto & array){ reserved = array.try_reserve(count) && reserved; });
+				return reserved;
+			}
+
+			/**
+			 * Emplaces a component for every key in the range, each
+			 * constructed from the corresponding value.
+			 *
+			 * The lookup table and the component array grow at most
+			 * once.
+			 *
+			 * \return The number of components emplaced, it is only less
+			 *         than the number of keys if it ran out of memory.
+			 */
+			template <typename Component, typename KeyIt, typename ValueIt>
+			ext::usize emplace_range(KeyIt first, KeyIt last, ValueIt values)
+			{
+				constexpr auto type = mpl::index_of<Component, component_types>::value;
+
+				auto & array = std::get<type>(arrays_);
+
+				// if there is not enough memory for everything, try to
+				// emplace as much as possible anyway
+				const auto count = static_cast<ext::usize>(std::distance(first, last));
+				const bool reserved = lookup_.reserve(lookup_.size() + count) && array.try_reserve(array.size() + count);
+				fiw_unused(reserved);
+
+				ext::usize emplaced = 0;
+				for (; first != last; ++first, ++values)
+				{
+					const Key key = *first;
+
+					if (!debug_assert(find(key) == bucket_t(-1)))
+						break;
+
+					const auto bucket = try_place(key);
+					if (bucket == bucket_t(-1))
+						break;
+
+					const auto index = array.size();
+
+					if (!emplace_back(is_single_field<type>{}, array, key, *values))
+						break;
+
+					slots()[bucket].set(type, index);
+					lookup_.set(bucket, key);
+
+					emplaced++;
+				}
+				return emplaced;
+			}
+
+			/**
+			 * Erases the components of every key in the range, keys
+			 * that are not in the collection are skipped.
+			 *
+			 * The component arrays are compacted once at the end, the
+			 * components that remain keep their relative order.
+			 *
+			 * \return The number of components erased.
+			 */
+			template <typename KeyIt>
+			ext::usize erase_many(KeyIt first, KeyIt last)
+			{
+				std::array<ext::usize, component_types::size> first_erased;
+				first_erased.fill(ext::usize(-1));
+
+				ext::usize erased = 0;
+				for (; first != last; ++first)
+				{
+					const auto bucket = find(*first);
+					if (bucket == bucket_t(-1))
+						continue;
+
+					const auto index = slots()[bucket].get_index();
+
+					switch (slots()[bucket].get_type())
+					{
+#define CASE(n) case (n):	  \
+						mark_erased(mpl::index_constant<((n) < component_types::size ? (n) : std::size_t(-1))>{}, index, first_erased); \
+						break
+
+						PP_EXPAND_128(CASE, 0);
+#undef CASE
+					default:
+						fiw_unreachable();
+					}
+
+					lookup_.erase(bucket);
+					erased++;
+				}
+
+				compact_impl(first_erased, mpl::make_index_sequence<component_types::size>{});
+
+				return erased;
 			}
 
 			template <typename Component, typename ...Ps>
@@ -306,13 +968,13 @@ namespace core
 				auto & array = std::get<type>(arrays_);
 				const auto index = array.size();
 
-				if (!array.try_emplace_back(std::piecewise_construct, std::forward_as_tuple(std::forward<Ps>(ps)...), std::forward_as_tuple(key)))
+				if (!emplace_back(is_single_field<type>{}, array, key, std::forward<Ps>(ps)...))
 					return nullptr;
 
 				slots()[bucket].set(type, index);
-				keys()[bucket] = key;
+				lookup_.set(bucket, key);
 
-				return &array[index].first;
+				return column_of(array) + index;
 			}
 
 			void erase(const_iterator it)
@@ -361,80 +1023,112 @@ namespace core
 			decltype(auto) call(const_iterator it, Fs && ...funcs) { return call(it, ext::overload(std::forward<Fs>(funcs)...)); }
 
 		private:
-			template <typename K>
-			static bucket_t find_bucket(K key, const Key * keys, ext::usize nkeys, std::size_t first_bucket)
+			bucket_t try_place(Key key)
 			{
-				auto bucket = first_bucket;
-				int count = 0;
-				while (keys[bucket] != key)
-				{
-					if (count >= 4) // arbitrary
-						return bucket_t(-1);
-
-					count++;
-					bucket = (first_bucket + count * count) % nkeys;
-				}
-				return static_cast<bucket_t>(bucket);
+				return lookup_.try_place(key);
 			}
 
 			template <typename K>
-			static bucket_t find_bucket(K key, const Key * keys, ext::usize nkeys)
+			bucket_t find(K key) const
 			{
-				if (!debug_assert(nkeys != 0))
-					return bucket_t(-1);
-
-				const auto first_bucket = detail::hash_of(key, nkeys);
-
-				return find_bucket(key, keys, nkeys, first_bucket);
+				return lookup_.find(key);
 			}
 
-			template <typename K>
-			static bucket_t find_empty_bucket(K key, const Key * keys, ext::usize nkeys)
+			template <typename Array, typename ...Ps>
+			static bool emplace_back(mpl::true_type /*single field*/, Array & array, Key key, Ps && ...ps)
 			{
-				if (!debug_assert(nkeys != 0))
-					return bucket_t(-1);
-
-				const auto first_bucket = detail::hash_of(key, nkeys);
-
-				return find_bucket(Key{}, keys, nkeys, first_bucket);
+				return array.try_emplace_back(std::piecewise_construct, std::forward_as_tuple(std::forward<Ps>(ps)...), std::forward_as_tuple(key));
 			}
 
-			bucket_t try_place(Key key)
+			// every field is constructed from one argument
+			template <typename Array, typename ...Ps,
+			          REQUIRES((sizeof...(Ps) != 1))>
+			static bool emplace_back(mpl::false_type /*single field*/, Array & array, Key key, Ps && ...ps)
 			{
-				while (true)
-				{
-					const auto bucket = find_empty_bucket(key, keys(), lookup_.size());
-					if (bucket != bucket_t(-1))
-						return bucket;
-
-					if (!debug_verify(lookup_.try_reserve(lookup_.capacity() + 1)))
-						return bucket_t(-1);
-				}
+				return array.try_emplace_back(std::piecewise_construct, std::forward_as_tuple(std::forward<Ps>(ps))..., std::forward_as_tuple(key));
 			}
 
-			template <typename K>
-			bucket_t find(K key) const
+			// or from one tuple holding all of the arguments
+			template <typename Array, typename P>
+			static bool emplace_back(mpl::false_type /*single field*/, Array & array, Key key, P && p)
 			{
-				return find_bucket(key, keys(), lookup_.size());
+				return ext::apply([&array, key](auto && ...ps){ return emplace_back(mpl::false_type{}, array, key, std::forward<decltype(ps)>(ps)...); }, std::forward<P>(p));
 			}
 
-			void remove_impl(mpl::index_constant<std::size_t(-1)>, bucket_t /*bucket*/, uint24_t /*index*/)
+			void remove_impl(mpl::index_constant<std::size_t(-1)>, bucket_t /*bucket*/, index_t /*index*/)
 			{
 				fiw_unreachable();
 			}
 
 			template <std::size_t type>
-			void remove_impl(mpl::index_constant<type>, bucket_t bucket, uint24_t index)
+			void remove_impl(mpl::index_constant<type>, bucket_t bucket, index_t index)
 			{
 				auto & array = std::get<type>(arrays_);
 				debug_assert(index < array.size());
 
 				const auto last_index = array.size() - 1;
-				const auto last_bucket = find(array[last_index].second);
+				const auto last_bucket = find(keys_of(array)[last_index]);
 
 				slots()[last_bucket].set_index(index);
-				keys()[bucket] = Key{};
+				lookup_.erase(bucket);
 				array.erase(array.begin() + index);
+				changes_[type].move(last_index, index);
+			}
+
+			template <std::size_t N>
+			void mark_erased(mpl::index_constant<std::size_t(-1)>, index_t /*index*/, std::array<ext::usize, N> & /*first_erased*/)
+			{
+				fiw_unreachable();
+			}
+
+			// the key next to the component is cleared, which is how
+			// `compact` tells which components to drop
+			template <std::size_t type, std::size_t N>
+			void mark_erased(mpl::index_constant<type>, index_t index, std::array<ext::usize, N> & first_erased)
+			{
+				auto & array = std::get<type>(arrays_);
+				debug_assert(index < array.size());
+
+				keys_of(array)[index] = Key{};
+				first_erased[type] = std::min<ext::usize>(first_erased[type], index);
+			}
+
+			template <std::size_t N>
+			void compact_impl(const std::array<ext::usize, N> & /*first_erased*/, mpl::index_sequence<>)
+			{}
+			template <std::size_t N, std::size_t type, std::size_t ...types>
+			void compact_impl(const std::array<ext::usize, N> & first_erased, mpl::index_sequence<type, types...>)
+			{
+				if (first_erased[type] != ext::usize(-1))
+				{
+					compact(std::get<type>(arrays_), changes_[type], first_erased[type]);
+				}
+				compact_impl(first_erased, mpl::index_sequence<types...>{});
+			}
+
+			template <typename Array>
+			void compact(Array & array, detail::ChangeBits & changes, ext::usize first_erased)
+			{
+				auto to = first_erased;
+				for (auto from = first_erased; from < array.size(); from++)
+				{
+					const Key key = keys_of(array)[from];
+					if (key == Key{})
+					{
+						changes.reset(from);
+						continue;
+					}
+
+					if (from != to)
+					{
+						using utility::iter_move;
+						array[to] = iter_move(array.data() + from);
+						slots()[find(key)].set_index(to);
+						changes.move(from, to);
+					}
+					to++;
+				}
+				fiw_unused(debug_verify(array.resize(to)));
 			}
 
 #if defined(_MSC_VER)
@@ -443,7 +1137,7 @@ namespace core
 			// C4702 - unreachable code
 #endif
 			template <typename F>
-			auto call_impl(mpl::index_constant<std::size_t(-1)>, Key key, uint24_t /*index*/, F && func) ->
+			auto call_impl(mpl::index_constant<std::size_t(-1)>, Key key, index_t /*index*/, F && func) ->
 				decltype(detail::call_impl_func(std::forward<F>(func), key, std::declval<mpl::car<component_types> &>()))
 			{
 				fiw_unreachable();
@@ -452,13 +1146,13 @@ namespace core
 				return detail::call_impl_func(std::forward<F>(func), key, *reinterpret_cast<mpl::car<component_types> *>(0));
 			}
 			template <std::size_t type, typename F>
-			auto call_impl(mpl::index_constant<type>, Key key, uint24_t index, F && func) ->
+			auto call_impl(mpl::index_constant<type>, Key key, index_t index, F && func) ->
 				decltype(detail::call_impl_func(std::forward<F>(func), key, std::declval<mpl::car<component_types> &>()))
 			{
 				auto & array = std::get<type>(arrays_);
 				debug_assert(index < array.size());
 
-				return detail::call_impl_func(std::forward<F>(func), key, array[index].first);
+				return detail::call_impl_func(std::forward<F>(func), key, column_of(array)[index]);
 			}
 #if defined(_MSC_VER)
 # pragma warning( pop )
@@ -469,6 +1163,12 @@ namespace core
 			friend const_iterator find(const this_type & x, K key) { return const_iterator(x.find(key)); }
 		};
 
+		template <typename Key, typename LookupStorageTraits, typename ...ComponentStorages>
+		using Collection = BasicCollection<collection_slot32, Key, LookupStorageTraits, ComponentStorages...>;
+
+		template <typename Key, typename LookupStorageTraits, typename ...ComponentStorages>
+		using WideCollection = BasicCollection<collection_slot64, Key, LookupStorageTraits, ComponentStorages...>;
+
 		/**
 		 * \tparam Key                 The identification/lookup key.
 		 * \tparam LookupStorageTraits A storage traits for the lookup table.
@@ -545,40 +1245,15 @@ namespace core
 				}
 			};
 
-			struct relocate_rehash
-			{
-				template <typename Data>
-				bool operator () (Data & new_data, Data & old_data)
-				{
-					const auto new_size = new_data.capacity();
-					new_data.storage().memset_fill(new_data.begin_storage(), new_size, ext::byte{});
-
-					const auto old_size = old_data.capacity();
-					for (auto i : ranges::index_sequence(old_size))
-					{
-						if (old_data.storage().data(old_data.begin_storage())[i].second == Key{})
-							continue; // empty
-
-						const auto new_bucket = find_empty_bucket(old_data.storage().data(old_data.begin_storage())[i].second, new_data.storage().data(new_data.begin_storage()).second, new_size);
-						if (!debug_verify(new_bucket != bucket_t(-1), "collision when reallocating hash"))
-							return false; // todo try with bigger allocation?
-
-						using utility::iter_move;
-						new_data.storage().data(new_data.begin_storage())[new_bucket] = iter_move(old_data.storage().data(old_data.begin_storage()) + i);
-					}
-					return true;
-				}
-			};
-
 		private:
-			utility::array<typename LookupStorageTraits::template storage_type<slot_t, Key>, utility::initialize_zero, utility::reserve_nonempty<utility::reserve_power_of_two>::template type, relocate_rehash> lookup_;
+			detail::CollectionLookup<Key, LookupStorageTraits, slot_t> lookup_;
 			std::tuple<utility::vector<typename utility::storage_traits<ComponentStorages>::template append<Key>>...> arrays_;
 
-			decltype(auto) slots() { return lookup_.data().first; }
-			decltype(auto) slots() const { return lookup_.data().first; }
+			decltype(auto) slots() { return lookup_.slots(); }
+			decltype(auto) slots() const { return lookup_.slots(); }
 
-			decltype(auto) keys() { return lookup_.data().second; }
-			decltype(auto) keys() const { return lookup_.data().second; }
+			decltype(auto) keys() { return lookup_.keys(); }
+			decltype(auto) keys() const { return lookup_.keys(); }
 
 		public:
 			annotate_nodiscard
@@ -687,7 +1362,7 @@ namespace core
 					return nullptr;
 
 				slots()[bucket].template set<type>(debug_cast<uint16_t>(index));
-				keys()[bucket] = key;
+				lookup_.set(bucket, key);
 
 				return &array[index].first;
 			}
@@ -726,65 +1401,19 @@ namespace core
 			template <typename ...Fs>
 			decltype(auto) call(const_iterator it, Fs && ...funcs) { return call(it, ext::overload(std::forward<Fs>(funcs)...)); }
 		private:
-			template <typename K>
-			static bucket_t find_bucket(K key, const Key * keys, ext::usize nkeys, std::size_t first_bucket)
-			{
-				auto bucket = first_bucket;
-				int count = 0;
-				while (keys[bucket] != key)
-				{
-					if (count >= 4) // arbitrary
-						return bucket_t(-1);
-
-					count++;
-					bucket = (first_bucket + count * count) % nkeys;
-				}
-				return static_cast<bucket_t>(bucket);
-			}
-
-			template <typename K>
-			static bucket_t find_bucket(K key, const Key * keys, ext::usize nkeys)
-			{
-				if (!debug_assert(nkeys != 0))
-					return bucket_t(-1);
-
-				const auto first_bucket = detail::hash_of(key, nkeys);
-
-				return find_bucket(key, keys, nkeys, first_bucket);
-			}
-
-			template <typename K>
-			static bucket_t find_empty_bucket(K key, const Key * keys, ext::usize nkeys)
-			{
-				if (!debug_assert(nkeys != 0))
-					return bucket_t(-1);
-
-				const auto first_bucket = detail::hash_of(key, nkeys);
-
-				return find_bucket(Key{}, keys, nkeys, first_bucket);
-			}
-
 			bucket_t try_place(Key key)
 			{
-				auto bucket = find_bucket(key, keys(), lookup_.size());
+				const auto bucket = find(key);
 				if (bucket != bucket_t(-1))
 					return bucket;
 
-				while (true)
-				{
-					bucket = find_empty_bucket(key, keys(), lookup_.size());
-					if (bucket != bucket_t(-1))
-						return bucket;
-
-					if (!debug_verify(lookup_.try_reserve(lookup_.capacity() + 1)))
-						return bucket_t(-1);
-				}
+				return lookup_.try_place(key);
 			}
 
 			template <typename K>
 			bucket_t find(K key) const
 			{
-				return find_bucket(key, keys(), lookup_.size());
+				return lookup_.find(key);
 			}
 
 			template <std::size_t type>
@@ -800,7 +1429,7 @@ namespace core
 				slots()[bucket].template clear<type>();
 				if (slots()[bucket].empty())
 				{
-					keys()[bucket] = Key{};
+					lookup_.erase(bucket);
 				}
 				array.erase(array.begin() + index);
 			}
@@ -880,7 +1509,7 @@ namespace core
 
 				uint8_t get_type() const
 				{
-					return value >> 24;
+					return static_cast<uint8_t>(value >> 24);
 				}
 
 				uint24_t get_index() const
@@ -901,40 +1530,15 @@ namespace core
 				}
 			};
 
-			struct relocate_rehash
-			{
-				template <typename Data>
-				bool operator () (Data & new_data, Data & old_data)
-				{
-					const auto new_size = new_data.capacity();
-					new_data.storage().memset_fill(new_data.begin_storage(), new_size, ext::byte{});
-
-					const auto old_size = old_data.capacity();
-					for (auto i : ranges::index_sequence(old_size))
-					{
-						if (old_data.storage().data(old_data.begin_storage())[i].second == Key{})
-							continue; // empty
-
-						const auto new_bucket = find_empty_bucket(old_data.storage().data(old_data.begin_storage())[i].second, new_data.storage().data(new_data.begin_storage()).second, new_size);
-						if (!debug_verify(new_bucket != bucket_t(-1), "collision when reallocating hash"))
-							return false; // todo try with bigger allocation?
-
-						using utility::iter_move;
-						new_data.storage().data(new_data.begin_storage())[new_bucket] = iter_move(old_data.storage().data(old_data.begin_storage()) + i);
-					}
-					return true;
-				}
-			};
-
 		private:
-			utility::array<typename LookupStorageTraits::template storage_type<slot_t, Key>, utility::initialize_zero, utility::reserve_nonempty<utility::reserve_power_of_two>::template type, relocate_rehash> lookup_;
+			detail::CollectionLookup<Key, LookupStorageTraits, slot_t> lookup_;
 			std::tuple<utility::fragmentation<ComponentStorages>...> arrays_;
 
-			decltype(auto) slots() { return lookup_.data().first; }
-			decltype(auto) slots() const { return lookup_.data().first; }
+			decltype(auto) slots() { return lookup_.slots(); }
+			decltype(auto) slots() const { return lookup_.slots(); }
 
-			decltype(auto) keys() { return lookup_.data().second; }
-			decltype(auto) keys() const { return lookup_.data().second; }
+			decltype(auto) keys() { return lookup_.keys(); }
+			decltype(auto) keys() const { return lookup_.keys(); }
 
 		public:
 			annotate_nodiscard
@@ -998,7 +1602,7 @@ namespace core
 			{
 				ext::usize count = 0;
 
-				for (auto bucket : ranges::index_sequence(lookup_.size()))
+				for (auto bucket : ranges::index_sequence(lookup_.capacity()))
 				{
 					const auto key = keys()[bucket];
 					if (key == Key{})
@@ -1014,13 +1618,90 @@ namespace core
 			}
 
 			annotate_nodiscard
-			constexpr std::size_t max_size() const { return lookup_.size(); } // todo lookup_.max_size()?
+			constexpr std::size_t max_size() const { return lookup_.capacity(); } // todo lookup_.max_size()?
 
 			void clear()
 			{
 				utl::for_each(arrays_, [](auto & array){ array.clear(); });
 
-				std::memset(keys(), static_cast<int>(ext::byte{}), lookup_.size() * sizeof(Key));
+				lookup_.clear();
+			}
+
+			/**
+			 * Makes room for `count` keys, and `count` components of
+			 * each type.
+			 */
+			annotate_nodiscard
+			bool reserve(ext::usize count)
+			{
+				bool reserved = lookup_.reserve(count);
+				utl::for_each(arrays_, [&](auto & array){ reserved = array.try_reserve(count) && reserved; });
+				return reserved;
+			}
+
+			/**
+			 * Emplaces a component for every key in the range, each
+			 * constructed from the corresponding value.
+			 *
+			 * The lookup table and the component array grow at most
+			 * once.
+			 *
+			 * \return The number of components emplaced, it is only less
+			 *         than the number of keys if it ran out of memory.
+			 */
+			template <typename Component, typename KeyIt, typename ValueIt>
+			ext::usize emplace_range(KeyIt first, KeyIt last, ValueIt values)
+			{
+				constexpr auto type = mpl::index_of<Component, component_types>::value;
+
+				auto & array = std::get<type>(arrays_);
+
+				// if there is not enough memory for everything, try to
+				// emplace as much as possible anyway
+				const auto count = static_cast<ext::usize>(std::distance(first, last));
+				const bool reserved = lookup_.reserve(lookup_.size() + count) && array.try_reserve(array.size() + count);
+				fiw_unused(reserved);
+
+				ext::usize emplaced = 0;
+				for (; first != last; ++first, ++values)
+				{
+					const Key key = *first;
+
+					if (!debug_assert(find(key) == bucket_t(-1)))
+						break;
+
+					const auto bucket = try_place(key);
+					if (bucket == bucket_t(-1))
+						break;
+
+					if (!add_impl<Component>(bucket, key, *values))
+						break;
+
+					emplaced++;
+				}
+				return emplaced;
+			}
+
+			/**
+			 * Erases the components of every key in the range, keys
+			 * that are not in the collection are skipped.
+			 *
+			 * \return The number of components erased.
+			 */
+			template <typename KeyIt>
+			ext::usize erase_many(KeyIt first, KeyIt last)
+			{
+				ext::usize erased = 0;
+				for (; first != last; ++first)
+				{
+					const auto bucket = find(*first);
+					if (bucket == bucket_t(-1))
+						continue;
+
+					remove_impl(bucket);
+					erased++;
+				}
+				return erased;
 			}
 
 			template <typename Component, typename ...Ps>
@@ -1090,61 +1771,15 @@ namespace core
 			decltype(auto) call(const_iterator it, Fs && ...funcs) { return call(it, ext::overload(std::forward<Fs>(funcs)...)); }
 
 		private:
-			template <typename K>
-			static bucket_t find_bucket(K key, const Key * keys, ext::usize nkeys, std::size_t first_bucket)
-			{
-				auto bucket = first_bucket;
-				int count = 0;
-				while (keys[bucket] != key)
-				{
-					if (count >= 4) // arbitrary
-						return bucket_t(-1);
-
-					count++;
-					bucket = (first_bucket + count * count) % nkeys;
-				}
-				return static_cast<bucket_t>(bucket);
-			}
-
-			template <typename K>
-			static bucket_t find_bucket(K key, const Key * keys, ext::usize nkeys)
-			{
-				if (!debug_assert(nkeys != 0))
-					return bucket_t(-1);
-
-				const auto first_bucket = detail::hash_of(key, nkeys);
-
-				return find_bucket(key, keys, nkeys, first_bucket);
-			}
-
-			template <typename K>
-			static bucket_t find_empty_bucket(K key, const Key * keys, ext::usize nkeys)
-			{
-				if (!debug_assert(nkeys != 0))
-					return bucket_t(-1);
-
-				const auto first_bucket = detail::hash_of(key, nkeys);
-
-				return find_bucket(Key{}, keys, nkeys, first_bucket);
-			}
-
 			bucket_t try_place(Key key)
 			{
-				while (true)
-				{
-					const auto bucket = find_empty_bucket(key, keys(), lookup_.size());
-					if (bucket != bucket_t(-1))
-						return bucket;
-
-					if (!debug_verify(lookup_.try_reserve(lookup_.capacity() + 1)))
-						return bucket_t(-1);
-				}
+				return lookup_.try_place(key);
 			}
 
 			template <typename K>
 			bucket_t find(K key) const
 			{
-				return find_bucket(key, keys(), lookup_.size());
+				return lookup_.find(key);
 			}
 
 			template <typename Component, typename ...Ps>
@@ -1158,7 +1793,7 @@ namespace core
 				if (component)
 				{
 					slots()[bucket].set(type, component - array.data());
-					keys()[bucket] = key;
+					lookup_.set(bucket, key);
 				}
 				return component;
 			}
@@ -1175,7 +1810,7 @@ namespace core
 				if (!debug_assert(index < array.capacity()))
 					return;
 
-				keys()[bucket] = Key{};
+				lookup_.erase(bucket);
 				fiw_unused(debug_verify(array.try_erase(index)));
 			}
 
@@ -6,7 +6,6 @@
 #include "utility/storage.hpp"
 
 #include <atomic>
-#include <bitset>
 #include <mutex>
 #include <thread>
 #include <type_traits>
@@ -18,10 +17,140 @@ namespace core
 		struct single_read_single_write;
 		struct single_read_multiple_write;
 
+		namespace detail
+		{
+			/**
+			 * Triple buffer, the writer and the reader own one slot each
+			 * and trade it for the third whenever they are done with it.
+			 *
+			 * Slots are constructed lazily and are then kept alive
+			 * until popped (or until the queue is destroyed), so that
+			 * the in place interface can reuse them without
+			 * constructing, destructing, or moving anything.
+			 */
+			template <typename T>
+			class ExchangeQueueBase
+			{
+			private:
+				// set in `lasti` when the slot it refers to has been
+				// written to but not read yet
+				enum : int { fresh_bit = 4, index_mask = 3 };
+
+			private:
+				std::atomic_int lasti;
+				int readi;
+				int writei;
+				// only ever accessed by the current owner of the slot
+				bool alive[3];
+				utility::static_storage<3, T> buffer_;
+
+			public:
+				~ExchangeQueueBase()
+				{
+					for (int i = 0; i < 3; i++)
+					{
+						if (alive[i])
+						{
+							buffer_.destruct_at(buffer_.begin() + i);
+						}
+					}
+				}
+				ExchangeQueueBase() :
+					lasti(0),
+					readi(1),
+					writei(2),
+					alive{false, false, false}
+				{}
+
+			public:
+				/**
+				 * \return The latest written item if it has not been read
+				 *         already, null otherwise.
+				 *
+				 * The item stays valid until the next call to
+				 * `begin_read` or `try_pop`.
+				 */
+				T * begin_read()
+				{
+					if (!(lasti.load(std::memory_order_relaxed) & fresh_bit))
+						return nullptr;
+
+					readi = lasti.exchange(readi, std::memory_order_acq_rel) & index_mask;
+					return buffer_.data(buffer_.begin() + readi);
+				}
+				/**
+				 * Marks the end of reading the item returned by
+				 * `begin_read`.
+				 */
+				void end_read()
+				{
+					// the reader keeps its slot until it asks for a new
+					// one, so there is nothing to hand back here
+				}
+				/**
+				 * \param[out] item Where to write on success.
+				 * \return True on success, false otherwise.
+				 */
+				bool try_pop(T & item)
+				{
+					T * const p = begin_read();
+					if (!p)
+						return false;
+
+					using utility::iter_move;
+					item = iter_move(p);
+					buffer_.destruct_at(buffer_.begin() + readi);
+					alive[readi] = false;
+					return true;
+				}
+
+			protected:
+				/**
+				 * \return The slot to write the next item into, it holds
+				 *         whatever was last written into it (or a default
+				 *         constructed item if nothing was).
+				 */
+				T & begin_write_()
+				{
+					if (!alive[writei])
+					{
+						buffer_.construct_at_(buffer_.begin() + writei);
+						alive[writei] = true;
+					}
+					return *buffer_.data(buffer_.begin() + writei);
+				}
+				/**
+				 * Makes the slot returned by `begin_write_` the latest
+				 * item, any item written before it that has not been read
+				 * yet is dropped.
+				 */
+				void commit_()
+				{
+					writei = lasti.exchange(writei | fresh_bit, std::memory_order_acq_rel) & index_mask;
+				}
+				template <typename ...Ps>
+				void push_(Ps && ...ps)
+				{
+					if (alive[writei])
+					{
+						buffer_.destruct_at(buffer_.begin() + writei);
+					}
+					buffer_.construct_at_(buffer_.begin() + writei, std::forward<Ps>(ps)...);
+					alive[writei] = true;
+
+					commit_();
+				}
+			};
+		}
+
 		/**
 		 * Contrary to  the CircleQueue, only the  latest written data
 		 * can be polled from the ExchangeQueue.
 		 *
+		 * Items can either be pushed and popped, or be written and read
+		 * in place with `begin_write`/`commit` and `begin_read`/
+		 * `end_read`, which never copies anything.
+		 *
 		 * \tparam T      Type.
 		 * \tparam Policy Synchronization mechanism between threads.
 		 */
@@ -30,38 +159,22 @@ namespace core
 
 		template <typename T>
 		class ExchangeQueue<T, single_read_single_write>
+			: public detail::ExchangeQueueBase<T>
 		{
-		private:
-			std::atomic_int lasti;
-			int readi;
-			int writei;
-			std::bitset<3> writebits;
-			utility::static_storage<3, T> buffer_;
-
-		public:
-			ExchangeQueue() :
-				lasti(0),
-				readi(1),
-				writei(2)
-			{}
-
 		public:
 			/**
-			 * \param[out] item Where to write on success.
-			 * \return True on success, false otherwise.
+			 * \return The slot to write into, pass it on with `commit`.
 			 */
-			bool try_pop(T & item)
+			T & begin_write()
 			{
-				readi = lasti.exchange(readi, std::memory_order_acquire);
-				if (writebits.test(readi))
-				{
-					using utility::iter_move;
-					item = iter_move(buffer_.data(buffer_.begin()) + readi);
-					writebits.reset(readi);
-					buffer_.destruct_at(buffer_.begin() + readi);
-					return true;
-				}
-				return false;
+				return this->begin_write_();
+			}
+			/**
+			 * Publishes the slot returned by `begin_write`.
+			 */
+			void commit()
+			{
+				this->commit_();
 			}
 			/**
 			 * \param[in] ps The thing to push.
@@ -70,53 +183,36 @@ namespace core
 			template <typename ...Ps>
 			bool try_push(Ps && ...ps)
 			{
-				writebits.set(writei);
-				buffer_.construct_at_(buffer_.begin() + writei, std::forward<Ps>(ps)...);
-				writei = lasti.exchange(writei, std::memory_order_release);
-				// remove any unread item
-				if (writebits.test(writei))
-				{
-					buffer_.destruct_at(buffer_.begin() + writei);
-				}
+				this->push_(std::forward<Ps>(ps)...);
 				return true;
 			}
 		};
 
 		template <typename T>
 		class ExchangeQueue<T, single_read_multiple_write>
+			: public detail::ExchangeQueueBase<T>
 		{
 		private:
-			std::atomic_int lasti;
-			int readi;
-			int writei;
-			std::bitset<3> writebits;
-			utility::static_storage<3, T> buffer_;
 			utility::spinlock writelock;
 
-		public:
-			ExchangeQueue() :
-				lasti(0),
-				readi(1),
-				writei(2)
-			{}
-
 		public:
 			/**
-			 * \param[out] item Where to write on success.
-			 * \return True on success, false otherwise.
+			 * \return The slot to write into, pass it on with `commit`.
+			 *
+			 * Other writers are blocked until `commit` is called.
 			 */
-			bool try_pop(T & item)
+			T & begin_write()
 			{
-				readi = lasti.exchange(readi, std::memory_order_acquire);
-				if (writebits.test(readi))
-				{
-					using utility::iter_move;
-					item = iter_move(buffer_.begin() + readi);
-					writebits.reset(readi);
-					buffer_.destruct_at(buffer_.begin() + readi);
-					return true;
-				}
-				return false;
+				writelock.lock();
+				return this->begin_write_();
+			}
+			/**
+			 * Publishes the slot returned by `begin_write`.
+			 */
+			void commit()
+			{
+				this->commit_();
+				writelock.unlock();
 			}
 			/**
 			 * \param[in] ps The thing to push.
@@ -127,14 +223,7 @@ namespace core
 			{
 				std::lock_guard<utility::spinlock> lock{this->writelock};
 
-				writebits.set(writei);
-				buffer_.construct_at(buffer_.begin() + writei, std::forward<Ps>(ps)...);
-				writei = lasti.exchange(writei, std::memory_order_acq_rel); // release?
-				// remove any unread item
-				if (writebits.test(writei))
-				{
-					buffer_.destruct_at(buffer_.begin() + writei);
-				}
+				this->push_(std::forward<Ps>(ps)...);
 				return true;
 			}
 		};
@@ -4,11 +4,17 @@
 #include "core/debug.hpp"
 
 #include "utility/aggregation_allocator.hpp"
+#include "utility/aligned_allocator.hpp"
 #include "utility/concepts.hpp"
+#include "utility/span.hpp"
+#include "utility/spinlock.hpp"
 #include "utility/storage.hpp"
 
+#include <algorithm>
 #include <atomic>
 #include <cstring>
+#include <iterator>
+#include <mutex>
 
 namespace utility
 {
@@ -38,9 +44,14 @@ namespace core
 
 				this_type * previous_;
 
+				// the reader and the writers each get their own cache
+				// line, so that they do not invalidate each other on
+				// every push and pop
 				std::atomic_size_t readi_;
+				char readpad_[utility::cache_line_alignment];
 				std::atomic_size_t readendi_;
 				std::atomic_size_t writei_;
+				char writepad_[utility::cache_line_alignment];
 
 				PageQueueHeader()
 					: previous_(this)
@@ -67,8 +78,10 @@ namespace core
 				this_type * previous_;
 
 				std::atomic_size_t readi_;
+				char readpad_[utility::cache_line_alignment];
 				std::atomic_size_t readendi_;
 				std::atomic_size_t writei_;
+				char writepad_[utility::cache_line_alignment];
 
 				std::size_t capacity_;
 
@@ -104,8 +117,10 @@ namespace core
 			struct SimpleQueueData_static_capacity
 			{
 				std::atomic_size_t readi_;
+				char readpad_[utility::cache_line_alignment];
 				std::atomic_size_t readendi_;
 				std::atomic_size_t writei_;
+				char writepad_[utility::cache_line_alignment];
 
 				Storage storage_;
 
@@ -126,8 +141,10 @@ namespace core
 			struct SimpleQueueData_static_capacity<Storage, false /*static_capacity*/>
 			{
 				std::atomic_size_t readi_;
+				char readpad_[utility::cache_line_alignment];
 				std::atomic_size_t readendi_;
 				std::atomic_size_t writei_;
+				char writepad_[utility::cache_line_alignment];
 
 				std::size_t capacity_;
 
@@ -218,6 +235,59 @@ namespace core
 				}
 				while (!header.readendi_.compare_exchange_weak(barrier, next, std::memory_order_release, std::memory_order_relaxed));
 			}
+
+			// reserves as many as `count` consecutive slots, returns the
+			// number of slots reserved (which is zero if full)
+			template <typename Header>
+			std::size_t checkout_write_slots(Header & header, std::size_t count, std::size_t & slot, std::size_t & next)
+			{
+				slot = header.writei_.load(std::memory_order_relaxed);
+
+				std::size_t reserved;
+				do
+				{
+					if (slot >= header.capacity())
+						return 0; // fake full
+
+					// pairs with the release in `consume_read_slots`
+					const std::size_t readi = header.readi_.load(std::memory_order_acquire);
+
+					const std::size_t available = (slot < readi ? readi : readi + header.capacity()) - slot - 1;
+					reserved = std::min(count, available);
+					if (reserved == 0)
+						return 0; // full
+
+					next = utility::wrap_once(slot + reserved, header.capacity());
+				}
+				while (!header.writei_.compare_exchange_weak(slot, next, std::memory_order_relaxed));
+
+				return reserved;
+			}
+
+			// calls `f` for as many as `count` consecutive published
+			// slots, then frees them all at once, returns the number of
+			// slots consumed
+			template <typename Header, typename F>
+			std::size_t consume_read_slots(Header & header, std::size_t count, F && f)
+			{
+				const std::size_t first = header.readi_.load(std::memory_order_relaxed);
+				const std::size_t barrier = header.readendi_.load(std::memory_order_acquire);
+
+				std::size_t slot = first;
+				std::size_t consumed = 0;
+				for (; consumed < count && slot != barrier; consumed++)
+				{
+					f(slot);
+
+					slot = utility::wrap_reset(slot + 1, header.capacity());
+				}
+
+				if (slot != first)
+				{
+					header.readi_.store(slot, std::memory_order_release);
+				}
+				return consumed;
+			}
 		}
 
 		template <typename Storage>
@@ -240,11 +310,43 @@ namespace core
 
 			using Header = typename allocator_type::value_type;
 
+		public:
+			// the most retired pages a queue can hold on to for reuse
+			static constexpr std::size_t max_free_pages = 8;
+
+			struct page_stats
+			{
+				// pages taken from the allocator
+				std::size_t allocated;
+				// pages reused from the free list
+				std::size_t recycled;
+				// pages given back to the allocator
+				std::size_t released;
+			};
+
 		private:
+			struct FreePage
+			{
+				Header * header;
+				std::size_t capacity;
+			};
+
 			struct empty_allocator_hack : allocator_type
 			{
 				std::atomic<Header *> write_header;
 
+				// retired pages (without a constructed header) that are
+				// kept around so that a queue that keeps growing and
+				// draining does not have to go through the allocator
+				utility::spinlock free_lock;
+				std::size_t free_count = 0;
+				std::size_t free_limit = 2;
+				FreePage free_pages[max_free_pages];
+
+				std::atomic_size_t allocated{0};
+				std::atomic_size_t recycled{0};
+				std::atomic_size_t released{0};
+
 				~empty_allocator_hack()
 				{
 					for (Header * header = write_header.load(std::memory_order_acquire); header != &detail::PageQueueCommon<storage_traits>::empty_header;)
@@ -257,6 +359,11 @@ namespace core
 
 						header = previous;
 					}
+
+					for (std::size_t i = 0; i < free_count; i++)
+					{
+						allocator_traits::deallocate(*this, free_pages[i].header, free_pages[i].capacity);
+					}
 				}
 				empty_allocator_hack()
 					: write_header{&detail::PageQueueCommon<storage_traits>::empty_header}
@@ -266,6 +373,7 @@ namespace core
 				{
 					Header * const header = allocator_traits::allocate(*this, capacity);
 					debug_assert(header);
+					allocated.store(1, std::memory_order_relaxed);
 
 					allocator_traits::construct(*this, header, detail::PageQueueCommon<storage_traits>::empty_header, capacity);
 
@@ -280,6 +388,37 @@ namespace core
 			{}
 
 		public:
+			page_stats stats() const
+			{
+				return page_stats{
+					impl_.allocated.load(std::memory_order_relaxed),
+					impl_.recycled.load(std::memory_order_relaxed),
+					impl_.released.load(std::memory_order_relaxed)};
+			}
+
+			// sets how many retired pages to keep for reuse (at most
+			// `max_free_pages`), pages above the limit are released
+			void set_free_page_limit(std::size_t count)
+			{
+				FreePage excess[max_free_pages];
+				std::size_t excess_count = 0;
+				{
+					std::lock_guard<utility::spinlock> guard(impl_.free_lock);
+
+					impl_.free_limit = std::min(count, max_free_pages);
+					while (impl_.free_count > impl_.free_limit)
+					{
+						excess[excess_count++] = impl_.free_pages[--impl_.free_count];
+					}
+				}
+
+				for (std::size_t i = 0; i < excess_count; i++)
+				{
+					allocator_traits::deallocate(allocator(), excess[i].header, excess[i].capacity);
+				}
+				impl_.released.fetch_add(excess_count, std::memory_order_relaxed);
+			}
+
 			template <typename ...Ps>
 			bool try_emplace(Ps && ...ps)
 			{
@@ -289,22 +428,9 @@ namespace core
 				std::size_t next;
 				while (!detail::checkout_write_slot(*header, slot, next))
 				{
-					const auto new_capacity = ReservationStrategy{}(header->capacity() + 1);
-					Header * const new_header = allocator_traits::allocate(allocator(), new_capacity);
-					if (!new_header)
+					header = grow(header, 1);
+					if (!header)
 						return false;
-
-					allocator_traits::construct(allocator(), new_header, *header, new_capacity);
-
-					if (write_header().compare_exchange_strong(header, new_header, std::memory_order_release, std::memory_order_relaxed))
-					{
-						header = new_header;
-					}
-					else
-					{
-						allocator_traits::destroy(allocator(), new_header);
-						allocator_traits::deallocate(allocator(), new_header, new_capacity);
-					}
 				}
 
 				auto p = allocator().address(header, header->capacity()) + slot;
@@ -315,33 +441,49 @@ namespace core
 				return true;
 			}
 
-			bool try_pop(reference value)
+			// pushes the elements in order and returns how many of them
+			// were pushed, which is less than all of them only if memory
+			// runs out
+			template <typename ForwardIt>
+			std::size_t try_push_range(ForwardIt first, ForwardIt last)
 			{
-				Header * read_header = write_header().load(std::memory_order_acquire);
+				Header * header = write_header().load(std::memory_order_acquire);
 
-				if (read_header->previous_ != &empty_header())
+				std::size_t pushed = 0;
+				while (first != last)
 				{
-					Header * next_header;
-					do
+					const std::size_t count = std::distance(first, last);
+
+					std::size_t slot;
+					std::size_t next;
+					const std::size_t reserved = detail::checkout_write_slots(*header, count, slot, next);
+					if (reserved == 0)
 					{
-						next_header = read_header;
-						read_header = read_header->previous_;
+						header = grow(header, count);
+						if (!header)
+							break;
+
+						continue;
 					}
-					while (read_header->previous_ != &empty_header());
 
-					const std::size_t slot = read_header->readi_.load(std::memory_order_relaxed);
-					const std::size_t writei = read_header->writei_.load(std::memory_order_relaxed);
-					if (slot == writei)
+					auto p = allocator().address(header, header->capacity());
+					for (std::size_t i = 0, sloti = slot; i < reserved; i++, ++first)
 					{
-						next_header->previous_ = &empty_header();
+						allocator().construct(p + sloti, *first);
 
-						const auto capacity = read_header->capacity();
-						allocator_traits::destroy(allocator(), read_header);
-						allocator_traits::deallocate(allocator(), read_header, capacity);
-
-						read_header = next_header;
+						sloti = utility::wrap_reset(sloti + 1, header->capacity());
 					}
+
+					detail::checkin_write_slot(*header, slot, next);
+
+					pushed += reserved;
 				}
+				return pushed;
+			}
+
+			bool try_pop(reference value)
+			{
+				Header * const read_header = checkout_read_header();
 
 				const std::size_t slot = read_header->readi_.load(std::memory_order_relaxed);
 				const std::size_t barrier = read_header->readendi_.load(std::memory_order_relaxed);
@@ -362,6 +504,37 @@ namespace core
 				return true;
 			}
 
+			// pops as many as `count` elements into `out`, returns the
+			// number of elements popped
+			template <typename OutputIt>
+			std::size_t try_pop_n(OutputIt out, std::size_t count)
+			{
+				std::size_t popped = 0;
+				while (popped < count)
+				{
+					Header * const read_header = checkout_read_header();
+
+					auto p = allocator().address(read_header, read_header->capacity());
+					const std::size_t consumed = detail::consume_read_slots(*read_header, count - popped, [&](std::size_t slot)
+					{
+						using utility::iter_move;
+						*out = iter_move(p + slot);
+						++out;
+						allocator().destroy(p + slot);
+					});
+					if (consumed == 0)
+						break;
+
+					popped += consumed;
+				}
+				return popped;
+			}
+
+			std::size_t drain_into(utility::span<value_type> values)
+			{
+				return try_pop_n(values.begin(), values.size());
+			}
+
 			bool try_push(const_reference value)
 			{
 				return try_emplace(value);
@@ -382,6 +555,122 @@ namespace core
 				return try_push(rvalue_reference(std::forward<P>(value)));
 			}
 		private:
+			// makes room for at least `count` more elements, returns the
+			// header to write to or null if out of memory
+			Header * grow(Header * header, std::size_t count)
+			{
+				FreePage page = checkout_page(header->capacity(), ReservationStrategy{}(header->capacity() + count));
+				if (!page.header)
+					return nullptr;
+
+				Header * const new_header = page.header;
+				allocator_traits::construct(allocator(), new_header, *header, page.capacity);
+
+				if (write_header().compare_exchange_strong(header, new_header, std::memory_order_release, std::memory_order_relaxed))
+					return new_header;
+
+				allocator_traits::destroy(allocator(), new_header);
+				checkin_page(page);
+				return header;
+			}
+
+			// reuses the smallest free page that is no smaller than
+			// `min_capacity`, or allocates a new one of `capacity`
+			//
+			// a reused page does not make the queue grow but it does not
+			// make it shrink either, and the next page will be twice as
+			// big anyway
+			FreePage checkout_page(std::size_t min_capacity, std::size_t capacity)
+			{
+				{
+					std::lock_guard<utility::spinlock> guard(impl_.free_lock);
+
+					std::size_t best = impl_.free_count;
+					for (std::size_t i = 0; i < impl_.free_count; i++)
+					{
+						if (impl_.free_pages[i].capacity >= min_capacity && (best == impl_.free_count || impl_.free_pages[i].capacity < impl_.free_pages[best].capacity))
+						{
+							best = i;
+						}
+					}
+
+					if (best != impl_.free_count)
+					{
+						const FreePage page = impl_.free_pages[best];
+						impl_.free_pages[best] = impl_.free_pages[--impl_.free_count];
+
+						impl_.recycled.fetch_add(1, std::memory_order_relaxed);
+						return page;
+					}
+				}
+
+				Header * const header = allocator_traits::allocate(allocator(), capacity);
+				if (header)
+				{
+					impl_.allocated.fetch_add(1, std::memory_order_relaxed);
+				}
+				return FreePage{header, capacity};
+			}
+
+			// puts the page on the free list, if the list is full the
+			// smallest page is released
+			void checkin_page(FreePage page)
+			{
+				{
+					std::lock_guard<utility::spinlock> guard(impl_.free_lock);
+
+					if (impl_.free_count < impl_.free_limit)
+					{
+						impl_.free_pages[impl_.free_count++] = page;
+						return;
+					}
+
+					for (std::size_t i = 0; i < impl_.free_count; i++)
+					{
+						if (impl_.free_pages[i].capacity < page.capacity)
+						{
+							using std::swap;
+							swap(impl_.free_pages[i], page);
+						}
+					}
+				}
+
+				allocator_traits::deallocate(allocator(), page.header, page.capacity);
+				impl_.released.fetch_add(1, std::memory_order_relaxed);
+			}
+
+			// frees the oldest page if it has been read to its end,
+			// returns the page to read from
+			Header * checkout_read_header()
+			{
+				Header * read_header = write_header().load(std::memory_order_acquire);
+
+				if (read_header->previous_ != &empty_header())
+				{
+					Header * next_header;
+					do
+					{
+						next_header = read_header;
+						read_header = read_header->previous_;
+					}
+					while (read_header->previous_ != &empty_header());
+
+					const std::size_t slot = read_header->readi_.load(std::memory_order_relaxed);
+					const std::size_t writei = read_header->writei_.load(std::memory_order_relaxed);
+					if (slot == writei)
+					{
+						next_header->previous_ = &empty_header();
+
+						const auto capacity = read_header->capacity();
+						allocator_traits::destroy(allocator(), read_header);
+						checkin_page(FreePage{read_header, capacity});
+
+						read_header = next_header;
+					}
+				}
+				return read_header;
+			}
+
 			allocator_type & allocator() { return impl_; }
 			const allocator_type & allocator() const { return impl_; }
 
@@ -391,6 +680,9 @@ namespace core
 			static Header & empty_header() { return detail::PageQueueCommon<storage_traits>::empty_header; }
 		};
 
+		template <typename Storage>
+		constexpr std::size_t PageQueue<Storage>::max_free_pages;
+
 		template <typename Storage>
 		class SimpleQueue
 		{
@@ -451,6 +743,49 @@ namespace core
 				return true;
 			}
 
+			// pushes the elements in order and returns how many of them
+			// were pushed, which is less than all of them only if the
+			// queue gets full
+			template <typename ForwardIt>
+			std::size_t try_push_range(ForwardIt first, ForwardIt last)
+			{
+				std::size_t slot;
+				std::size_t next;
+				const std::size_t reserved = detail::checkout_write_slots(data, std::distance(first, last), slot, next);
+				if (reserved == 0)
+					return 0;
+
+				for (std::size_t i = 0, sloti = slot; i < reserved; i++, ++first)
+				{
+					data.storage_.construct_at_(data.storage_.begin(data.capacity()) + sloti, *first);
+
+					sloti = utility::wrap_reset(sloti + 1, data.capacity());
+				}
+
+				detail::checkin_write_slot(data, slot, next);
+
+				return reserved;
+			}
+
+			// pops as many as `count` elements into `out`, returns the
+			// number of elements popped
+			template <typename OutputIt>
+			std::size_t try_pop_n(OutputIt out, std::size_t count)
+			{
+				return detail::consume_read_slots(data, count, [&](std::size_t slot)
+				{
+					using utility::iter_move;
+					*out = iter_move(data.storage_.data(data.storage_.begin(data.capacity())) + slot);
+					++out;
+					data.storage_.destruct_at(data.storage_.begin(data.capacity()) + slot);
+				});
+			}
+
+			std::size_t drain_into(utility::span<value_type> values)
+			{
+				return try_pop_n(values.begin(), values.size());
+			}
+
 			bool try_push(const_reference value)
 			{
 				return try_emplace(value);
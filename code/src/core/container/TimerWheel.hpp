@@ -0,0 +1,325 @@
+#pragma once
+
+#include "utility/bitmanip.hpp"
+#include "utility/container/vector.hpp"
+
+#include <cstdint>
+
+namespace core
+{
+	namespace container
+	{
+		// a hierarchical timer wheel with four levels of 64 slots each,
+		// timers that are further away than the wheel reaches are kept in
+		// the last level until they come within reach
+		//
+		// inserting and erasing timers takes constant time, advancing the
+		// wheel costs a step per tick plus moving each timer down at most
+		// once per level
+		template <typename T>
+		class TimerWheel
+		{
+		public:
+
+			struct Handle
+			{
+				uint32_t index;
+				uint32_t generation; // zero is never used
+
+				explicit operator bool () const { return generation != 0; }
+
+				friend bool operator == (Handle a, Handle b) { return a.index == b.index && a.generation == b.generation; }
+				friend bool operator != (Handle a, Handle b) { return !(a == b); }
+			};
+
+		private:
+
+			enum : uint32_t { npos = uint32_t(-1) };
+
+			enum : uint32_t
+			{
+				free_slot = uint32_t(-1),
+				unlinked_slot = uint32_t(-2),
+			};
+
+			static constexpr int slot_bits = 6;
+			static constexpr int slot_count = 1 << slot_bits;
+			static constexpr uint64_t slot_mask = slot_count - 1;
+			static constexpr int level_count = 4;
+
+			static constexpr uint64_t max_delta = uint64_t(1) << (slot_bits * level_count);
+
+			struct Node
+			{
+				uint64_t expiry;
+
+				// also links the free nodes together
+				uint32_t next;
+				uint32_t previous;
+
+				uint32_t generation;
+				uint32_t slot;
+
+				T value;
+			};
+
+		private:
+
+			utility::heap_vector<Node> nodes_;
+			uint32_t free_ = npos;
+
+			uint32_t heads_[level_count * slot_count];
+			uint64_t masks_[level_count] = {};
+
+			uint64_t now_ = 0;
+			ext::usize size_ = 0;
+
+		public:
+
+			TimerWheel()
+			{
+				for (uint32_t & head : heads_)
+				{
+					head = npos;
+				}
+			}
+
+		public:
+
+			uint64_t now() const { return now_; }
+
+			ext::usize size() const { return size_; }
+
+			// the number of ticks until something may happen, which is
+			// either a timer running out or timers being moved down a level
+			uint64_t ticks_until_next() const
+			{
+				uint64_t ticks = uint64_t(-1);
+
+				if (masks_[0] != 0)
+				{
+					const int shift = static_cast<int>((now_ + 1) & slot_mask);
+					const uint64_t rotated = shift == 0 ? masks_[0] : (masks_[0] >> shift) | (masks_[0] << (slot_count - shift));
+
+					ticks = 1 + utility::ntz(rotated);
+				}
+
+				for (int level = 1; level < level_count; level++)
+				{
+					if (masks_[level] != 0)
+					{
+						const uint64_t boundary = slot_count - (now_ & slot_mask);
+						if (boundary < ticks)
+						{
+							ticks = boundary;
+						}
+						break;
+					}
+				}
+
+				return ticks;
+			}
+
+			// the timer runs out after delay ticks, but no sooner than the
+			// next tick
+			//
+			// returns a null handle on failure
+			Handle insert(uint64_t delay, T && value)
+			{
+				uint32_t index;
+				if (free_ != npos)
+				{
+					index = free_;
+					free_ = nodes_[index].next;
+				}
+				else
+				{
+					if (!nodes_.try_emplace_back(Node{0, npos, npos, 0, free_slot, T()}))
+						return Handle{};
+
+					index = static_cast<uint32_t>(nodes_.size() - 1);
+				}
+
+				Node & node = nodes_[index];
+				node.generation++;
+				if (node.generation == 0)
+				{
+					node.generation++;
+				}
+				node.value = std::move(value);
+				node.expiry = now_ + (delay > 0 ? delay : 1);
+
+				link(index);
+				size_++;
+
+				return Handle{index, node.generation};
+			}
+
+			T * find(Handle handle)
+			{
+				if (!contains(handle))
+					return nullptr;
+
+				return &nodes_[handle.index].value;
+			}
+
+			bool erase(Handle handle)
+			{
+				if (!contains(handle))
+					return false;
+
+				Node & node = nodes_[handle.index];
+				if (node.slot != unlinked_slot)
+				{
+					unlink(handle.index);
+				}
+
+				node.value = T();
+				node.slot = free_slot;
+				node.next = free_;
+				free_ = handle.index;
+				size_--;
+
+				return true;
+			}
+
+			// starts the timer over again, it is fine to do this on a
+			// timer that has run out but has not yet been erased
+			bool reschedule(Handle handle, uint64_t delay)
+			{
+				if (!contains(handle))
+					return false;
+
+				Node & node = nodes_[handle.index];
+				if (node.slot != unlinked_slot)
+				{
+					unlink(handle.index);
+				}
+
+				node.expiry = now_ + (delay > 0 ? delay : 1);
+				link(handle.index);
+
+				return true;
+			}
+
+			// calls expire(handle, value) for every timer that runs out
+			// during the given number of ticks, in the order they run out
+			//
+			// timers that have run out are not erased, that is up to the
+			// caller to do (or to reschedule them), note that the value
+			// reference is invalidated by inserting new timers
+			template <typename F>
+			void advance(uint64_t ticks, F && expire)
+			{
+				for (; ticks > 0; ticks--)
+				{
+					if ((masks_[0] | masks_[1] | masks_[2] | masks_[3]) == 0)
+					{
+						now_ += ticks;
+						return;
+					}
+
+					now_++;
+
+					const uint32_t slot = static_cast<uint32_t>(now_ & slot_mask);
+					if (slot == 0)
+					{
+						cascade(1);
+					}
+
+					while (heads_[slot] != npos)
+					{
+						const uint32_t index = heads_[slot];
+						unlink(index);
+
+						expire(Handle{index, nodes_[index].generation}, nodes_[index].value);
+					}
+				}
+			}
+
+		private:
+
+			bool contains(Handle handle) const
+			{
+				return handle.index < nodes_.size() &&
+					nodes_[handle.index].generation == handle.generation &&
+					nodes_[handle.index].slot != free_slot;
+			}
+
+			void cascade(int level)
+			{
+				const uint32_t slot = static_cast<uint32_t>((now_ >> (slot_bits * level)) & slot_mask);
+				if (slot == 0 && level + 1 < level_count)
+				{
+					cascade(level + 1);
+				}
+
+				const uint32_t list = level * slot_count + slot;
+				while (heads_[list] != npos)
+				{
+					const uint32_t index = heads_[list];
+					unlink(index);
+					link(index);
+				}
+			}
+
+			void link(uint32_t index)
+			{
+				Node & node = nodes_[index];
+
+				const uint64_t delta = now_ < node.expiry ? node.expiry - now_ : 0;
+
+				int level = level_count - 1;
+				uint64_t expiry = now_ + max_delta - 1;
+				if (delta < max_delta)
+				{
+					level = 0;
+					while (delta >> (slot_bits * (level + 1)) != 0)
+					{
+						level++;
+					}
+					expiry = node.expiry;
+				}
+
+				const uint32_t slot = static_cast<uint32_t>((expiry >> (slot_bits * level)) & slot_mask);
+				const uint32_t list = level * slot_count + slot;
+
+				node.slot = list;
+				node.previous = npos;
+				node.next = heads_[list];
+				if (node.next != npos)
+				{
+					nodes_[node.next].previous = index;
+				}
+				heads_[list] = index;
+				masks_[level] |= uint64_t(1) << slot;
+			}
+
+			void unlink(uint32_t index)
+			{
+				Node & node = nodes_[index];
+
+				if (node.previous != npos)
+				{
+					nodes_[node.previous].next = node.next;
+				}
+				else
+				{
+					heads_[node.slot] = node.next;
+				}
+
+				if (node.next != npos)
+				{
+					nodes_[node.next].previous = node.previous;
+				}
+
+				if (heads_[node.slot] == npos)
+				{
+					masks_[node.slot / slot_count] &= ~(uint64_t(1) << (node.slot % slot_count));
+				}
+
+				node.slot = unlinked_slot;
+			}
+		};
+	}
+}
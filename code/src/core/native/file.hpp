@@ -1,5 +1,9 @@
 #pragma once
 
+#include "config.h"
+
+#include "utility/ext/stddef.hpp"
+
 #include "ful/cstr.hpp"
 
 namespace core
@@ -11,6 +15,35 @@ namespace core
 {
 	namespace native
 	{
+		// files up to this size are copied into a buffer rather than
+		// mapped into memory
+		constexpr ext::usize default_small_file_size = static_cast<ext::usize>(1) << 14;
+		// files up to this size are paged in as they are mapped
+		constexpr ext::usize default_populate_file_size = static_cast<ext::usize>(1) << 26;
+
+		// the sizes that try_read_file goes by, see the defaults above
+		void set_read_sizes(ext::usize small_file_size, ext::usize populate_file_size);
+
+		// the number of files try_read_file has read in each way
+		struct read_statistics
+		{
+			ext::usize buffered = 0;
+			ext::usize populated = 0;
+			ext::usize mapped = 0;
+		};
+
+		read_statistics get_read_statistics();
+
+#if FILE_SYSTEM_USE_POSIX
+		// buffers for small files, shared by every thread so that one
+		// thread can give back a buffer that another thread took
+		//
+		// \param capacity The capacity of the buffer, if a new one has to
+		//                  be allocated.
+		char * take_file_buffer(ext::usize size, ext::usize & capacity);
+		void give_file_buffer(char * ptr, ext::usize capacity);
+#endif
+
 		int try_read_file(ful::cstr_utf8 filepath, bool (* callback)(core::content & content, void * data), void * data);
 	}
 }
@@ -12,10 +12,29 @@
 
 #include <Windows.h>
 
+#include <atomic>
+
+namespace
+{
+	std::atomic<ext::usize> mapped_count{0};
+}
+
 namespace core
 {
 	namespace native
 	{
+		void set_read_sizes(ext::usize /*small_file_size*/, ext::usize /*populate_file_size*/)
+		{
+			// every file is mapped
+		}
+
+		read_statistics get_read_statistics()
+		{
+			read_statistics statistics;
+			statistics.mapped = mapped_count.load(std::memory_order_relaxed);
+			return statistics;
+		}
+
 		int try_read_file(ful::cstr_utf8 filepath, bool (* callback)(core::content & content, void * data), void * data)
 		{
 			ful::heap_string_utfw wide_filepath; // todo static
@@ -56,6 +75,8 @@ namespace core
 					return 0;
 				}
 
+				mapped_count.fetch_add(1, std::memory_order_relaxed);
+
 				core::content content(filepath, file_view, file_size.QuadPart);
 
 				const bool ret = callback(content, data);
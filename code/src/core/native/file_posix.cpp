@@ -6,17 +6,160 @@
 #include "core/debug.hpp"
 #include "core/native/file.hpp"
 
-#include <utility>
+#include "utility/ext/unistd.hpp"
+#include "utility/spinlock.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
 
 #include <errno.h>
 #include <fcntl.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
 
+namespace
+{
+	std::atomic<ext::usize> small_size{core::native::default_small_file_size};
+	std::atomic<ext::usize> populate_size{core::native::default_populate_file_size};
+
+	std::atomic<ext::usize> buffered_count{0};
+	std::atomic<ext::usize> populated_count{0};
+	std::atomic<ext::usize> mapped_count{0};
+
+	// the buffers that are not in use, a thread takes one for as long as
+	// it reads a file, in case the callback reads another file
+	class FileBuffers
+	{
+		enum : std::size_t { max_count = 16 };
+
+		struct Buffer
+		{
+			char * ptr;
+			ext::usize capacity;
+		};
+
+		utility::spinlock lock_;
+		Buffer buffers_[max_count];
+		std::size_t count_ = 0;
+
+	public:
+		~FileBuffers()
+		{
+			for (std::size_t i = 0; i < count_; i++)
+			{
+				std::free(buffers_[i].ptr);
+			}
+		}
+		FileBuffers() = default;
+		FileBuffers(const FileBuffers &) = delete;
+		FileBuffers & operator = (const FileBuffers &) = delete;
+
+	public:
+		char * take(ext::usize size, ext::usize & capacity)
+		{
+			{
+				std::lock_guard<utility::spinlock> guard(lock_);
+
+				for (std::size_t i = count_; i-- > 0;)
+				{
+					if (size <= buffers_[i].capacity)
+					{
+						char * const ptr = buffers_[i].ptr;
+						capacity = buffers_[i].capacity;
+
+						count_--;
+						buffers_[i] = buffers_[count_];
+						return ptr;
+					}
+				}
+			}
+
+			if (capacity < size)
+			{
+				capacity = size;
+			}
+			return static_cast<char *>(std::malloc(capacity));
+		}
+
+		void give(char * ptr, ext::usize capacity)
+		{
+			{
+				std::lock_guard<utility::spinlock> guard(lock_);
+
+				if (count_ < max_count)
+				{
+					buffers_[count_] = Buffer{ptr, capacity};
+					count_++;
+					return;
+				}
+			}
+
+			std::free(ptr);
+		}
+	};
+
+	FileBuffers file_buffers;
+
+	int read_small_file(ful::cstr_utf8 filepath, int fd, ext::usize size, bool (* callback)(core::content & content, void * data), void * data)
+	{
+		ext::usize capacity = small_size.load(std::memory_order_relaxed);
+		char * const buffer = file_buffers.take(size, capacity);
+		if (!debug_verify(buffer))
+		{
+			debug_verify(::close(fd) == 0, "failed with errno ", errno);
+			return 0;
+		}
+
+		const bool read = debug_verify(ext::pread_all_nonzero(fd, buffer, size, 0) == size, "failed with errno ", errno);
+
+		debug_verify(::close(fd) == 0, "failed with errno ", errno);
+
+		int ret = 0;
+		if (read)
+		{
+			buffered_count.fetch_add(1, std::memory_order_relaxed);
+
+			core::content content(filepath, buffer, size);
+
+			ret = callback(content, data) ? 1 : -1;
+		}
+
+		file_buffers.give(buffer, capacity);
+
+		return ret;
+	}
+}
+
 namespace core
 {
 	namespace native
 	{
+		void set_read_sizes(ext::usize small_file_size, ext::usize populate_file_size)
+		{
+			small_size.store(small_file_size, std::memory_order_relaxed);
+			populate_size.store(populate_file_size, std::memory_order_relaxed);
+		}
+
+		read_statistics get_read_statistics()
+		{
+			read_statistics statistics;
+			statistics.buffered = buffered_count.load(std::memory_order_relaxed);
+			statistics.populated = populated_count.load(std::memory_order_relaxed);
+			statistics.mapped = mapped_count.load(std::memory_order_relaxed);
+			return statistics;
+		}
+
+		char * take_file_buffer(ext::usize size, ext::usize & capacity)
+		{
+			return file_buffers.take(size, capacity);
+		}
+
+		void give_file_buffer(char * ptr, ext::usize capacity)
+		{
+			file_buffers.give(ptr, capacity);
+		}
+
 		int try_read_file(ful::cstr_utf8 filepath, bool (* callback)(core::content & content, void * data), void * data)
 		{
 			const int fd = ::open(filepath.c_str(), O_RDONLY);
@@ -29,7 +172,15 @@ namespace core
 			struct stat statbuf;
 			debug_verify(::fstat(fd, &statbuf) == 0, "failed with errno ", errno);
 
-			void * map = ::mmap(nullptr, statbuf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			const ext::usize size = statbuf.st_size;
+			// small files are copied rather than mapped, as mapping and
+			// unmapping them costs more than the copy
+			if (0 < size && size <= small_size.load(std::memory_order_relaxed))
+				return read_small_file(filepath, fd, size, callback, data);
+
+			const bool populate = size <= populate_size.load(std::memory_order_relaxed);
+
+			void * map = ::mmap(nullptr, size, PROT_READ, populate ? MAP_PRIVATE | MAP_POPULATE : MAP_PRIVATE, fd, 0);
 			if (map == MAP_FAILED)
 			{
 				debug_verify(::close(fd) == 0, "failed with errno ", errno);
@@ -37,11 +188,13 @@ namespace core
 				return 0;
 			}
 
-			core::content content(filepath, map, statbuf.st_size);
+			(populate ? populated_count : mapped_count).fetch_add(1, std::memory_order_relaxed);
+
+			core::content content(filepath, map, size);
 
 			const bool ret = callback(content, data);
 
-			debug_verify(::munmap(map, statbuf.st_size) == 0, "failed with errno ", errno);
+			debug_verify(::munmap(map, size) == 0, "failed with errno ", errno);
 			debug_verify(::close(fd) == 0, "failed with errno ", errno);
 
 			return ret ? 1 : -1;
@@ -4,6 +4,8 @@
 
 #if THREAD_USE_KERNEL32
 # include <Windows.h>
+#elif SYNC_USE_FUTEX
+# include "core/sync/futex.hpp"
 #else
 # include "core/sync/ConditionVariable.hpp"
 # include "core/sync/Mutex.hpp"
@@ -13,6 +15,19 @@ namespace core
 {
 namespace sync
 {
+#if SYNC_USE_FUTEX
+	namespace detail
+	{
+		enum : uint32_t
+		{
+			event_unset = 0,
+			event_set = 1,
+			// unset and there may be someone sleeping on it
+			event_unset_waiting = 2,
+		};
+	}
+#endif
+
 	/** ManualReset - to use manual reset or not */
 	template <bool ManualReset = false>
 	class Event
@@ -24,6 +39,9 @@ namespace sync
 #if THREAD_USE_KERNEL32
 		/**  */
 		HANDLE hEvent;
+#elif SYNC_USE_FUTEX
+		/**  */
+		std::atomic<uint32_t> state;
 #else
 		/**  */
 		Mutex mutex;
@@ -58,6 +76,15 @@ namespace sync
 		{
 #if THREAD_USE_KERNEL32
 			return WaitForSingleObject(hEvent, milliseconds) == WAIT_OBJECT_0;
+#elif SYNC_USE_FUTEX
+			if (try_consume(0))
+				return true;
+
+			struct timespec deadline;
+			if (!detail::futex_deadline(milliseconds, deadline))
+				return false;
+
+			return park(&deadline);
 #else
 			struct timespec ts;
 			if (clock_gettime(CLOCK_REALTIME, &ts) != 0)
@@ -65,6 +92,11 @@ namespace sync
 
 			ts.tv_sec += milliseconds / 1000;
 			ts.tv_nsec += (milliseconds % 1000) * 1000 * 1000;
+			if (ts.tv_nsec >= 1000 * 1000 * 1000)
+			{
+				ts.tv_sec++;
+				ts.tv_nsec -= 1000 * 1000 * 1000;
+			}
 
 			std::lock_guard<Mutex> lock{mutex};
 			while (!is_set)
@@ -76,6 +108,64 @@ namespace sync
 			return true;
 #endif
 		}
+
+#if SYNC_USE_FUTEX
+	private:
+		// spins for a little while in the hope that the event gets set
+		bool try_consume(int spin_count)
+		{
+			for (int i = 0;; i++)
+			{
+				uint32_t expected = detail::event_set;
+				if (state.compare_exchange_weak(expected, detail::event_unset, std::memory_order_acquire, std::memory_order_relaxed))
+					return true;
+
+				if (i >= spin_count)
+					return false;
+
+				fiw_pause();
+			}
+		}
+
+		bool park(const struct timespec * deadline)
+		{
+			for (int i = 0; i < detail::futex_spin_count; i++)
+			{
+				if (state.load(std::memory_order_relaxed) == detail::event_set)
+					break;
+
+				fiw_pause();
+			}
+
+			// once we have been sleeping we cannot tell whether anyone
+			// else is still sleeping, so the event is left in the waiting
+			// state after consuming it
+			uint32_t unset = detail::event_unset;
+			while (true)
+			{
+				uint32_t current = state.load(std::memory_order_relaxed);
+				if (current == detail::event_set)
+				{
+					if (state.compare_exchange_weak(current, unset, std::memory_order_acquire, std::memory_order_relaxed))
+						return true;
+
+					continue;
+				}
+
+				if (current == detail::event_unset &&
+				    !state.compare_exchange_weak(current, detail::event_unset_waiting, std::memory_order_relaxed, std::memory_order_relaxed))
+					continue;
+
+				struct timespec timeout;
+				if (deadline && !detail::futex_timeout(*deadline, timeout))
+					return false;
+
+				detail::futex_wait(state, detail::event_unset_waiting, deadline ? &timeout : nullptr);
+
+				unset = detail::event_unset_waiting;
+			}
+		}
+#endif
 	};
 	/** true - to use manual reset or not */
 	template <>
@@ -88,6 +178,9 @@ namespace sync
 #if THREAD_USE_KERNEL32
 		/**  */
 		HANDLE hEvent;
+#elif SYNC_USE_FUTEX
+		/**  */
+		std::atomic<uint32_t> state;
 #else
 		/**  */
 		Mutex mutex;
@@ -124,6 +217,15 @@ namespace sync
 		{
 #if THREAD_USE_KERNEL32
 			return WaitForSingleObject(hEvent, milliseconds) == WAIT_OBJECT_0;
+#elif SYNC_USE_FUTEX
+			if (state.load(std::memory_order_acquire) == detail::event_set)
+				return true;
+
+			struct timespec deadline;
+			if (!detail::futex_deadline(milliseconds, deadline))
+				return false;
+
+			return park(&deadline);
 #else
 			struct timespec ts;
 			if (clock_gettime(CLOCK_REALTIME, &ts) != 0)
@@ -131,6 +233,11 @@ namespace sync
 
 			ts.tv_sec += milliseconds / 1000;
 			ts.tv_nsec += (milliseconds % 1000) * 1000 * 1000;
+			if (ts.tv_nsec >= 1000 * 1000 * 1000)
+			{
+				ts.tv_sec++;
+				ts.tv_nsec -= 1000 * 1000 * 1000;
+			}
 
 			std::lock_guard<Mutex> lock{mutex};
 			while (!is_set)
@@ -141,6 +248,37 @@ namespace sync
 			return true;
 #endif
 		}
+
+#if SYNC_USE_FUTEX
+	private:
+		bool park(const struct timespec * deadline)
+		{
+			for (int i = 0; i < detail::futex_spin_count; i++)
+			{
+				if (state.load(std::memory_order_acquire) == detail::event_set)
+					return true;
+
+				fiw_pause();
+			}
+
+			while (true)
+			{
+				uint32_t current = state.load(std::memory_order_acquire);
+				if (current == detail::event_set)
+					return true;
+
+				if (current == detail::event_unset &&
+				    !state.compare_exchange_weak(current, detail::event_unset_waiting, std::memory_order_relaxed, std::memory_order_relaxed))
+					continue;
+
+				struct timespec timeout;
+				if (deadline && !detail::futex_timeout(*deadline, timeout))
+					return false;
+
+				detail::futex_wait(state, detail::event_unset_waiting, deadline ? &timeout : nullptr);
+			}
+		}
+#endif
 	};
 }
 }
@@ -166,6 +304,12 @@ namespace sync
 		hEvent(CreateEventW(nullptr, FALSE, initial_state, nullptr))
 	{
 	}
+#elif SYNC_USE_FUTEX
+	template <bool ManualReset>
+	inline Event<ManualReset>::Event(const bool initial_state) :
+		state(initial_state ? detail::event_set : detail::event_unset)
+	{
+	}
 #else
 	template <bool ManualReset>
 	inline Event<ManualReset>::Event(const bool initial_state) :
@@ -179,6 +323,13 @@ namespace sync
 	{
 #if THREAD_USE_KERNEL32
 		return SetEvent(hEvent) == TRUE;
+#elif SYNC_USE_FUTEX
+		// the wake up is skipped if no one is sleeping
+		if (state.exchange(detail::event_set, std::memory_order_release) == detail::event_unset_waiting)
+		{
+			detail::futex_wake(state, 1);
+		}
+		return true;
 #else
 		std::lock_guard<Mutex> lock{mutex};
 		is_set = true;
@@ -192,6 +343,8 @@ namespace sync
 	{
 #if THREAD_USE_KERNEL32
 		return WaitForSingleObject(hEvent, INFINITE) == WAIT_OBJECT_0;
+#elif SYNC_USE_FUTEX
+		return try_consume(0) || park(nullptr);
 #else
 		std::lock_guard<Mutex> lock{mutex};
 		while (!is_set) cond.wait(mutex);
@@ -214,6 +367,11 @@ namespace sync
 		hEvent(CreateEventW(nullptr, TRUE, initial_state, nullptr))
 	{
 	}
+#elif SYNC_USE_FUTEX
+	inline Event<true>::Event(const bool initial_state) :
+		state(initial_state ? detail::event_set : detail::event_unset)
+	{
+	}
 #else
 	inline Event<true>::Event(const bool initial_state) :
 		is_set(initial_state)
@@ -225,6 +383,10 @@ namespace sync
 	{
 #if THREAD_USE_KERNEL32
 		return ResetEvent(hEvent) == TRUE;
+#elif SYNC_USE_FUTEX
+		uint32_t expected = detail::event_set;
+		state.compare_exchange_strong(expected, detail::event_unset, std::memory_order_relaxed, std::memory_order_relaxed);
+		return true;
 #else
 		std::lock_guard<Mutex> lock{mutex};
 		is_set = false;
@@ -235,10 +397,21 @@ namespace sync
 	{
 #if THREAD_USE_KERNEL32
 		return SetEvent(hEvent) == TRUE;
+#elif SYNC_USE_FUTEX
+		// a manual reset event stays set, so everyone waiting should
+		// be released and not just one of them, but only if there is
+		// anyone sleeping at all
+		if (state.exchange(detail::event_set, std::memory_order_release) == detail::event_unset_waiting)
+		{
+			detail::futex_wake(state, INT_MAX);
+		}
+		return true;
 #else
 		std::lock_guard<Mutex> lock{mutex};
 		is_set = true;
-		cond.notify_one();
+		// a manual reset event stays set, so everyone waiting should
+		// be released and not just one of them
+		cond.notify_all();
 		return true;
 #endif
 	}
@@ -247,6 +420,8 @@ namespace sync
 	{
 #if THREAD_USE_KERNEL32
 		return WaitForSingleObject(hEvent, INFINITE) == WAIT_OBJECT_0;
+#elif SYNC_USE_FUTEX
+		return state.load(std::memory_order_acquire) == detail::event_set || park(nullptr);
 #else
 		std::lock_guard<Mutex> lock{mutex};
 		while (!is_set) cond.wait(mutex);
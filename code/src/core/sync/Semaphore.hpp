@@ -0,0 +1,202 @@
+#pragma once
+
+#include "config.h"
+
+#if THREAD_USE_KERNEL32
+# include <Windows.h>
+#elif SYNC_USE_FUTEX
+# include "core/sync/futex.hpp"
+#else
+# include "core/sync/ConditionVariable.hpp"
+# include "core/sync/Mutex.hpp"
+#endif
+
+#include <climits>
+
+namespace core
+{
+namespace sync
+{
+	/**
+	 * Counting semaphore, every call to signal lets one call to wait
+	 * through.
+	 */
+	class Semaphore
+	{
+	private:
+		using this_type = Semaphore;
+
+	private:
+#if THREAD_USE_KERNEL32
+		/**  */
+		HANDLE hSemaphore;
+#elif SYNC_USE_FUTEX
+		/**  */
+		std::atomic<uint32_t> count;
+		/**  */
+		std::atomic<uint32_t> waiters;
+#else
+		/**  */
+		Mutex mutex;
+		/**  */
+		ConditionVariable cond;
+		/**  */
+		unsigned int count;
+#endif
+
+	public:
+#if THREAD_USE_KERNEL32
+		/**  */
+		~Semaphore()
+		{
+			CloseHandle(hSemaphore);
+		}
+#endif
+		/**  */
+		Semaphore() : Semaphore(0) {}
+		/**  */
+		Semaphore(const this_type &) = delete;
+		/**  */
+		this_type & operator = (const this_type &) = delete;
+		/**  */
+		explicit Semaphore(unsigned int initial_count)
+#if THREAD_USE_KERNEL32
+			: hSemaphore(CreateSemaphoreW(nullptr, initial_count, LONG_MAX, nullptr))
+#elif SYNC_USE_FUTEX
+			: count(initial_count)
+			, waiters(0)
+#else
+			: count(initial_count)
+#endif
+		{}
+
+	public:
+		/**  */
+		bool signal()
+		{
+#if THREAD_USE_KERNEL32
+			return ReleaseSemaphore(hSemaphore, 1, nullptr) == TRUE;
+#elif SYNC_USE_FUTEX
+			count.fetch_add(1, std::memory_order_seq_cst);
+			// pairs with the increment of waiters in `park`, either we
+			// see the waiter or it sees the new count
+			if (waiters.load(std::memory_order_seq_cst) != 0)
+			{
+				detail::futex_wake(count, 1);
+			}
+			return true;
+#else
+			std::lock_guard<Mutex> lock{mutex};
+			count++;
+			cond.notify_one();
+			return true;
+#endif
+		}
+
+		/**  */
+		bool try_wait()
+		{
+#if THREAD_USE_KERNEL32
+			return WaitForSingleObject(hSemaphore, 0) == WAIT_OBJECT_0;
+#elif SYNC_USE_FUTEX
+			uint32_t current = count.load(std::memory_order_relaxed);
+			while (current != 0)
+			{
+				if (count.compare_exchange_weak(current, current - 1, std::memory_order_acquire, std::memory_order_relaxed))
+					return true;
+			}
+			return false;
+#else
+			std::lock_guard<Mutex> lock{mutex};
+			if (count == 0)
+				return false;
+
+			count--;
+			return true;
+#endif
+		}
+
+		/**  */
+		bool wait()
+		{
+#if THREAD_USE_KERNEL32
+			return WaitForSingleObject(hSemaphore, INFINITE) == WAIT_OBJECT_0;
+#elif SYNC_USE_FUTEX
+			return try_wait() || park(nullptr);
+#else
+			std::lock_guard<Mutex> lock{mutex};
+			while (count == 0) cond.wait(mutex);
+			count--;
+			return true;
+#endif
+		}
+
+		bool wait(int milliseconds)
+		{
+#if THREAD_USE_KERNEL32
+			return WaitForSingleObject(hSemaphore, milliseconds) == WAIT_OBJECT_0;
+#elif SYNC_USE_FUTEX
+			if (try_wait())
+				return true;
+
+			struct timespec deadline;
+			if (!detail::futex_deadline(milliseconds, deadline))
+				return false;
+
+			return park(&deadline);
+#else
+			struct timespec ts;
+			if (clock_gettime(CLOCK_REALTIME, &ts) != 0)
+				return false;
+
+			ts.tv_sec += milliseconds / 1000;
+			ts.tv_nsec += (milliseconds % 1000) * 1000 * 1000;
+			if (ts.tv_nsec >= 1000 * 1000 * 1000)
+			{
+				ts.tv_sec++;
+				ts.tv_nsec -= 1000 * 1000 * 1000;
+			}
+
+			std::lock_guard<Mutex> lock{mutex};
+			while (count == 0)
+			{
+				if (!cond.wait(mutex, ts))
+					return false;
+			}
+			count--;
+			return true;
+#endif
+		}
+
+#if SYNC_USE_FUTEX
+	private:
+		bool park(const struct timespec * deadline)
+		{
+			for (int i = 0; i < detail::futex_spin_count; i++)
+			{
+				if (count.load(std::memory_order_relaxed) != 0 && try_wait())
+					return true;
+
+				fiw_pause();
+			}
+
+			waiters.fetch_add(1, std::memory_order_seq_cst);
+
+			bool acquired = false;
+			while (!(acquired = try_wait()))
+			{
+				struct timespec timeout;
+				if (deadline && !detail::futex_timeout(*deadline, timeout))
+					break;
+
+				detail::futex_wait(count, 0, deadline ? &timeout : nullptr);
+			}
+
+			waiters.fetch_sub(1, std::memory_order_relaxed);
+
+			return acquired;
+		}
+#endif
+	};
+}
+}
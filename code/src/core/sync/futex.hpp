@@ -0,0 +1,81 @@
+#pragma once
+
+#include "config.h"
+
+#if SYNC_USE_FUTEX
+
+#include "utility/compiler.hpp"
+
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <ctime>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace core
+{
+namespace sync
+{
+namespace detail
+{
+	// the number of times the state is checked before going to sleep,
+	// a handoff between two running threads is usually done well within
+	// this
+	constexpr int futex_spin_count = 128;
+
+	// returns when woken, when the timeout runs out, or straight away if
+	// the word does not hold the expected value, callers have to check
+	// their state again in any case
+	inline void futex_wait(std::atomic<uint32_t> & word, uint32_t expected, const struct timespec * timeout)
+	{
+		static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "");
+
+		syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT_PRIVATE, expected, timeout, nullptr, 0);
+	}
+
+	inline void futex_wake(std::atomic<uint32_t> & word, int count)
+	{
+		syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+	}
+
+	// futex timeouts are relative, so waits that may be woken several
+	// times keep track of the absolute time they should give up
+	inline bool futex_deadline(int milliseconds, struct timespec & deadline)
+	{
+		if (clock_gettime(CLOCK_MONOTONIC, &deadline) != 0)
+			return false;
+
+		deadline.tv_sec += milliseconds / 1000;
+		deadline.tv_nsec += (milliseconds % 1000) * 1000 * 1000;
+		if (deadline.tv_nsec >= 1000 * 1000 * 1000)
+		{
+			deadline.tv_sec++;
+			deadline.tv_nsec -= 1000 * 1000 * 1000;
+		}
+		return true;
+	}
+
+	// returns false if the deadline has passed
+	inline bool futex_timeout(const struct timespec & deadline, struct timespec & timeout)
+	{
+		struct timespec now;
+		if (clock_gettime(CLOCK_MONOTONIC, &now) != 0)
+			return false;
+
+		timeout.tv_sec = deadline.tv_sec - now.tv_sec;
+		timeout.tv_nsec = deadline.tv_nsec - now.tv_nsec;
+		if (timeout.tv_nsec < 0)
+		{
+			timeout.tv_sec--;
+			timeout.tv_nsec += 1000 * 1000 * 1000;
+		}
+		return timeout.tv_sec >= 0;
+	}
+}
+}
+}
+
+#endif
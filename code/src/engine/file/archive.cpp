@@ -0,0 +1,177 @@
+#include "engine/file/archive.hpp"
+
+#include "core/debug.hpp"
+
+#include "engine/Hash.hpp"
+
+#include "ful/string_modify.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+	std::uint64_t align_up(std::uint64_t offset, std::uint64_t alignment)
+	{
+		return (offset + (alignment - 1)) & ~(alignment - 1);
+	}
+
+	bool equal(ful::view_utf8 a, ful::view_utf8 b)
+	{
+		return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size()) == 0;
+	}
+
+	bool less(const engine::file::archive_entry & a, const engine::file::archive_entry & b, const char * names)
+	{
+		if (a.hash != b.hash)
+			return a.hash < b.hash;
+
+		// names that share hash are sorted as well, so that packing the
+		// same files always results in the same archive
+		const int cmp = std::memcmp(names + a.name_offset, names + b.name_offset, a.name_size < b.name_size ? a.name_size : b.name_size);
+		return cmp != 0 ? cmp < 0 : a.name_size < b.name_size;
+	}
+}
+
+namespace engine
+{
+	namespace file
+	{
+		bool archive::open(const void * data, ext::usize size)
+		{
+			data_ = nullptr;
+			size_ = 0;
+
+			if (size < sizeof(archive_header))
+				return false;
+
+			archive_header header;
+			std::memcpy(&header, data, sizeof header);
+
+			if (header.magic != archive_magic || header.version != archive_version)
+				return false;
+
+			if (header.alignment == 0 || (header.alignment & (header.alignment - 1)) != 0)
+				return false;
+
+			const std::uint64_t entries_end = sizeof(archive_header) + std::uint64_t(header.entry_count) * sizeof(archive_entry);
+			if (header.names_offset < entries_end || size < header.names_offset || size - header.names_offset < header.names_size)
+				return false;
+
+			const char * const bytes = static_cast<const char *>(data);
+			const archive_entry * const entries = reinterpret_cast<const archive_entry *>(bytes + sizeof(archive_header));
+			for (std::uint32_t i = 0; i < header.entry_count; i++)
+			{
+				const archive_entry & entry = entries[i];
+
+				if (header.names_size < entry.name_offset || header.names_size - entry.name_offset < entry.name_size)
+					return false;
+
+				if (size < entry.offset || size - entry.offset < entry.size || entry.offset % header.alignment != 0)
+					return false;
+
+				if (0 < i && entry.hash < entries[i - 1].hash)
+					return false;
+			}
+
+			data_ = bytes;
+			size_ = size;
+
+			return true;
+		}
+
+		const archive_entry * archive::begin() const
+		{
+			return reinterpret_cast<const archive_entry *>(data_ + sizeof(archive_header));
+		}
+
+		const archive_entry * archive::end() const
+		{
+			return begin() + reinterpret_cast<const archive_header *>(data_)->entry_count;
+		}
+
+		const archive_entry * archive::find(ful::view_utf8 name) const
+		{
+			const std::uint32_t hash = engine::Hash(name);
+
+			const archive_entry * const last = end();
+			for (const archive_entry * it = std::lower_bound(begin(), last, hash, [](const archive_entry & entry, std::uint32_t hash){ return entry.hash < hash; }); it != last && it->hash == hash; ++it)
+			{
+				if (equal(this->name(*it), name))
+					return it;
+			}
+			return nullptr;
+		}
+
+		ful::view_utf8 archive::name(const archive_entry & entry) const
+		{
+			const char * const names = data_ + reinterpret_cast<const archive_header *>(data_)->names_offset;
+			return ful::view_utf8(names + entry.name_offset, entry.name_size);
+		}
+
+		bool archive_builder::add(ful::view_utf8 name, ext::usize size)
+		{
+			archive_entry entry;
+			entry.hash = engine::Hash(name);
+			entry.flags = 0;
+			entry.name_offset = static_cast<std::uint32_t>(names_.size());
+			entry.name_size = static_cast<std::uint32_t>(name.size());
+			entry.offset = 0;
+			entry.size = size;
+
+			if (!debug_verify(ful::append(names_, name.begin(), name.end())))
+				return false;
+
+			return debug_verify(entries_.try_emplace_back(entry));
+		}
+
+		bool archive_builder::finish()
+		{
+			const char * const names = names_.data();
+			std::sort(entries_.begin(), entries_.end(), [names](const archive_entry & a, const archive_entry & b){ return less(a, b, names); });
+
+			for (ext::usize i = 1; i < entries_.size(); i++)
+			{
+				if (!debug_inform(less(entries_[i - 1], entries_[i], names), "\"", name(entries_[i]), "\" has been added more than once"))
+					return false;
+			}
+
+			const std::uint64_t names_offset = sizeof(archive_header) + entries_.size() * sizeof(archive_entry);
+			index_size_ = static_cast<ext::usize>(names_offset + names_.size());
+
+			std::uint64_t offset = index_size_;
+			for (archive_entry & entry : entries_)
+			{
+				entry.offset = align_up(offset, archive_alignment);
+				offset = entry.offset + entry.size;
+			}
+			size_ = static_cast<ext::usize>(offset);
+
+			return true;
+		}
+
+		ful::view_utf8 archive_builder::name(const archive_entry & entry) const
+		{
+			return ful::view_utf8(names_.data() + entry.name_offset, entry.name_size);
+		}
+
+		void archive_builder::write_index(void * buffer) const
+		{
+			archive_header header;
+			header.magic = archive_magic;
+			header.version = archive_version;
+			header.alignment = archive_alignment;
+			header.entry_count = static_cast<std::uint32_t>(entries_.size());
+			header.names_offset = sizeof(archive_header) + entries_.size() * sizeof(archive_entry);
+			header.names_size = names_.size();
+
+			char * const bytes = static_cast<char *>(buffer);
+			std::memcpy(bytes, &header, sizeof header);
+			if (!ext::empty(entries_))
+			{
+				std::memcpy(bytes + sizeof header, entries_.data(), entries_.size() * sizeof(archive_entry));
+				std::memcpy(bytes + header.names_offset, names_.data(), names_.size());
+			}
+		}
+	}
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+#include "utility/container/vector.hpp"
+#include "utility/ext/stddef.hpp"
+
+#include "ful/heap.hpp"
+#include "ful/view.hpp"
+
+#include <cstdint>
+
+namespace engine
+{
+	namespace file
+	{
+		// an archive is a single file holding many, it is laid out as
+		//
+		//   header
+		//   entries, sorted by hash
+		//   names, without terminating nulls
+		//   payloads, each aligned to the alignment in the header
+		//
+		// note the numbers are in the byte order of the machine that
+		// packed the archive, a mismatch is caught by the magic number
+		enum : std::uint32_t
+		{
+			archive_magic = 0x61776966, // "fiwa" in little endian
+			archive_version = 1,
+			archive_alignment = 64,
+		};
+
+		struct archive_header
+		{
+			std::uint32_t magic;
+			std::uint32_t version;
+			std::uint32_t alignment;
+			std::uint32_t entry_count;
+			std::uint64_t names_offset;
+			std::uint64_t names_size;
+		};
+		static_assert(sizeof(archive_header) == 32, "");
+
+		struct archive_entry
+		{
+			std::uint32_t hash; // engine::Hash of the name
+			std::uint32_t flags; // reserved, always zero for now
+			std::uint32_t name_offset; // from the start of the names
+			std::uint32_t name_size;
+			std::uint64_t offset; // from the start of the archive
+			std::uint64_t size;
+		};
+		static_assert(sizeof(archive_entry) == 32, "");
+
+		// a view of an archive in memory
+		class archive
+		{
+		private:
+			const char * data_ = nullptr;
+			ext::usize size_ = 0;
+
+		public:
+			// \return False if the data is not a valid archive.
+			bool open(const void * data, ext::usize size);
+
+			bool valid() const { return data_ != nullptr; }
+
+			const archive_entry * begin() const;
+			const archive_entry * end() const;
+
+			// \return The entry with the given name, or null.
+			const archive_entry * find(ful::view_utf8 name) const;
+
+			ful::view_utf8 name(const archive_entry & entry) const;
+			const void * payload(const archive_entry & entry) const { return data_ + entry.offset; }
+		};
+
+		// lays out the archive of some files, the payloads are to be
+		// written at the offsets of the entries, in any order
+		class archive_builder
+		{
+		private:
+			utility::heap_vector<archive_entry> entries_;
+			ful::heap_string_utf8 names_;
+
+			ext::usize index_size_ = 0;
+			ext::usize size_ = 0;
+
+		public:
+			// note the name is the path relative to the archive, with
+			// forward slashes
+			bool add(ful::view_utf8 name, ext::usize size);
+
+			// \return False if some name has been added more than once.
+			bool finish();
+
+			// the size of the header, the entries, and the names
+			ext::usize index_size() const { return index_size_; }
+			ext::usize size() const { return size_; }
+
+			const archive_entry * begin() const { return entries_.begin(); }
+			const archive_entry * end() const { return entries_.end(); }
+
+			ful::view_utf8 name(const archive_entry & entry) const;
+
+			// \param buffer At least `index_size` bytes.
+			void write_index(void * buffer) const;
+		};
+	}
+}
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "core/native/file.hpp"
 #include "core/serialization.hpp"
 
 namespace engine
@@ -9,11 +10,28 @@ namespace engine
 		struct config_t
 		{
 			ext::usize write_size = static_cast<ext::usize>(1) << 26;
+			// the number of threads doing blocking reads, which are the
+			// files that are mapped, or every read if io_uring is not
+			// available, zero has them done on the task workers instead
+			ext::usize read_threads = 4;
+			// files up to this size are copied into a buffer rather than
+			// mapped into memory, with io_uring if it is available
+			ext::usize small_file_size = core::native::default_small_file_size;
+			// files up to this size are paged in as they are mapped, the
+			// ones bigger than that are better off streamed
+			ext::usize populate_file_size = core::native::default_populate_file_size;
+			// the size of the chunks that files are streamed in, which is
+			// also the most memory a stream will use
+			ext::usize stream_size = static_cast<ext::usize>(1) << 20;
 
 			static constexpr auto serialization()
 			{
 				return utility::make_lookup_table<ful::view_utf8>(
-					std::make_pair(ful::cstr_utf8("write_size"), &config_t::write_size)
+					std::make_pair(ful::cstr_utf8("write_size"), &config_t::write_size),
+					std::make_pair(ful::cstr_utf8("read_threads"), &config_t::read_threads),
+					std::make_pair(ful::cstr_utf8("small_file_size"), &config_t::small_file_size),
+					std::make_pair(ful::cstr_utf8("populate_file_size"), &config_t::populate_file_size),
+					std::make_pair(ful::cstr_utf8("stream_size"), &config_t::stream_size)
 					);
 			}
 		};
@@ -52,7 +52,7 @@ namespace
 		engine::Asset name;
 		engine::file::ready_callback * readycall;
 		engine::file::unready_callback * unreadycall;
-		utility::any data;
+		engine::task::any data;
 	};
 
 	struct FileCallData
@@ -60,7 +60,7 @@ namespace
 		engine::file::loader_impl & impl;
 		utility::heap_vector<engine::Token, RelationCallback> calls;
 		Filetype filetype;
-		utility::any stash;
+		engine::task::any stash;
 
 		bool ready;
 
@@ -73,7 +73,7 @@ namespace
 
 	struct FileCallDataPlusOne
 	{
-		ext::heap_shared_ptr<FileCallData> call_ptr;
+		ext::pool_shared_ptr<FileCallData> call_ptr;
 
 		engine::Token tag;
 		RelationCallback callback;
@@ -83,9 +83,9 @@ namespace
 	{
 		engine::file::loader_impl * impl; // todo can this be removed?
 		engine::Asset file;
-		ext::heap_weak_ptr<FileCallData> file_callback;
+		ext::pool_weak_ptr<FileCallData> file_callback;
 
-		static void file_load(engine::file::system & filesystem, core::content & content, utility::any & data);
+		static void file_load(engine::file::system & filesystem, core::content & content, engine::task::any & data);
 	};
 
 	constexpr auto global = engine::Hash{};
@@ -108,7 +108,7 @@ namespace
 		engine::Hash filetype;
 		engine::file::ready_callback * readycall;
 		engine::file::unready_callback * unreadycall;
-		utility::any data;
+		engine::task::any data;
 	};
 
 	struct MessageLoadDependency
@@ -118,7 +118,7 @@ namespace
 		engine::Hash filetype;
 		engine::file::ready_callback * readycall;
 		engine::file::unready_callback * unreadycall;
-		utility::any data;
+		engine::task::any data;
 	};
 
 	struct MessageLoadDone
@@ -227,7 +227,7 @@ namespace
 
 namespace
 {
-	using FileCallPtr = ext::heap_shared_ptr<FileCallData>;
+	using FileCallPtr = ext::pool_shared_ptr<FileCallData>;
 
 	core::container::Collection
 	<
@@ -415,7 +415,7 @@ namespace
 		engine::task::post_work(
 			*impl.taskscheduler,
 			file,
-			[](engine::task::scheduler & /*scheduler*/, engine::Hash strand_, utility::any && data)
+			[](engine::task::scheduler & /*scheduler*/, engine::Hash strand_, engine::task::any && data)
 		{
 			// note strand is the underlying file
 			if (debug_assert(data.type_id() == utility::type_id<FileCallPtr>()))
@@ -435,7 +435,7 @@ namespace
 				loader.detach();
 			}
 		},
-			utility::any(loaded_file->call_ptr));
+			engine::task::any(loaded_file->call_ptr));
 
 		return true;
 	}
@@ -474,7 +474,7 @@ namespace
 				engine::task::post_work(
 					*impl.taskscheduler,
 					relation.second,
-					[](engine::task::scheduler & /*scheduler*/, engine::Hash strand_, utility::any && data)
+					[](engine::task::scheduler & /*scheduler*/, engine::Hash strand_, engine::task::any && data)
 				{
 					// note strand is the underlying file
 					if (debug_assert(data.type_id() == (utility::type_id<std::pair<FileCallPtr, engine::Asset>>())))
@@ -496,7 +496,7 @@ namespace
 						call_data.calls.erase(call_it);
 					}
 				},
-					utility::any(std::make_pair(x.call_ptr, relation.first)));
+					engine::task::any(std::make_pair(x.call_ptr, relation.first)));
 
 				x.owners.erase(owner_it);
 
@@ -510,7 +510,7 @@ namespace
 					engine::task::post_work(
 						*impl.taskscheduler,
 						relation.second,
-						[](engine::task::scheduler & /*scheduler*/, engine::Hash strand_, utility::any && data)
+						[](engine::task::scheduler & /*scheduler*/, engine::Hash strand_, engine::task::any && data)
 					{
 						// note strand is the underlying file
 						if (debug_assert(data.type_id() == utility::type_id<FileCallPtr>()))
@@ -540,7 +540,7 @@ namespace
 							loader.detach();
 						}
 					},
-						utility::any(x.call_ptr));
+						engine::task::any(x.call_ptr));
 
 					if (debug_verify(relations.try_reserve(relations.size() + x.attachments.size())))
 					{
@@ -566,7 +566,7 @@ namespace
 				engine::task::post_work(
 					*impl.taskscheduler,
 					relation.second,
-					[](engine::task::scheduler & /*scheduler*/, engine::Hash strand_, utility::any && data)
+					[](engine::task::scheduler & /*scheduler*/, engine::Hash strand_, engine::task::any && data)
 				{
 					// note strand is the underlying file
 					if (debug_assert(data.type_id() == (utility::type_id<std::pair<FileCallPtr, engine::Asset>>())))
@@ -588,7 +588,7 @@ namespace
 						call_data.calls.erase(call_it);
 					}
 				},
-					utility::any(std::make_pair(x.call_ptr, relation.first)));
+					engine::task::any(std::make_pair(x.call_ptr, relation.first)));
 
 				x.owners.erase(owner_it);
 
@@ -602,7 +602,7 @@ namespace
 					engine::task::post_work(
 						*impl.taskscheduler,
 						relation.second,
-						[](engine::task::scheduler & /*scheduler*/, engine::Hash strand_, utility::any && data)
+						[](engine::task::scheduler & /*scheduler*/, engine::Hash strand_, engine::task::any && data)
 					{
 						// note strand is the underlying file
 						if (debug_assert(data.type_id() == utility::type_id<FileCallPtr>()))
@@ -632,7 +632,7 @@ namespace
 							loader.detach();
 						}
 					},
-						utility::any(x.call_ptr));
+						engine::task::any(x.call_ptr));
 
 					if (debug_verify(relations.try_reserve(relations.size() + x.attachments.size())))
 					{
@@ -662,7 +662,7 @@ namespace
 		engine::Hash filetype,
 		engine::file::ready_callback * readycall,
 		engine::file::unready_callback * unreadycall,
-		utility::any && data)
+		engine::task::any && data)
 	{
 		if (name != file)
 		{
@@ -712,7 +712,7 @@ namespace
 		const auto mode = engine::file::flags{};
 #endif
 		const engine::Token id = make_token(loading_load->directory, engine::Asset(loading_load->filepath));
-		engine::file::read(*impl.filesystem, id, loading_load->directory, std::move(loading_load_filepath), file, ReadData::file_load, utility::any(utility::in_place_type<ReadData>, &impl, file, ext::heap_weak_ptr<FileCallData>(loading_load->call_ptr)), mode);
+		engine::file::read(*impl.filesystem, id, loading_load->directory, std::move(loading_load_filepath), file, ReadData::file_load, engine::task::any(utility::in_place_type<ReadData>, &impl, file, ext::pool_weak_ptr<FileCallData>(loading_load->call_ptr)), mode);
 
 		return true;
 	}
@@ -727,7 +727,7 @@ namespace
 		engine::Hash filetype,
 		engine::file::ready_callback * readycall,
 		engine::file::unready_callback * unreadycall,
-		utility::any && data)
+		engine::task::any && data)
 	{
 		fiw_unused(filetype);
 		return loads.call(file_it, ext::overload(
@@ -743,7 +743,7 @@ namespace
 			engine::task::post_work(
 				*impl.taskscheduler,
 				file,
-				[](engine::task::scheduler & /*scheduler*/, engine::Hash strand_, utility::any && data)
+				[](engine::task::scheduler & /*scheduler*/, engine::Hash strand_, engine::task::any && data)
 			{
 				// note strand is the underlying file
 				if (debug_assert(data.type_id() == utility::type_id<FileCallDataPlusOne>()))
@@ -764,7 +764,7 @@ namespace
 					}
 				}
 			},
-				utility::any(utility::in_place_type<FileCallDataPlusOne>, y.call_ptr, tag, RelationCallback{name, readycall, unreadycall, std::move(data)}));
+				engine::task::any(utility::in_place_type<FileCallDataPlusOne>, y.call_ptr, tag, RelationCallback{name, readycall, unreadycall, std::move(data)}));
 
 			return true;
 		},
@@ -779,7 +779,7 @@ namespace
 			engine::task::post_work(
 				*impl.taskscheduler,
 				file,
-				[](engine::task::scheduler & /*scheduler*/, engine::Hash strand_, utility::any && data)
+				[](engine::task::scheduler & /*scheduler*/, engine::Hash strand_, engine::task::any && data)
 			{
 				// note strand is the underlying file
 				if (debug_assert(data.type_id() == utility::type_id<FileCallDataPlusOne>()))
@@ -800,7 +800,7 @@ namespace
 					}
 				}
 			},
-				utility::any(utility::in_place_type<FileCallDataPlusOne>, y.call_ptr, tag, RelationCallback{name, readycall, unreadycall, std::move(data)}));
+				engine::task::any(utility::in_place_type<FileCallDataPlusOne>, y.call_ptr, tag, RelationCallback{name, readycall, unreadycall, std::move(data)}));
 
 			return true;
 		}));
@@ -823,7 +823,7 @@ namespace
 			engine::task::post_work(
 				*impl.taskscheduler,
 				file,
-				[](engine::task::scheduler & /*scheduler*/, engine::Hash strand_, utility::any && data)
+				[](engine::task::scheduler & /*scheduler*/, engine::Hash strand_, engine::task::any && data)
 			{
 				// note strand is the underlying file
 				if (debug_assert(data.type_id() == (utility::type_id<std::pair<FileCallPtr, engine::Token>>())))
@@ -845,7 +845,7 @@ namespace
 					call_data.calls.erase(call_it);
 				}
 			},
-				utility::any(std::make_pair(y.call_ptr, tag)));
+				engine::task::any(std::make_pair(y.call_ptr, tag)));
 
 			y.owners.erase(owner_it);
 
@@ -862,7 +862,7 @@ namespace
 					engine::task::post_work(
 						*impl.taskscheduler,
 						file,
-						[](engine::task::scheduler & /*scheduler*/, engine::Hash strand_, utility::any && data)
+						[](engine::task::scheduler & /*scheduler*/, engine::Hash strand_, engine::task::any && data)
 					{
 						// note strand is the underlying file
 						if (debug_assert(data.type_id() == utility::type_id<FileCallPtr>()))
@@ -892,7 +892,7 @@ namespace
 							loader.detach();
 						}
 					},
-						utility::any(y.call_ptr));
+						engine::task::any(y.call_ptr));
 				}
 
 				utility::heap_vector<engine::Asset, engine::Asset> relations;
@@ -923,7 +923,7 @@ namespace
 			engine::task::post_work(
 				*impl.taskscheduler,
 				file,
-				[](engine::task::scheduler & /*scheduler*/, engine::Hash strand_, utility::any && data)
+				[](engine::task::scheduler & /*scheduler*/, engine::Hash strand_, engine::task::any && data)
 			{
 				// note strand is the underlying file
 				if (debug_assert(data.type_id() == (utility::type_id<std::pair<FileCallPtr, engine::Token>>())))
@@ -945,7 +945,7 @@ namespace
 					call_data.calls.erase(call_it);
 				}
 			},
-				utility::any(std::make_pair(y.call_ptr, tag)));
+				engine::task::any(std::make_pair(y.call_ptr, tag)));
 
 			y.owners.erase(owner_it);
 
@@ -959,7 +959,7 @@ namespace
 				engine::task::post_work(
 					*impl.taskscheduler,
 					file,
-					[](engine::task::scheduler & /*scheduler*/, engine::Hash strand_, utility::any && data)
+					[](engine::task::scheduler & /*scheduler*/, engine::Hash strand_, engine::task::any && data)
 				{
 					// note strand is the underlying file
 					if (debug_assert(data.type_id() == utility::type_id<FileCallPtr>()))
@@ -987,7 +987,7 @@ namespace
 						loader.detach();
 					}
 				},
-					utility::any(y.call_ptr));
+					engine::task::any(y.call_ptr));
 
 				utility::heap_vector<engine::Asset, engine::Asset> relations;
 				if (debug_verify(relations.try_reserve(y.attachments.size())))
@@ -1613,7 +1613,7 @@ namespace
 		visit(ProcessMessage{impl}, std::move(message));
 	}
 
-	void loader_update(engine::task::scheduler & /*taskscheduler*/, engine::Hash /*strand*/, utility::any && data)
+	void loader_update(engine::task::scheduler & /*taskscheduler*/, engine::Hash /*strand*/, engine::task::any && data)
 	{
 		if (!debug_assert(data.type_id() == utility::type_id<Task>()))
 			return;
@@ -1668,30 +1668,30 @@ namespace
 
 namespace
 {
-	void file_scan(engine::file::system & /*filesystem*/, engine::Hash directory, ful::heap_string_utf8 && existing_files, ful::heap_string_utf8 && removed_files, utility::any & data)
+	void file_scan(engine::file::system & /*filesystem*/, engine::Hash directory, ful::heap_string_utf8 && existing_files, ful::heap_string_utf8 && removed_files, engine::task::any & data)
 	{
 		if (!debug_assert(data.type_id() == utility::type_id<engine::file::loader *>()))
 			return;
 
 		engine::file::loader & loader = *utility::any_cast<engine::file::loader *>(std::move(data));
 
-		loader_update(*loader->taskscheduler, strand, utility::any(utility::in_place_type<Task>, *loader, utility::in_place_type<MessageFileScan>, directory, std::move(existing_files), std::move(removed_files)));
+		loader_update(*loader->taskscheduler, strand, engine::task::any(utility::in_place_type<Task>, *loader, utility::in_place_type<MessageFileScan>, directory, std::move(existing_files), std::move(removed_files)));
 	}
 
-	void ReadData::file_load(engine::file::system & /*filesystem*/, core::content & content, utility::any & data)
+	void ReadData::file_load(engine::file::system & /*filesystem*/, core::content & content, engine::task::any & data)
 	{
 		ReadData * const read_data = utility::any_cast<ReadData>(&data);
 		if (!debug_assert(read_data))
 			return;
 
-		ext::heap_shared_ptr<FileCallData> filecall_ptr = read_data->file_callback.lock();
+		ext::pool_shared_ptr<FileCallData> filecall_ptr = read_data->file_callback.lock();
 		if (!debug_verify(filecall_ptr))
 			return;
 
 		engine::file::loader loader(filecall_ptr->impl);
 		if (filecall_ptr->ready)
 		{
-			engine::task::post_work(*read_data->impl->taskscheduler, strand, loader_update, utility::any(utility::in_place_type<Task>, *read_data->impl, utility::in_place_type<MessageLoadInit>, read_data->file));
+			engine::task::post_work(*read_data->impl->taskscheduler, strand, loader_update, engine::task::any(utility::in_place_type<Task>, *read_data->impl, utility::in_place_type<MessageLoadInit>, read_data->file));
 
 			for (auto && call : filecall_ptr->calls)
 			{
@@ -1702,7 +1702,7 @@ namespace
 		filecall_ptr->filetype.loadcall(loader, content, filecall_ptr->stash, read_data->file);
 		loader.detach();
 
-		engine::task::post_work(*read_data->impl->taskscheduler, strand, loader_update, utility::any(utility::in_place_type<Task>, *read_data->impl, utility::in_place_type<MessageLoadDone>, read_data->file));
+		engine::task::post_work(*read_data->impl->taskscheduler, strand, loader_update, engine::task::any(utility::in_place_type<Task>, *read_data->impl, utility::in_place_type<MessageLoadDone>, read_data->file));
 	}
 }
 
@@ -1717,7 +1717,7 @@ namespace engine
 			engine::task::post_work(
 				*impl.taskscheduler,
 				strand,
-				[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, utility::any && data)
+				[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, engine::task::any && data)
 			{
 				if (!debug_assert(data.type_id() == utility::type_id<core::sync::Event<true> *>()))
 					return;
@@ -1728,7 +1728,7 @@ namespace engine
 				core::sync::Event<true> * barrier = utility::any_cast<core::sync::Event<true> *>(data);
 				barrier->set();
 			},
-				utility::any(&barrier));
+				engine::task::any(&barrier));
 
 			barrier.wait();
 
@@ -1748,7 +1748,7 @@ namespace engine
 
 		void register_library(loader & loader, engine::Hash directory)
 		{
-			engine::task::post_work(*loader->taskscheduler, strand, loader_update, utility::any(utility::in_place_type<Task>, *loader, utility::in_place_type<MessageRegisterLibrary>, directory));
+			engine::task::post_work(*loader->taskscheduler, strand, loader_update, engine::task::any(utility::in_place_type<Task>, *loader, utility::in_place_type<MessageRegisterLibrary>, directory));
 
 #if defined(_DEBUG) || !defined(NDEBUG)
 			const auto mode = engine::file::flags::RECURSE_DIRECTORIES | engine::file::flags::ADD_WATCH;
@@ -1756,7 +1756,7 @@ namespace engine
 			const auto mode = engine::file::flags::RECURSE_DIRECTORIES;
 #endif
 			const auto id = directory;
-			engine::file::scan(*loader->filesystem, engine::Token(id), directory, strand, file_scan, utility::any(&loader), mode);
+			engine::file::scan(*loader->filesystem, engine::Token(id), directory, strand, file_scan, engine::task::any(&loader), mode);
 		}
 
 		void unregister_library(loader & loader, engine::Hash directory)
@@ -1766,17 +1766,17 @@ namespace engine
 			engine::file::remove_watch(*loader->filesystem, engine::Token(id));
 #endif
 
-			engine::task::post_work(*loader->taskscheduler, strand, loader_update, utility::any(utility::in_place_type<Task>, *loader, utility::in_place_type<MessageUnregisterLibrary>, directory));
+			engine::task::post_work(*loader->taskscheduler, strand, loader_update, engine::task::any(utility::in_place_type<Task>, *loader, utility::in_place_type<MessageUnregisterLibrary>, directory));
 		}
 
 		void register_filetype(loader & loader, engine::Hash filetype, load_callback * loadcall, unload_callback * unloadcall)
 		{
-			engine::task::post_work(*loader->taskscheduler, strand, loader_update, utility::any(utility::in_place_type<Task>, *loader, utility::in_place_type<MessageRegisterFiletype>, filetype, loadcall, unloadcall));
+			engine::task::post_work(*loader->taskscheduler, strand, loader_update, engine::task::any(utility::in_place_type<Task>, *loader, utility::in_place_type<MessageRegisterFiletype>, filetype, loadcall, unloadcall));
 		}
 
 		void unregister_filetype(loader & loader, engine::Hash filetype)
 		{
-			engine::task::post_work(*loader->taskscheduler, strand, loader_update, utility::any(utility::in_place_type<Task>, *loader, utility::in_place_type<MessageUnregisterFiletype>, filetype));
+			engine::task::post_work(*loader->taskscheduler, strand, loader_update, engine::task::any(utility::in_place_type<Task>, *loader, utility::in_place_type<MessageUnregisterFiletype>, filetype));
 		}
 
 		void load_independent(
@@ -1786,9 +1786,9 @@ namespace engine
 			engine::Hash filetype,
 			ready_callback * readycall,
 			unready_callback * unreadycall,
-			utility::any && data)
+			engine::task::any && data)
 		{
-			engine::task::post_work(*loader->taskscheduler, strand, loader_update, utility::any(utility::in_place_type<Task>, *loader, utility::in_place_type<MessageLoadIndependent>, tag, name, filetype, readycall, unreadycall, std::move(data)));
+			engine::task::post_work(*loader->taskscheduler, strand, loader_update, engine::task::any(utility::in_place_type<Task>, *loader, utility::in_place_type<MessageLoadIndependent>, tag, name, filetype, readycall, unreadycall, std::move(data)));
 		}
 
 		void load_dependency(
@@ -1798,16 +1798,16 @@ namespace engine
 			engine::Hash filetype,
 			ready_callback * readycall,
 			unready_callback * unreadycall,
-			utility::any && data)
+			engine::task::any && data)
 		{
-			engine::task::post_work(*loader->taskscheduler, strand, loader_update, utility::any(utility::in_place_type<Task>, *loader, utility::in_place_type<MessageLoadDependency>, owner, name, filetype, readycall, unreadycall, std::move(data)));
+			engine::task::post_work(*loader->taskscheduler, strand, loader_update, engine::task::any(utility::in_place_type<Task>, *loader, utility::in_place_type<MessageLoadDependency>, owner, name, filetype, readycall, unreadycall, std::move(data)));
 		}
 
 		void unload_independent(
 			loader & loader,
 			engine::Token tag)
 		{
-			engine::task::post_work(*loader->taskscheduler, strand, loader_update, utility::any(utility::in_place_type<Task>, *loader, utility::in_place_type<MessageUnloadIndependent>, tag));
+			engine::task::post_work(*loader->taskscheduler, strand, loader_update, engine::task::any(utility::in_place_type<Task>, *loader, utility::in_place_type<MessageUnloadIndependent>, tag));
 		}
 	}
 }
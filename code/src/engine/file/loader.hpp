@@ -2,6 +2,7 @@
 
 #include "engine/Asset.hpp"
 #include "engine/module.hpp"
+#include "engine/task/any.hpp"
 #include "engine/Token.hpp"
 
 namespace core
@@ -17,11 +18,6 @@ namespace engine
 	}
 }
 
-namespace utility
-{
-	class any;
-}
-
 namespace engine
 {
 	namespace file
@@ -40,11 +36,11 @@ namespace engine
 		using load_callback = void(
 			loader & loader,
 			core::content & content,
-			utility::any & stash,
+			engine::task::any & stash,
 			engine::Asset file);
 		using unload_callback = void(
 			loader & loader,
-			utility::any & stash,
+			engine::task::any & stash,
 			engine::Asset file);
 
 		void register_library(loader & loader, engine::Hash directory);
@@ -55,15 +51,15 @@ namespace engine
 
 		using ready_callback = void(
 			loader & loader,
-			utility::any & data,
+			engine::task::any & data,
 			engine::Asset name,
-			const utility::any & stash,
+			const engine::task::any & stash,
 			engine::Asset file);
 		using unready_callback = void(
 			loader & loader,
-			utility::any & data,
+			engine::task::any & data,
 			engine::Asset name,
-			const utility::any & stash,
+			const engine::task::any & stash,
 			engine::Asset file);
 
 		void load_independent(
@@ -73,7 +69,7 @@ namespace engine
 			engine::Hash filetype,
 			ready_callback * readycall,
 			unready_callback * unreadycall,
-			utility::any && data);
+			engine::task::any && data);
 
 		void load_dependency(
 			loader & loader,
@@ -82,7 +78,7 @@ namespace engine
 			engine::Hash filetype,
 			ready_callback * readycall,
 			unready_callback * unreadycall,
-			utility::any && data);
+			engine::task::any && data);
 
 		void unload_independent(
 			loader & loader,
@@ -4,14 +4,10 @@
 #include "engine/Token.hpp"
 #include "engine/file/system/callbacks.hpp"
 #include "engine/module.hpp"
+#include "engine/task/any.hpp"
 
 #include "ful/heap.hpp"
 
-namespace utility
-{
-	class any;
-}
-
 namespace engine
 {
 	namespace task
@@ -92,9 +88,16 @@ namespace engine
 
 		void register_directory(system & system, engine::Hash name, ful::heap_string_utf8 && filepath, engine::Hash parent);
 		void register_temporary_directory(system & system, engine::Hash name);
+		// the files packed into the archive are read as if the archive
+		// was a directory, it cannot be written to and is never watched
+		void register_archive(system & system, engine::Hash name, ful::heap_string_utf8 && filepath, engine::Hash parent);
+		// unregisters archives as well
 		void unregister_directory(system & system, engine::Hash name);
 
 		// mode ADD_WATCH | RECURSE_DIRECTORIES | REPORT_MISSING
+		//
+		// the reads on a strand, including the ones a watch makes when
+		// the file changes, are called back in the order they were made
 		void read(
 			system & system,
 			engine::Token id,
@@ -102,13 +105,41 @@ namespace engine
 			ful::heap_string_utf8 && filepath,
 			engine::Hash strand,
 			read_callback * callback,
-			utility::any && data,
+			engine::task::any && data,
 			flags mode = flags{});
 
 		void remove_watch(
 			system & system,
 			engine::Token id);
 
+		// the number of files that have been read in each way
+		struct read_statistics
+		{
+			// copied into a buffer, see config_t::small_file_size
+			ext::usize buffered = 0;
+			// mapped and paged in at once, see config_t::populate_file_size
+			ext::usize populated = 0;
+			// mapped and paged in on demand
+			ext::usize mapped = 0;
+			// copied into a buffer through io_uring, which takes the
+			// place of buffered when it is available
+			ext::usize ring = 0;
+			// found in an archive, see register_archive
+			ext::usize archived = 0;
+		};
+
+		read_statistics get_read_statistics(system & system);
+
+		// reads the file in chunks of config_t::stream_size rather than
+		// all at once, for files that are too big to keep in memory
+		void stream(
+			system & system,
+			engine::Hash directory,
+			ful::heap_string_utf8 && filepath,
+			engine::Hash strand,
+			stream_callback * callback,
+			engine::task::any && data);
+
 		// mode IGNORE_EXISTING | ADD_WATCH | RECURSE_DIRECTORIES
 		void scan(
 			system & system,
@@ -116,7 +147,7 @@ namespace engine
 			engine::Hash directory,
 			engine::Hash strand,
 			scan_callback * callback,
-			utility::any && data,
+			engine::task::any && data,
 			flags mode = flags{});
 
 		// mode OVERWRITE_EXISTING | APPEND_EXISTING | CREATE_DIRECTORIES
@@ -126,7 +157,7 @@ namespace engine
 			ful::heap_string_utf8 && filepath,
 			engine::Hash strand,
 			write_callback * callback,
-			utility::any && data,
+			engine::task::any && data,
 			flags mode = flags{});
 	}
 }
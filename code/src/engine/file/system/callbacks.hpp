@@ -1,6 +1,7 @@
 #pragma once
 
 #include "engine/Hash.hpp"
+#include "engine/task/any.hpp"
 
 #include "ful/heapfwd.hpp"
 
@@ -9,11 +10,6 @@ namespace core
 	class content;
 }
 
-namespace utility
-{
-	class any;
-}
-
 namespace engine
 {
 	namespace file
@@ -23,18 +19,31 @@ namespace engine
 		using read_callback = void(
 			engine::file::system & filesystem,
 			core::content & content,
-			utility::any & data);
+			engine::task::any & data);
+
+		// called for every chunk of the file in order, the chunk is only
+		// valid during the call, returning false stops the stream
+		//
+		// a file that cannot be read gets a single empty chunk, and one
+		// that cannot be read to the end gets an empty chunk after the
+		// chunks that were read, both with a file size of zero
+		using stream_callback = bool(
+			engine::file::system & filesystem,
+			core::content & chunk,
+			ext::usize offset, // of the chunk in the file
+			ext::usize file_size,
+			engine::task::any & data);
 
 		using scan_callback = void(
 			engine::file::system & filesystem,
 			engine::Hash directory,
 			ful::heap_string_utf8 && existing_files, // multiple files separated by ;
 			ful::heap_string_utf8 && removed_files, // multiple files separated by ;
-			utility::any & data);
+			engine::task::any & data);
 
 		using write_callback = ext::ssize(
 			engine::file::system & filesystem,
 			core::content & content,
-			utility::any && data);
+			engine::task::any && data);
 	}
 }
@@ -0,0 +1,208 @@
+#include "config.h"
+
+#if FILE_SYSTEM_USE_IO_URING
+
+#include "core/debug.hpp"
+
+#include "engine/file/system/uring.hpp"
+
+#include <cstring>
+
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace
+{
+	int io_uring_setup(unsigned entries, io_uring_params * params)
+	{
+		return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+	}
+
+	int io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags)
+	{
+		return static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+	}
+
+	int io_uring_register(int fd, unsigned opcode, void * arg, unsigned nr_args)
+	{
+		return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+	}
+
+	bool supports_file_operations(int fd)
+	{
+		constexpr unsigned op_count = 256;
+		alignas(io_uring_probe) char buffer[sizeof(io_uring_probe) + op_count * sizeof(io_uring_probe_op)] = {};
+		io_uring_probe * const probe = reinterpret_cast<io_uring_probe *>(buffer);
+
+		// note probing was added in 5.6, as were the operations below
+		if (io_uring_register(fd, IORING_REGISTER_PROBE, probe, op_count) != 0)
+			return false;
+
+		for (const unsigned op : {IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_CLOSE})
+		{
+			if (probe->last_op < op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED))
+				return false;
+		}
+		return true;
+	}
+}
+
+namespace engine
+{
+	namespace file
+	{
+		uring::~uring()
+		{
+			release();
+		}
+
+		void uring::release()
+		{
+			if (sqes_)
+			{
+				debug_verify(::munmap(sqes_, sq_entries_ * sizeof(io_uring_sqe)) == 0, "failed with errno ", errno);
+			}
+			if (cq_ring_ && cq_ring_ != sq_ring_)
+			{
+				debug_verify(::munmap(cq_ring_, cq_ring_size_) == 0, "failed with errno ", errno);
+			}
+			if (sq_ring_)
+			{
+				debug_verify(::munmap(sq_ring_, sq_ring_size_) == 0, "failed with errno ", errno);
+			}
+			if (fd_ != -1)
+			{
+				debug_verify(::close(fd_) == 0, "failed with errno ", errno);
+			}
+
+			fd_ = -1;
+			sq_ring_ = nullptr;
+			cq_ring_ = nullptr;
+			sqes_ = nullptr;
+			sq_entries_ = 0;
+		}
+
+		bool uring::init(unsigned entries)
+		{
+			if (!debug_assert(fd_ == -1))
+				return false;
+
+			io_uring_params params;
+			std::memset(&params, 0, sizeof params);
+
+			const int fd = io_uring_setup(entries, &params);
+			if (fd == -1)
+			{
+				debug_printline("io_uring_setup failed with errno ", errno, ", falling back to blocking reads");
+				return false;
+			}
+			fd_ = fd;
+
+			if (!supports_file_operations(fd))
+			{
+				debug_printline("io_uring lacks file operations, falling back to blocking reads");
+				release();
+				return false;
+			}
+
+			sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+			cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+			const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+			if (single_mmap && sq_ring_size_ < cq_ring_size_)
+			{
+				sq_ring_size_ = cq_ring_size_;
+			}
+
+			void * const sq_ring = ::mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+			if (!debug_verify(sq_ring != MAP_FAILED, "failed with errno ", errno))
+			{
+				release();
+				return false;
+			}
+			sq_ring_ = sq_ring;
+
+			void * const cq_ring = single_mmap ? sq_ring : ::mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+			if (!debug_verify(cq_ring != MAP_FAILED, "failed with errno ", errno))
+			{
+				release();
+				return false;
+			}
+			cq_ring_ = cq_ring;
+
+			void * const sqes = ::mmap(nullptr, params.sq_entries * sizeof(io_uring_sqe), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+			if (!debug_verify(sqes != MAP_FAILED, "failed with errno ", errno))
+			{
+				release();
+				return false;
+			}
+			sqes_ = static_cast<io_uring_sqe *>(sqes);
+			sq_entries_ = params.sq_entries;
+
+			char * const sq = static_cast<char *>(sq_ring);
+			sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+			sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+			sq_mask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+
+			char * const cq = static_cast<char *>(cq_ring);
+			cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+			cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+			cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+			cq_mask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+
+			sq_local_tail_ = *sq_tail_;
+
+			return true;
+		}
+
+		io_uring_sqe * uring::get_sqe()
+		{
+			if (full())
+				return nullptr;
+
+			const unsigned index = sq_local_tail_ & sq_mask_;
+			sq_array_[index] = index;
+			sq_local_tail_++;
+
+			unsubmitted_++;
+			in_flight_++;
+
+			io_uring_sqe * const sqe = sqes_ + index;
+			std::memset(sqe, 0, sizeof *sqe);
+			return sqe;
+		}
+
+		bool uring::submit()
+		{
+			if (unsubmitted_ == 0)
+				return true;
+
+			__atomic_store_n(sq_tail_, sq_local_tail_, __ATOMIC_RELEASE);
+
+			const int n = io_uring_enter(fd_, unsubmitted_, 0, 0);
+			if (n < 0)
+				return debug_verify(errno == EINTR || errno == EAGAIN || errno == EBUSY, "io_uring_enter failed with errno ", errno);
+
+			// whatever the kernel did not take is still in the ring, and
+			// is submitted next time around
+			unsubmitted_ -= static_cast<unsigned>(n);
+			return true;
+		}
+
+		bool uring::wait()
+		{
+			__atomic_store_n(sq_tail_, sq_local_tail_, __ATOMIC_RELEASE);
+
+			const int n = io_uring_enter(fd_, unsubmitted_, 1, IORING_ENTER_GETEVENTS);
+			if (n < 0)
+				return debug_verify(errno == EINTR || errno == EAGAIN || errno == EBUSY, "io_uring_enter failed with errno ", errno);
+
+			unsubmitted_ -= static_cast<unsigned>(n);
+			return true;
+		}
+	}
+}
+
+#endif
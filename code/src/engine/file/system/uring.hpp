@@ -0,0 +1,105 @@
+#pragma once
+
+#include "config.h"
+
+#if FILE_SYSTEM_USE_IO_URING
+
+#include "utility/ext/stddef.hpp"
+
+#include <linux/io_uring.h>
+
+namespace engine
+{
+	namespace file
+	{
+		// a bare io_uring, owned by a single thread
+		//
+		// the number of operations in flight is limited to the number of
+		// submission entries, which keeps the completion queue (twice as
+		// big) from ever overflowing
+		class uring
+		{
+		private:
+			int fd_ = -1;
+
+			void * sq_ring_ = nullptr;
+			ext::usize sq_ring_size_ = 0;
+			void * cq_ring_ = nullptr;
+			ext::usize cq_ring_size_ = 0;
+			io_uring_sqe * sqes_ = nullptr;
+
+			unsigned * sq_tail_;
+			unsigned * sq_array_;
+			unsigned sq_mask_;
+			unsigned sq_entries_ = 0;
+
+			unsigned * cq_head_;
+			unsigned * cq_tail_;
+			io_uring_cqe * cqes_;
+			unsigned cq_mask_;
+
+			// entries prepared but not yet handed to the kernel
+			unsigned sq_local_tail_ = 0;
+			unsigned unsubmitted_ = 0;
+			// entries prepared or submitted that have not completed
+			unsigned in_flight_ = 0;
+
+		public:
+			~uring();
+			uring() = default;
+			uring(const uring &) = delete;
+			uring & operator = (const uring &) = delete;
+
+		public:
+			// fails if io_uring is not supported by the kernel, or lacks
+			// any of the operations needed for reading files
+			bool init(unsigned entries);
+
+			bool valid() const { return fd_ != -1; }
+
+			// the ring can be polled for completions
+			int fd() const { return fd_; }
+
+			unsigned in_flight() const { return in_flight_; }
+			unsigned unsubmitted() const { return unsubmitted_; }
+			bool full() const { return in_flight_ >= sq_entries_; }
+
+			// \return A cleared submission entry, or null if there are
+			//         already as many operations in flight as the ring
+			//         can take.
+			io_uring_sqe * get_sqe();
+
+			// hands every prepared entry to the kernel in a single call
+			bool submit();
+			// submits and blocks until at least one operation completes
+			bool wait();
+
+			template <typename F>
+			void for_each_completion(F && f)
+			{
+				unsigned head = *cq_head_;
+				while (true)
+				{
+					const unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+					if (head == tail)
+						break;
+
+					const io_uring_cqe & cqe = cqes_[head & cq_mask_];
+					const __u64 user_data = cqe.user_data;
+					const __s32 res = cqe.res;
+
+					head++;
+					__atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+					in_flight_--;
+
+					f(user_data, res);
+				}
+			}
+
+		private:
+			void release();
+		};
+	}
+}
+
+#endif
@@ -34,13 +34,29 @@ namespace engine
 
 			engine::Hash strand;
 			engine::file::read_callback * callback;
-			utility::any data;
+			engine::task::any data;
 
 #if FILE_SYSTEM_USE_KERNEL32
 			FILETIME last_write_time;
 #endif
 		};
 
+		struct StreamData
+		{
+			engine::file::system_impl & impl;
+
+#if FILE_SYSTEM_USE_KERNEL32
+			ful::heap_string_utfw filepath;
+#elif FILE_SYSTEM_USE_POSIX
+			ful::heap_string_utf8 filepath;
+#endif
+			std::uint32_t root;
+
+			engine::Hash strand;
+			engine::file::stream_callback * callback;
+			engine::task::any data;
+		};
+
 		struct ScanData
 		{
 			engine::file::system_impl & impl;
@@ -54,7 +70,7 @@ namespace engine
 
 			engine::Hash strand;
 			engine::file::scan_callback * callback;
-			utility::any data;
+			engine::task::any data;
 
 #if FILE_SYSTEM_USE_KERNEL32
 			ful::heap_string_utfw files;
@@ -76,7 +92,7 @@ namespace engine
 
 			engine::Hash strand;
 			engine::file::write_callback * callback;
-			utility::any data;
+			engine::task::any data;
 
 			bool append : 1;
 			bool overwrite : 1;
@@ -84,17 +100,22 @@ namespace engine
 
 		struct FileMissingWork
 		{
-			ext::heap_shared_ptr<ReadData> ptr;
+			ext::pool_shared_ptr<ReadData> ptr;
 		};
 
 		struct FileReadWork
 		{
-			ext::heap_shared_ptr<ReadData> ptr;
+			ext::pool_shared_ptr<ReadData> ptr;
+		};
+
+		struct StreamWork
+		{
+			ext::pool_shared_ptr<StreamData> ptr;
 		};
 
 		struct ScanChangeWork
 		{
-			ext::heap_shared_ptr<ScanData> ptr;
+			ext::pool_shared_ptr<ScanData> ptr;
 #if FILE_SYSTEM_USE_KERNEL32
 			ful::heap_string_utfw filepath; // (sub)directory
 			utility::heap_vector<ful::heap_string_utfw> files;
@@ -106,21 +127,22 @@ namespace engine
 
 		struct ScanOnceWork
 		{
-			ext::heap_shared_ptr<ScanData> ptr;
+			ext::pool_shared_ptr<ScanData> ptr;
 		};
 
 		struct ScanRecursiveWork
 		{
-			ext::heap_shared_ptr<ScanData> ptr;
+			ext::pool_shared_ptr<ScanData> ptr;
 		};
 
 		struct FileWriteWork
 		{
-			ext::heap_shared_ptr<WriteData> ptr;
+			ext::pool_shared_ptr<WriteData> ptr;
 		};
 
 		void post_work(FileMissingWork && data);
 		void post_work(FileReadWork && data);
+		void post_work(StreamWork && data);
 		void post_work(ScanChangeWork && data);
 		void post_work(ScanOnceWork && data);
 		void post_work(ScanRecursiveWork && data);
@@ -37,7 +37,7 @@ namespace engine
 			engine::Asset debug_expression(directory),
 			utility::heap_string_utf8 && debug_expression(pattern),
 			watch_callback * debug_expression(callback),
-			utility::any && debug_expression(data))
+			engine::task::any && debug_expression(data))
 		{
 			debug_printline("todo read(", directory, ", ", pattern, ", ", callback, ", ", data, ")");
 		}
@@ -46,7 +46,7 @@ namespace engine
 			engine::Asset debug_expression(directory),
 			utility::heap_string_utf8 && debug_expression(pattern),
 			watch_callback * debug_expression(callback),
-			utility::any && debug_expression(data))
+			engine::task::any && debug_expression(data))
 		{
 			debug_printline("todo watch(", directory, ", ", pattern, ", ", callback, ", ", data, ")");
 		}
@@ -55,7 +55,7 @@ namespace engine
 			engine::Asset debug_expression(directory),
 			utility::heap_string_utf8 && debug_expression(filename),
 			write_callback * debug_expression(callback),
-			utility::any && debug_expression(data))
+			engine::task::any && debug_expression(data))
 		{
 			debug_printline("todo write(", directory, ", ", filename, ", ", callback, ", ", data, ")");
 		}
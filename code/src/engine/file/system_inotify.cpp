@@ -4,17 +4,24 @@
 
 #include "core/async/Thread.hpp"
 #include "core/container/Collection.hpp"
+#include "core/container/Queue.hpp"
 #include "core/content.hpp"
+#include "core/native/file.hpp"
 #include "core/sync/Event.hpp"
+#include "core/sync/Semaphore.hpp"
 
 #include "engine/Asset.hpp"
+#include "engine/file/archive.hpp"
 #include "engine/file/config.hpp"
 #include "engine/file/system.hpp"
+#include "engine/file/system/uring.hpp"
 #include "engine/file/watch/watch.hpp"
 #include "engine/HashTable.hpp"
 #include "engine/task/scheduler.hpp"
 
+#include "utility/algorithm/find.hpp"
 #include "utility/any.hpp"
+#include "utility/container/vector.hpp"
 #include "utility/ext/unistd.hpp"
 #include "utility/optional.hpp"
 #include "utility/shared_ptr.hpp"
@@ -32,7 +39,11 @@
 #include <sys/stat.h>
 #include <unistd.h>
 
+#include <atomic>
+#include <cstdlib>
+#include <memory>
 #include <mutex>
+#include <utility>
 
 static_hashes("_working directory_");
 
@@ -59,10 +70,205 @@ namespace
 		{}
 	};
 
+	// an archive mapped into memory, shared with the reads in flight so
+	// that it outlives them
+	struct MappedArchive
+	{
+		void * map;
+		ext::usize size;
+		engine::file::archive archive;
+
+		~MappedArchive()
+		{
+			debug_verify(::munmap(map, size) == 0, "failed with errno ", errno);
+		}
+
+		explicit MappedArchive(void * map, ext::usize size)
+			: map(map)
+			, size(size)
+		{}
+		MappedArchive(const MappedArchive &) = delete;
+		MappedArchive & operator = (const MappedArchive &) = delete;
+	};
+
+	struct Archive
+	{
+		ful::heap_string_utf8 dirpath; // the filepath of the archive, as if it was a directory
+
+		ext::pool_shared_ptr<MappedArchive> ptr;
+
+		ext::ssize share_count;
+
+		explicit Archive(ful::heap_string_utf8 && dirpath, ext::pool_shared_ptr<MappedArchive> && ptr)
+			: dirpath(std::move(dirpath))
+			, ptr(std::move(ptr))
+			, share_count(0)
+		{}
+	};
+
 	struct Alias
 	{
 		engine::Token directory;
 	};
+
+	// reads are done on the ring and on the read threads, where they
+	// may complete in any order, so every read that is requested on a
+	// strand takes a ticket, and the ones that complete ahead of their
+	// turn are held back until the reads before them have been posted
+	//
+	// note reads on the empty strand are not ordered and take the zero
+	// ticket
+	class ReadSequencer
+	{
+		struct Held
+		{
+			std::uint64_t ticket;
+			engine::task::work_callback * workcall;
+			engine::task::any data;
+		};
+
+		struct Strand
+		{
+			std::uint64_t next_ticket;
+			std::uint64_t next_post;
+			utility::heap_vector<Held> held;
+			// one thread at a time posts the works of the strand, the
+			// others leave theirs in held for it to pick up
+			bool posting;
+		};
+
+		utility::spinlock lock_;
+		// the strands with reads in flight
+		core::container::Collection
+		<
+			engine::Hash,
+			utility::heap_storage_traits,
+			utility::heap_storage<Strand>
+		>
+		strands_;
+
+	public:
+		std::uint64_t take(engine::Hash strand)
+		{
+			if (strand == engine::Hash{})
+				return 0;
+
+			std::lock_guard<utility::spinlock> guard(lock_);
+
+			const auto it = find(strands_, strand);
+			if (it != strands_.end())
+				return strands_.get<Strand>(it)->next_ticket++;
+
+			if (!debug_verify(strands_.emplace<Strand>(strand, Strand{2, 1, utility::heap_vector<Held>(), false})))
+				return 0; // error, the read is not ordered
+
+			return 1;
+		}
+
+		// posts the work once every read that took a ticket before it on
+		// the same strand has been posted
+		void post(engine::task::scheduler & taskscheduler, engine::Hash strand, std::uint64_t ticket, engine::task::work_callback * workcall, engine::task::any && data)
+		{
+			if (ticket == 0)
+			{
+				engine::task::post_work(taskscheduler, strand, workcall, std::move(data));
+				return;
+			}
+
+			utility::heap_vector<Held> ready;
+			{
+				std::lock_guard<utility::spinlock> guard(lock_);
+
+				const auto it = find(strands_, strand);
+				if (!debug_assert(it != strands_.end()))
+				{
+					engine::task::post_work(taskscheduler, strand, workcall, std::move(data));
+					return;
+				}
+
+				Strand * const strand_data = strands_.get<Strand>(it);
+				if (!debug_verify(strand_data->held.try_emplace_back(Held{ticket, workcall, std::move(data)})))
+				{
+					// error, the read is posted out of order rather than lost
+					engine::task::post_work(taskscheduler, strand, workcall, std::move(data));
+					return;
+				}
+
+				if (strand_data->posting)
+					return;
+
+				if (!take_ready(*strand_data, ready))
+					return;
+
+				strand_data->posting = true;
+			}
+
+			// the works are posted without the lock, but no other thread
+			// posts on the strand until the posting flag is cleared, so
+			// they still arrive in order
+			while (true)
+			{
+				for (Held & held : ready)
+				{
+					engine::task::post_work(taskscheduler, strand, held.workcall, std::move(held.data));
+				}
+				ready.clear();
+
+				std::lock_guard<utility::spinlock> guard(lock_);
+
+				const auto it = find(strands_, strand);
+				if (!debug_assert(it != strands_.end()))
+					return;
+
+				Strand * const strand_data = strands_.get<Strand>(it);
+				if (!take_ready(*strand_data, ready))
+				{
+					strand_data->posting = false;
+
+					if (strand_data->next_post == strand_data->next_ticket)
+					{
+						strands_.erase(it);
+					}
+					return;
+				}
+			}
+		}
+
+	private:
+		// assumes the lock is held, moves the held works that are next in
+		// line to ready
+		static bool take_ready(Strand & strand_data, utility::heap_vector<Held> & ready)
+		{
+			for (auto held_it = strand_data.held.begin(); held_it != strand_data.held.end();)
+			{
+				if (held_it->ticket == strand_data.next_post)
+				{
+					if (!debug_verify(ready.try_emplace_back(std::move(*held_it))))
+						break; // error, the rest is picked up by the next post
+
+					strand_data.next_post++;
+
+					strand_data.held.erase(held_it);
+					held_it = strand_data.held.begin();
+				}
+				else
+				{
+					++held_it;
+				}
+			}
+			return !ext::empty(ready);
+		}
+	};
+
+	// a read that has been requested but not started yet
+	struct QueuedRead
+	{
+		ext::pool_shared_ptr<engine::file::ReadData> ptr;
+		std::uint64_t ticket;
+		// the file if the ring has opened it already, in which case it
+		// is also shared locked unless the lock was contended
+		int fd = -1;
+	};
 }
 
 namespace engine
@@ -82,10 +288,15 @@ namespace engine
 				engine::Token,
 				utility::heap_storage_traits,
 				utility::heap_storage<Directory>,
-				utility::heap_storage<TemporaryDirectory>
+				utility::heap_storage<TemporaryDirectory>,
+				utility::heap_storage<Archive>
 			>
 			directories;
 
+			// archives are never watched, but the ids of the watches that
+			// would have been added are kept so that they can be removed
+			utility::heap_vector<engine::Token> archive_watches;
+
 			core::container::Collection
 			<
 				engine::Token,
@@ -97,6 +308,49 @@ namespace engine
 			int pipe[2];
 			core::async::Thread thread;
 
+#if FILE_SYSTEM_USE_IO_URING
+			// only ever touched by the file thread, the ring reads the
+			// small files, the rest goes to the read threads, and if the
+			// ring is not valid the read threads do all of the reads
+			engine::file::uring ring;
+			// reads that did not fit in the ring
+			core::container::PageQueue<utility::heap_storage<QueuedRead>> queued_reads;
+#endif
+
+			// blocking reads are done by threads of their own, so that
+			// they stall neither the file thread nor the task workers,
+			// these are the files that are mapped, or every file if
+			// there is no ring
+			utility::heap_vector<core::async::Thread> read_threads;
+			utility::spinlock read_queue_lock;
+			core::container::PageQueue<utility::heap_storage<QueuedRead>> read_queue;
+			// one for every queued read, and one for every thread when
+			// it is time to stop
+			core::sync::Semaphore read_queue_count;
+
+			// reads on the ring and on the read threads do not wait for
+			// their strand, which is fine as long as there are no writes
+			// that they could collide with
+			std::atomic_int writes_in_flight{0};
+			// reads on the read threads that have not been posted to
+			// their strand yet
+			std::atomic_int reads_in_flight{0};
+			// set by the read thread that posts the last of them
+			core::sync::Event<false> reads_done;
+
+			// keeps the reads on every strand in the order they were
+			// requested in
+			ReadSequencer read_order;
+
+			struct
+			{
+				std::atomic<ext::usize> buffered{0};
+				std::atomic<ext::usize> populated{0};
+				std::atomic<ext::usize> mapped{0};
+				std::atomic<ext::usize> ring{0};
+				std::atomic<ext::usize> archived{0};
+			} read_counters;
+
 			system_impl(config_t && config)
 				: config(static_cast<config_t &&>(config))
 			{}
@@ -203,62 +457,870 @@ namespace
 
 			debug_verify(errno == 0, "readdir failed with errno ", errno);
 
-			debug_verify(::closedir(dir) != -1, "failed with errno ", errno);
+			debug_verify(::closedir(dir) != -1, "failed with errno ", errno);
+
+			ful::reduce(pattern, pattern.begin() + dirpath.size());
+		}
+
+		if (!empty(files))
+		{
+			files.reduce(files.end() - 1); // trailing ;
+		}
+	}
+
+	// a file that is either read into a buffer, or open, shared locked,
+	// and mapped into memory
+	struct LoadedFile
+	{
+		int fd = -1;
+		void * map = nullptr;
+		char * buffer = nullptr;
+		ext::usize capacity = 0;
+		ext::usize size = 0;
+
+		~LoadedFile()
+		{
+			if (buffer)
+			{
+				core::native::give_file_buffer(buffer, capacity);
+			}
+			if (map)
+			{
+				debug_verify(::munmap(map, size) == 0, "failed with errno ", errno);
+			}
+			if (fd != -1)
+			{
+				debug_verify(::close(fd) == 0, "failed with errno ", errno);
+			}
+		}
+		LoadedFile() = default;
+		LoadedFile(LoadedFile && other) noexcept
+			: fd(std::exchange(other.fd, -1))
+			, map(std::exchange(other.map, nullptr))
+			, buffer(std::exchange(other.buffer, nullptr))
+			, capacity(other.capacity)
+			, size(other.size)
+		{}
+		LoadedFile & operator = (LoadedFile && other) = delete;
+
+		void * data() const { return map ? map : buffer; }
+	};
+
+	// small files are read into a buffer, as mapping them costs more
+	// than copying them, especially when they are unmapped, bigger files
+	// are mapped and paged in at once unless they are too big for it
+	//
+	// note the file may have been opened already, and then the lock is
+	// only waited for if it has not been acquired yet
+	bool load_file(engine::file::system_impl & impl, const ful::heap_string_utf8 & filepath, int fd, LoadedFile & file)
+	{
+		if (fd != -1)
+		{
+			file.fd = fd;
+		}
+		else
+		{
+			// note updating access time takes time, so let's not (O_NOATIME)
+			file.fd = ::open(filepath.data(), O_RDONLY | O_NOATIME);
+			if (file.fd == -1)
+			{
+				debug_verify(errno == ENOENT, "open(\"", filepath, "\", O_RDONLY | O_NOATIME) failed with errno ", errno);
+				return false;
+			}
+		}
+
+		// todo can this lock be acquired on open?
+		while (::flock(file.fd, LOCK_SH) != 0)
+		{
+			if (!debug_verify(errno == EINTR))
+			{
+				break;
+			}
+		}
+
+		struct stat statbuf;
+		debug_verify(::fstat(file.fd, &statbuf) == 0, "failed with errno ", errno);
+
+		const ext::usize size = statbuf.st_size;
+		// note empty files fail just like they do when mapped
+		if (size == 0)
+			return false;
+
+		if (size <= impl.config.small_file_size)
+		{
+			ext::usize capacity = impl.config.small_file_size;
+			char * const buffer = core::native::take_file_buffer(size, capacity);
+			if (!debug_verify(buffer))
+				return false;
+
+			file.buffer = buffer;
+			file.capacity = capacity;
+
+			if (!debug_verify(ext::pread_all_nonzero(file.fd, buffer, size, 0) == size, "failed with errno ", errno))
+				return false;
+
+			file.size = size;
+
+			// the lock is not needed after the file has been copied
+			debug_verify(::close(file.fd) == 0, "failed with errno ", errno);
+			file.fd = -1;
+
+			impl.read_counters.buffered.fetch_add(1, std::memory_order_relaxed);
+		}
+		else
+		{
+			const bool populate = size <= impl.config.populate_file_size;
+
+			void * map = ::mmap(nullptr, size, PROT_READ, populate ? MAP_PRIVATE | MAP_POPULATE : MAP_PRIVATE, file.fd, 0);
+			if (map == MAP_FAILED)
+				return false;
+
+			file.map = map;
+			file.size = size;
+
+			(populate ? impl.read_counters.populated : impl.read_counters.mapped).fetch_add(1, std::memory_order_relaxed);
+		}
+
+		return true;
+	}
+
+	bool read_file(engine::file::system_impl & impl, ful::heap_string_utf8 & filepath, std::uint32_t root, engine::file::read_callback * callback, engine::task::any & data)
+	{
+		LoadedFile file;
+		if (!load_file(impl, filepath, -1, file))
+			return false;
+
+		ful::cstr_utf8 relpath(filepath.data() + root, filepath.data() + filepath.size());
+
+		core::content content(relpath, file.data(), file.size);
+
+		engine::file::system filesystem(impl);
+		callback(filesystem, content, data);
+		filesystem.detach();
+
+		return true;
+	}
+
+	struct free_deleter
+	{
+		void operator () (char * p) const { std::free(p); }
+	};
+
+	bool stream_chunks(engine::file::StreamData & stream_data, int fd, engine::file::system & filesystem, ful::cstr_utf8 relpath)
+	{
+		// todo can this lock be acquired on open?
+		while (::flock(fd, LOCK_SH) != 0)
+		{
+			if (!debug_verify(errno == EINTR))
+			{
+				break;
+			}
+		}
+
+		struct stat statbuf;
+		if (!debug_verify(::fstat(fd, &statbuf) == 0, "failed with errno ", errno))
+			return false;
+
+		const ext::usize file_size = statbuf.st_size;
+		if (file_size == 0)
+			return false;
+
+		// makes the kernel read ahead further than it normally would
+		debug_verify(::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL) == 0);
+
+		const ext::usize stream_size = stream_data.impl.config.stream_size > 0 ? stream_data.impl.config.stream_size : 1;
+		const ext::usize buffer_size = stream_size < file_size ? stream_size : file_size;
+
+		std::unique_ptr<char, free_deleter> buffer(static_cast<char *>(std::malloc(buffer_size)));
+		if (!debug_verify(buffer))
+			return false;
+
+		ext::usize offset = 0;
+		do
+		{
+			const ext::usize remaining = file_size - offset;
+			const ext::usize size = ext::pread_all_nonzero(fd, buffer.get(), buffer_size < remaining ? buffer_size : remaining, offset);
+			if (size == 0)
+			{
+				// the caller follows up with the empty chunk, so that the
+				// callback can tell that the stream did not finish
+				debug_printline("stream of \"", relpath, "\" ended early, errno ", errno);
+				return false;
+			}
+
+			const ext::usize next_offset = offset + size;
+			if (next_offset < file_size)
+			{
+				// the next chunk is read in the background while the
+				// callback is busy with this one
+				debug_verify(::posix_fadvise(fd, next_offset, buffer_size, POSIX_FADV_WILLNEED) == 0);
+			}
+
+			core::content chunk(relpath, buffer.get(), size);
+			if (!stream_data.callback(filesystem, chunk, offset, file_size, stream_data.data))
+				break;
+
+			offset = next_offset;
+		}
+		while (offset < file_size);
+
+		return true;
+	}
+
+	bool stream_file(engine::file::StreamData & stream_data, engine::file::system & filesystem, ful::cstr_utf8 relpath)
+	{
+		// note updating access time takes time, so let's not (O_NOATIME)
+		const int fd = ::open(stream_data.filepath.data(), O_RDONLY | O_NOATIME);
+		if (fd == -1)
+		{
+			debug_verify(errno == ENOENT, "open(\"", stream_data.filepath, "\", O_RDONLY | O_NOATIME) failed with errno ", errno);
+			return false;
+		}
+
+		const bool streamed = stream_chunks(stream_data, fd, filesystem, relpath);
+
+		debug_verify(::close(fd) == 0, "failed with errno ", errno);
+
+		return streamed;
+	}
+
+	struct ArchiveReadWork
+	{
+		ext::pool_shared_ptr<engine::file::ReadData> ptr;
+		ext::pool_shared_ptr<MappedArchive> archive;
+	};
+
+	void post_archive_read(ArchiveReadWork && data, std::uint64_t ticket)
+	{
+		engine::file::system_impl & impl = data.ptr->impl;
+		engine::Hash strand = data.ptr->strand;
+
+		impl.read_order.post(
+			*impl.taskscheduler,
+			strand,
+			ticket,
+			[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, engine::task::any && data)
+			{
+				if (debug_assert(data.type_id() == utility::type_id<ArchiveReadWork>()))
+				{
+					ArchiveReadWork && work = utility::any_cast<ArchiveReadWork &&>(std::move(data));
+					engine::file::ReadData & read_data = *work.ptr;
+					const engine::file::archive & archive = work.archive->archive;
+
+					ful::cstr_utf8 relpath(read_data.filepath.data() + read_data.root, read_data.filepath.data() + read_data.filepath.size());
+
+					engine::file::system filesystem(read_data.impl);
+					if (const engine::file::archive_entry * const entry = archive.find(relpath))
+					{
+						read_data.impl.read_counters.archived.fetch_add(1, std::memory_order_relaxed);
+
+						// note the archive is mapped read only
+						core::content content(relpath, const_cast<void *>(archive.payload(*entry)), static_cast<ext::usize>(entry->size));
+
+						read_data.callback(filesystem, content, read_data.data);
+					}
+					else
+					{
+						core::content content(relpath);
+
+						read_data.callback(filesystem, content, read_data.data);
+					}
+					filesystem.detach();
+				}
+			},
+			engine::task::any(std::move(data)));
+	}
+
+	struct ArchiveStreamWork
+	{
+		ext::pool_shared_ptr<engine::file::StreamData> ptr;
+		ext::pool_shared_ptr<MappedArchive> archive;
+	};
+
+	void post_archive_stream(ArchiveStreamWork && data)
+	{
+		engine::task::scheduler & taskscheduler = *data.ptr->impl.taskscheduler;
+		engine::Hash strand = data.ptr->strand;
+
+		engine::task::post_work(
+			taskscheduler,
+			strand,
+			[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, engine::task::any && data)
+			{
+				if (debug_assert(data.type_id() == utility::type_id<ArchiveStreamWork>()))
+				{
+					ArchiveStreamWork && work = utility::any_cast<ArchiveStreamWork &&>(std::move(data));
+					engine::file::StreamData & stream_data = *work.ptr;
+					const engine::file::archive & archive = work.archive->archive;
+
+					ful::cstr_utf8 relpath(stream_data.filepath.data() + stream_data.root, stream_data.filepath.data() + stream_data.filepath.size());
+
+					engine::file::system filesystem(stream_data.impl);
+					const engine::file::archive_entry * const entry = archive.find(relpath);
+					if (entry && entry->size > 0)
+					{
+						char * const payload = static_cast<char *>(const_cast<void *>(archive.payload(*entry)));
+						const ext::usize file_size = static_cast<ext::usize>(entry->size);
+						const ext::usize stream_size = stream_data.impl.config.stream_size > 0 ? stream_data.impl.config.stream_size : 1;
+
+						for (ext::usize offset = 0; offset < file_size; offset += stream_size)
+						{
+							core::content chunk(relpath, payload + offset, stream_size < file_size - offset ? stream_size : file_size - offset);
+							if (!stream_data.callback(filesystem, chunk, offset, file_size, stream_data.data))
+								break;
+						}
+					}
+					else
+					{
+						core::content chunk(relpath);
+
+						fiw_unused(stream_data.callback(filesystem, chunk, 0, 0, stream_data.data));
+					}
+					filesystem.detach();
+				}
+			},
+			engine::task::any(std::move(data)));
+	}
+
+	struct ArchiveScanWork
+	{
+		ext::pool_shared_ptr<engine::file::ScanData> ptr;
+		ext::pool_shared_ptr<MappedArchive> archive;
+		bool recurse;
+	};
+
+	void post_archive_scan(ArchiveScanWork && data)
+	{
+		engine::task::scheduler & taskscheduler = *data.ptr->impl.taskscheduler;
+		engine::Hash strand = data.ptr->strand;
+
+		engine::task::post_work(
+			taskscheduler,
+			strand,
+			[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, engine::task::any && data)
+			{
+				if (debug_assert(data.type_id() == utility::type_id<ArchiveScanWork>()))
+				{
+					ArchiveScanWork && work = utility::any_cast<ArchiveScanWork &&>(std::move(data));
+					engine::file::ScanData & scan_data = *work.ptr;
+					const engine::file::archive & archive = work.archive->archive;
+
+					// note archives never change, so nothing is ever removed
+					ful::heap_string_utf8 existing_files;
+					for (const engine::file::archive_entry & entry : archive)
+					{
+						const ful::view_utf8 name = archive.name(entry);
+						if (!work.recurse && ful::find(name.begin(), name.end(), ful::char8{'/'}) != name.end())
+							continue;
+
+						if (!debug_verify(ful::append(existing_files, name.begin(), name.end())))
+							return; // error
+
+						if (!debug_verify(ful::push_back(existing_files, ful::char8{';'})))
+							return; // error
+					}
+
+					if (!empty(existing_files))
+					{
+						existing_files.reduce(existing_files.end() - 1); // trailing ;
+					}
+
+					engine::file::system filesystem(scan_data.impl);
+					scan_data.callback(filesystem, scan_data.directory, std::move(existing_files), ful::heap_string_utf8(), scan_data.data);
+					filesystem.detach();
+				}
+			},
+			engine::task::any(std::move(data)));
+	}
+
+	void post_missing_read(engine::file::FileMissingWork && data, std::uint64_t ticket)
+	{
+		engine::file::system_impl & impl = data.ptr->impl;
+		engine::Hash strand = data.ptr->strand;
+
+		impl.read_order.post(
+			*impl.taskscheduler,
+			strand,
+			ticket,
+			[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, engine::task::any && data)
+			{
+				if (debug_assert(data.type_id() == utility::type_id<engine::file::FileMissingWork>()))
+				{
+					engine::file::FileMissingWork && work = utility::any_cast<engine::file::FileMissingWork &&>(std::move(data));
+					engine::file::ReadData & read_data = *work.ptr;
+
+					ful::cstr_utf8 relpath(read_data.filepath.data() + read_data.root, read_data.filepath.data() + read_data.filepath.size());
+
+					core::content content(relpath);
+
+					engine::file::system filesystem(read_data.impl);
+					read_data.callback(filesystem, content, read_data.data);
+					filesystem.detach();
+				}
+			},
+			engine::task::any(std::move(data)));
+	}
+
+	void post_blocking_read(engine::file::FileReadWork && data, std::uint64_t ticket)
+	{
+		engine::file::system_impl & impl = data.ptr->impl;
+		engine::Hash strand = data.ptr->strand;
+
+		impl.read_order.post(
+			*impl.taskscheduler,
+			strand,
+			ticket,
+			[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, engine::task::any && data)
+			{
+				if (debug_assert(data.type_id() == utility::type_id<engine::file::FileReadWork>()))
+				{
+					engine::file::FileReadWork && work = utility::any_cast<engine::file::FileReadWork &&>(std::move(data));
+					engine::file::ReadData & read_data = *work.ptr;
+
+					if (read_file(read_data.impl, read_data.filepath, read_data.root, read_data.callback, read_data.data))
+					{
+					}
+					else
+					{
+						ful::cstr_utf8 relpath(read_data.filepath.data() + read_data.root, read_data.filepath.data() + read_data.filepath.size());
+
+						core::content content(relpath);
+
+						engine::file::system filesystem(read_data.impl);
+						read_data.callback(filesystem, content, read_data.data);
+						filesystem.detach();
+					}
+				}
+			},
+			engine::task::any(std::move(data)));
+	}
+
+	struct LoadedReadWork
+	{
+		ext::pool_shared_ptr<engine::file::ReadData> ptr;
+		LoadedFile file;
+		bool loaded;
+	};
+
+	void post_loaded_read(LoadedReadWork && data, std::uint64_t ticket)
+	{
+		engine::file::system_impl & impl = data.ptr->impl;
+		engine::Hash strand = data.ptr->strand;
+
+		impl.read_order.post(
+			*impl.taskscheduler,
+			strand,
+			ticket,
+			[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, engine::task::any && data)
+			{
+				if (debug_assert(data.type_id() == utility::type_id<LoadedReadWork>()))
+				{
+					LoadedReadWork && work = utility::any_cast<LoadedReadWork &&>(std::move(data));
+					engine::file::ReadData & read_data = *work.ptr;
+
+					ful::cstr_utf8 relpath(read_data.filepath.data() + read_data.root, read_data.filepath.data() + read_data.filepath.size());
+
+					engine::file::system filesystem(read_data.impl);
+					if (work.loaded)
+					{
+						core::content content(relpath, work.file.data(), work.file.size);
+
+						read_data.callback(filesystem, content, read_data.data);
+					}
+					else
+					{
+						core::content content(relpath);
+
+						read_data.callback(filesystem, content, read_data.data);
+					}
+					filesystem.detach();
+				}
+			},
+			engine::task::any(std::move(data)));
+	}
+
+	core::async::thread_return thread_decl read_thread(core::async::thread_param arg)
+	{
+		engine::file::system_impl & impl = *static_cast<engine::file::system_impl *>(arg);
+
+		while (true)
+		{
+			if (!debug_verify(impl.read_queue_count.wait()))
+				return core::async::thread_return{};
+
+			QueuedRead read;
+			{
+				std::lock_guard<utility::spinlock> guard(impl.read_queue_lock);
+
+				// the queue is only empty when it is time to stop
+				if (!impl.read_queue.try_pop(read))
+					return core::async::thread_return{};
+			}
+
+			LoadedFile file;
+			const bool loaded = load_file(impl, read.ptr->filepath, read.fd, file);
+
+			post_loaded_read(LoadedReadWork{std::move(read.ptr), std::move(file), loaded}, read.ticket);
+			if (impl.reads_in_flight.fetch_sub(1, std::memory_order_release) == 1)
+			{
+				impl.reads_done.set();
+			}
+		}
+	}
+
+	// the blocking reads open the file on their own, which is rare
+	// enough that the file is not passed along
+	void close_queued_read(QueuedRead & read)
+	{
+		if (read.fd != -1)
+		{
+			debug_verify(::close(read.fd) == 0, "failed with errno ", errno);
+			read.fd = -1;
+		}
+	}
+
+	void start_pool_read(engine::file::system_impl & impl, QueuedRead && read)
+	{
+		bool pushed;
+		{
+			std::lock_guard<utility::spinlock> guard(impl.read_queue_lock);
+
+			pushed = debug_verify(impl.read_queue.try_push(std::move(read)));
+		}
+
+		if (!pushed)
+		{
+			close_queued_read(read);
+			post_blocking_read(engine::file::FileReadWork{std::move(read.ptr)}, read.ticket);
+			return;
+		}
+
+		impl.reads_in_flight.fetch_add(1, std::memory_order_relaxed);
+		fiw_unused(debug_verify(impl.read_queue_count.signal()));
+	}
+
+	void start_mapped_read(engine::file::system_impl & impl, QueuedRead && read)
+	{
+		if (!ext::empty(impl.read_threads))
+		{
+			start_pool_read(impl, std::move(read));
+		}
+		else
+		{
+			close_queued_read(read);
+			post_blocking_read(engine::file::FileReadWork{std::move(read.ptr)}, read.ticket);
+		}
+	}
+
+	void start_read_threads(engine::file::system_impl & impl)
+	{
+		for (ext::usize i = 0; i < impl.config.read_threads; i++)
+		{
+			core::async::Thread thread(read_thread, &impl);
+			if (!debug_verify(thread.valid()))
+				break;
+
+			if (!debug_verify(impl.read_threads.try_emplace_back(std::move(thread))))
+			{
+				// the thread stops as soon as it sees the empty queue
+				fiw_unused(impl.read_queue_count.signal());
+				thread.join();
+				break;
+			}
+		}
+	}
+
+	void stop_read_threads(engine::file::system_impl & impl)
+	{
+		// the file thread is gone, so no more reads are queued and every
+		// thread is bound to find the queue empty eventually
+		for (ext::usize i = 0; i < impl.read_threads.size(); i++)
+		{
+			fiw_unused(debug_verify(impl.read_queue_count.signal()));
+		}
+		for (auto & thread : impl.read_threads)
+		{
+			thread.join();
+		}
+		impl.read_threads.clear();
+	}
+
+	void finish_pool(engine::file::system_impl & impl)
+	{
+		// note the reads are only waited for until they are posted,
+		// which is not long, and the event may still be set from an
+		// earlier batch of reads in which case the count is looked at
+		// once more
+		while (impl.reads_in_flight.load(std::memory_order_acquire) != 0)
+		{
+			impl.reads_done.wait();
+		}
+	}
+
+#if FILE_SYSTEM_USE_IO_URING
+	constexpr unsigned ring_entries = 256;
+
+	// a read on the ring, it is the user data of every operation that
+	// it submits, from opening the file to closing it
+	struct RingRead
+	{
+		enum Stage
+		{
+			opening,
+			reading,
+			closing,
+		};
+
+		ext::pool_shared_ptr<engine::file::ReadData> ptr;
+		std::uint64_t ticket;
+
+		Stage stage;
+		int fd;
+		// taken from the same buffers as the blocking reads use
+		char * buffer;
+		ext::usize capacity;
+		ext::usize size;
+		ext::usize offset;
+	};
+
+	struct RingReadWork
+	{
+		ext::pool_shared_ptr<engine::file::ReadData> ptr;
+		// the buffer, which is given back once the work is done
+		LoadedFile file;
+	};
+
+	void post_ring_read(RingReadWork && data, std::uint64_t ticket)
+	{
+		engine::file::system_impl & impl = data.ptr->impl;
+		engine::Hash strand = data.ptr->strand;
+
+		impl.read_order.post(
+			*impl.taskscheduler,
+			strand,
+			ticket,
+			[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, engine::task::any && data)
+			{
+				if (debug_assert(data.type_id() == utility::type_id<RingReadWork>()))
+				{
+					RingReadWork && work = utility::any_cast<RingReadWork &&>(std::move(data));
+					engine::file::ReadData & read_data = *work.ptr;
+
+					ful::cstr_utf8 relpath(read_data.filepath.data() + read_data.root, read_data.filepath.data() + read_data.filepath.size());
+
+					core::content content(relpath, work.file.data(), work.file.size);
+
+					engine::file::system filesystem(read_data.impl);
+					read_data.callback(filesystem, content, read_data.data);
+					filesystem.detach();
+				}
+			},
+			engine::task::any(std::move(data)));
+	}
+
+	void prepare_read(io_uring_sqe & sqe, RingRead & read)
+	{
+		// note a single read is capped by the kernel anyway (see
+		// read(2)), what remains is read in another round
+		const ext::usize remaining = read.size - read.offset;
+		const ext::usize len = remaining < 0x7ffff000 ? remaining : 0x7ffff000;
+
+		sqe.opcode = IORING_OP_READ;
+		sqe.fd = read.fd;
+		sqe.addr = reinterpret_cast<std::uintptr_t>(read.buffer + read.offset);
+		sqe.len = static_cast<__u32>(len);
+		sqe.off = read.offset;
+		sqe.user_data = reinterpret_cast<std::uintptr_t>(&read);
+	}
+
+	void close_ring_read(engine::file::uring & ring, RingRead & read)
+	{
+		io_uring_sqe * const sqe = ring.get_sqe();
+		if (!debug_verify(sqe, "the operation that just completed ought to have made room"))
+		{
+			debug_verify(::close(read.fd) == 0, "failed with errno ", errno);
+			delete &read;
+			return;
+		}
+
+		read.stage = RingRead::closing;
+
+		sqe->opcode = IORING_OP_CLOSE;
+		sqe->fd = read.fd;
+		sqe->user_data = reinterpret_cast<std::uintptr_t>(&read);
+	}
+
+	void start_ring_read(engine::file::system_impl & impl, QueuedRead && queued)
+	{
+		io_uring_sqe * const sqe = impl.ring.get_sqe();
+		if (!sqe)
+		{
+			if (!debug_verify(impl.queued_reads.try_push(std::move(queued))))
+			{
+				post_blocking_read(engine::file::FileReadWork{std::move(queued.ptr)}, queued.ticket);
+			}
+			return;
+		}
+
+		RingRead * const read = new RingRead{std::move(queued.ptr), queued.ticket, RingRead::opening, -1, nullptr, 0, 0, 0};
+
+		// note updating access time takes time, so let's not (O_NOATIME)
+		sqe->opcode = IORING_OP_OPENAT;
+		sqe->fd = AT_FDCWD;
+		sqe->addr = reinterpret_cast<std::uintptr_t>(read->ptr->filepath.data());
+		sqe->open_flags = O_RDONLY | O_NOATIME;
+		sqe->user_data = reinterpret_cast<std::uintptr_t>(read);
+	}
+
+	void complete_open(engine::file::system_impl & impl, RingRead & read, int res)
+	{
+		if (res < 0)
+		{
+			debug_verify(res == -ENOENT, "open(\"", read.ptr->filepath, "\", O_RDONLY | O_NOATIME) failed with errno ", -res);
+
+			post_missing_read(engine::file::FileMissingWork{std::move(read.ptr)}, read.ticket);
+			delete &read;
+			return;
+		}
+		read.fd = res;
+
+		// note the lock is not waited for and the inode has been read by
+		// the open, so neither of these calls blocks the ring for long
+
+		// the ring cannot wait for locks, files that are being written
+		// to are handed to the read threads, which can
+		if (::flock(read.fd, LOCK_SH | LOCK_NB) != 0)
+		{
+			debug_verify(errno == EWOULDBLOCK, "failed with errno ", errno);
+
+			start_mapped_read(impl, QueuedRead{std::move(read.ptr), read.ticket, read.fd});
+			delete &read;
+			return;
+		}
+
+		struct stat statbuf;
+		debug_verify(::fstat(read.fd, &statbuf) == 0, "failed with errno ", errno);
+
+		read.size = static_cast<ext::usize>(statbuf.st_size);
+		if (read.size > impl.config.small_file_size)
+		{
+			// bigger files are mapped rather than copied, which the ring
+			// cannot do, so they are handed to the read threads along
+			// with the open and locked file
+			start_mapped_read(impl, QueuedRead{std::move(read.ptr), read.ticket, read.fd});
+			delete &read;
+			return;
+		}
+
+		// note empty files fail just like they do when mapped
+		read.capacity = impl.config.small_file_size;
+		read.buffer = read.size > 0 ? core::native::take_file_buffer(read.size, read.capacity) : nullptr;
+		if (!read.buffer)
+		{
+			post_missing_read(engine::file::FileMissingWork{std::move(read.ptr)}, read.ticket);
+			close_ring_read(impl.ring, read);
+			return;
+		}
+
+		io_uring_sqe * const sqe = impl.ring.get_sqe();
+		if (!debug_verify(sqe, "the operation that just completed ought to have made room"))
+		{
+			core::native::give_file_buffer(read.buffer, read.capacity);
+			debug_verify(::close(read.fd) == 0, "failed with errno ", errno);
+
+			post_blocking_read(engine::file::FileReadWork{std::move(read.ptr)}, read.ticket);
+			delete &read;
+			return;
+		}
+
+		read.stage = RingRead::reading;
+		prepare_read(*sqe, read);
+	}
+
+	void complete_read(engine::file::system_impl & impl, RingRead & read, int res)
+	{
+		if (res < 0 && res != -EINTR && res != -EAGAIN)
+		{
+			debug_fail("read failed with errno ", -res);
 
-			ful::reduce(pattern, pattern.begin() + dirpath.size());
+			core::native::give_file_buffer(read.buffer, read.capacity);
+			post_missing_read(engine::file::FileMissingWork{std::move(read.ptr)}, read.ticket);
+			close_ring_read(impl.ring, read);
+			return;
 		}
 
-		if (!empty(files))
+		if (res == 0)
 		{
-			files.reduce(files.end() - 1); // trailing ;
+			// the file got shorter since it was opened
+			read.size = read.offset;
 		}
-	}
-
-	bool read_file(engine::file::system_impl & impl, ful::heap_string_utf8 & filepath, std::uint32_t root, engine::file::read_callback * callback, utility::any & data)
-	{
-		// note updating access time takes time, so let's not (O_NOATIME)
-		const int fd = ::open(filepath.data(), O_RDONLY | O_NOATIME);
-		if (fd == -1)
+		else if (res > 0)
 		{
-			debug_verify(errno == ENOENT, "open(\"", filepath, "\", O_RDONLY | O_NOATIME) failed with errno ", errno);
-			return false;
+			read.offset += static_cast<ext::usize>(res);
 		}
 
-		// todo can this lock be acquired on open?
-		while (::flock(fd, LOCK_SH) != 0)
+		if (read.offset < read.size)
 		{
-			if (!debug_verify(errno == EINTR))
+			io_uring_sqe * const sqe = impl.ring.get_sqe();
+			if (debug_verify(sqe, "the operation that just completed ought to have made room"))
 			{
-				break;
+				prepare_read(*sqe, read);
+				return;
 			}
+			read.size = read.offset;
 		}
 
-		struct stat statbuf;
-		debug_verify(::fstat(fd, &statbuf) == 0, "failed with errno ", errno);
-
-		void * map = ::mmap(nullptr, statbuf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
-		if (map == MAP_FAILED)
-		{
-			debug_verify(::close(fd) == 0, "failed with errno ", errno);
+		impl.read_counters.ring.fetch_add(1, std::memory_order_relaxed);
 
-			return false;
-		}
+		RingReadWork work{std::move(read.ptr), LoadedFile()};
+		work.file.buffer = read.buffer;
+		work.file.capacity = read.capacity;
+		work.file.size = read.size;
 
-		ful::cstr_utf8 relpath(filepath.data() + root, filepath.data() + filepath.size());
+		post_ring_read(std::move(work), read.ticket);
+		close_ring_read(impl.ring, read);
+	}
 
-		core::content content(relpath, map, statbuf.st_size);
+	void process_ring(engine::file::system_impl & impl)
+	{
+		impl.ring.for_each_completion([&impl](__u64 user_data, __s32 res)
+		{
+			RingRead & read = *reinterpret_cast<RingRead *>(static_cast<std::uintptr_t>(user_data));
+			switch (read.stage)
+			{
+			case RingRead::opening:
+				complete_open(impl, read, res);
+				break;
+			case RingRead::reading:
+				complete_read(impl, read, res);
+				break;
+			case RingRead::closing:
+				debug_verify(res == 0, "close failed with errno ", -res);
+				delete &read;
+				break;
+			}
+		});
 
-		engine::file::system filesystem(impl);
-		callback(filesystem, content, data);
-		filesystem.detach();
+		QueuedRead queued;
+		while (!impl.ring.full() && impl.queued_reads.try_pop(queued))
+		{
+			start_ring_read(impl, std::move(queued));
+		}
+	}
 
-		debug_verify(::munmap(map, statbuf.st_size) == 0, "failed with errno ", errno);
-		debug_verify(::close(fd) == 0, "failed with errno ", errno);
+	void finish_ring(engine::file::system_impl & impl)
+	{
+		while (impl.ring.in_flight() > 0)
+		{
+			if (!impl.ring.wait())
+				break;
 
-		return true;
+			process_ring(impl);
+		}
 	}
+#endif
 
-	bool write_file(engine::file::system_impl & impl, ful::heap_string_utf8 & filepath, std::uint32_t root, engine::file::write_callback * callback, utility::any & data, bool append, bool overwrite)
+	bool write_file(engine::file::system_impl & impl, ful::heap_string_utf8 & filepath, std::uint32_t root, engine::file::write_callback * callback, engine::task::any & data, bool append, bool overwrite)
 	{
 		// todo define _FILE_OFFSET_BITS 64 (see open(2))
 
@@ -493,62 +1555,63 @@ namespace engine
 	{
 		void post_work(FileMissingWork && data)
 		{
-			engine::task::scheduler & taskscheduler = *data.ptr->impl.taskscheduler;
-			engine::Hash strand = data.ptr->strand;
+			engine::file::system_impl & impl = data.ptr->impl;
+			const std::uint64_t ticket = impl.read_order.take(data.ptr->strand);
 
-			engine::task::post_work(
-				taskscheduler,
-				strand,
-				[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, utility::any && data)
-				{
-					if (debug_assert(data.type_id() == utility::type_id<FileMissingWork>()))
-					{
-						FileMissingWork && work = utility::any_cast<FileMissingWork &&>(std::move(data));
-						engine::file::ReadData & read_data = *work.ptr;
-
-						ful::cstr_utf8 relpath(read_data.filepath.data() + read_data.root, read_data.filepath.data() + read_data.filepath.size());
-
-						core::content content(relpath);
-
-						engine::file::system filesystem(read_data.impl);
-						read_data.callback(filesystem, content, read_data.data);
-						filesystem.detach();
-					}
-				},
-				utility::any(std::move(data)));
+			post_missing_read(std::move(data), ticket);
 		}
 
 		void post_work(FileReadWork && data)
+		{
+			// note reads are only ever started from the file thread, which
+			// is what has the tickets taken in the order of the requests
+			engine::file::system_impl & impl = data.ptr->impl;
+			const std::uint64_t ticket = impl.read_order.take(data.ptr->strand);
+			if (impl.writes_in_flight.load(std::memory_order_acquire) == 0)
+			{
+#if FILE_SYSTEM_USE_IO_URING
+				if (impl.ring.valid())
+				{
+					start_ring_read(impl, QueuedRead{std::move(data.ptr), ticket});
+					return;
+				}
+#endif
+				start_mapped_read(impl, QueuedRead{std::move(data.ptr), ticket});
+				return;
+			}
+			post_blocking_read(std::move(data), ticket);
+		}
+
+		void post_work(StreamWork && data)
 		{
 			engine::task::scheduler & taskscheduler = *data.ptr->impl.taskscheduler;
 			engine::Hash strand = data.ptr->strand;
 
+			// note the whole stream is done in one task, as the strand
+			// must not let any writes in between the chunks
 			engine::task::post_work(
 				taskscheduler,
 				strand,
-				[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, utility::any && data)
+				[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, engine::task::any && data)
 				{
-					if (debug_assert(data.type_id() == utility::type_id<FileReadWork>()))
+					if (debug_assert(data.type_id() == utility::type_id<StreamWork>()))
 					{
-						FileReadWork && work = utility::any_cast<FileReadWork &&>(std::move(data));
-						engine::file::ReadData & read_data = *work.ptr;
+						StreamWork && work = utility::any_cast<StreamWork &&>(std::move(data));
+						engine::file::StreamData & stream_data = *work.ptr;
 
-						if (read_file(read_data.impl, read_data.filepath, read_data.root, read_data.callback, read_data.data))
-						{
-						}
-						else
-						{
-							ful::cstr_utf8 relpath(read_data.filepath.data() + read_data.root, read_data.filepath.data() + read_data.filepath.size());
+						ful::cstr_utf8 relpath(stream_data.filepath.data() + stream_data.root, stream_data.filepath.data() + stream_data.filepath.size());
 
-							core::content content(relpath);
+						engine::file::system filesystem(stream_data.impl);
+						if (!stream_file(stream_data, filesystem, relpath))
+						{
+							core::content chunk(relpath);
 
-							engine::file::system filesystem(read_data.impl);
-							read_data.callback(filesystem, content, read_data.data);
-							filesystem.detach();
+							fiw_unused(stream_data.callback(filesystem, chunk, 0, 0, stream_data.data));
 						}
+						filesystem.detach();
 					}
 				},
-				utility::any(std::move(data)));
+				engine::task::any(std::move(data)));
 		}
 
 		void post_work(ScanChangeWork && data)
@@ -559,7 +1622,7 @@ namespace engine
 			engine::task::post_work(
 				taskscheduler,
 				strand,
-				[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, utility::any && data)
+				[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, engine::task::any && data)
 				{
 					if (debug_assert(data.type_id() == utility::type_id<ScanChangeWork>()))
 					{
@@ -599,7 +1662,7 @@ namespace engine
 						filesystem.detach();
 					}
 				},
-				utility::any(std::move(data)));
+				engine::task::any(std::move(data)));
 		}
 
 		void post_work(ScanOnceWork && data)
@@ -610,7 +1673,7 @@ namespace engine
 			engine::task::post_work(
 				taskscheduler,
 				strand,
-				[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, utility::any && data)
+				[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, engine::task::any && data)
 				{
 					if (debug_assert(data.type_id() == utility::type_id<ScanOnceWork>()))
 					{
@@ -631,7 +1694,7 @@ namespace engine
 						filesystem.detach();
 					}
 				},
-				utility::any(std::move(data)));
+				engine::task::any(std::move(data)));
 		}
 
 		void post_work(ScanRecursiveWork && data)
@@ -642,7 +1705,7 @@ namespace engine
 			engine::task::post_work(
 				taskscheduler,
 				strand,
-				[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, utility::any && data)
+				[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, engine::task::any && data)
 				{
 					if (debug_assert(data.type_id() == utility::type_id<ScanRecursiveWork>()))
 					{
@@ -663,7 +1726,7 @@ namespace engine
 						filesystem.detach();
 					}
 				},
-				utility::any(std::move(data)));
+				engine::task::any(std::move(data)));
 		}
 
 		void post_work(FileWriteWork && data)
@@ -674,7 +1737,7 @@ namespace engine
 			engine::task::post_work(
 				taskscheduler,
 				strand,
-				[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, utility::any && data)
+				[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, engine::task::any && data)
 				{
 					if (debug_assert(data.type_id() == utility::type_id<FileWriteWork>()))
 					{
@@ -694,9 +1757,11 @@ namespace engine
 							write_data.callback(filesystem, content, std::move(write_data.data));
 							filesystem.detach();
 						}
+
+						write_data.impl.writes_in_flight.fetch_sub(1, std::memory_order_release);
 					}
 				},
-				utility::any(std::move(data)));
+				engine::task::any(std::move(data)));
 		}
 	}
 }
@@ -715,6 +1780,13 @@ namespace
 		engine::Hash alias;
 	};
 
+	struct RegisterArchive
+	{
+		engine::Hash alias;
+		ful::heap_string_utf8 filepath;
+		engine::Hash parent;
+	};
+
 	struct UnregisterDirectory
 	{
 		engine::Hash alias;
@@ -727,10 +1799,19 @@ namespace
 		ful::heap_string_utf8 filepath;
 		engine::Hash strand;
 		engine::file::read_callback * callback;
-		utility::any data;
+		engine::task::any data;
 		engine::file::flags mode;
 	};
 
+	struct Stream
+	{
+		engine::Hash directory;
+		ful::heap_string_utf8 filepath;
+		engine::Hash strand;
+		engine::file::stream_callback * callback;
+		engine::task::any data;
+	};
+
 	struct RemoveWatch
 	{
 		engine::Token id;
@@ -742,7 +1823,7 @@ namespace
 		engine::Hash directory;
 		engine::Hash strand;
 		engine::file::scan_callback * callback;
-		utility::any data;
+		engine::task::any data;
 		engine::file::flags mode;
 	};
 
@@ -752,7 +1833,7 @@ namespace
 		ful::heap_string_utf8 filepath;
 		engine::Hash strand;
 		engine::file::write_callback * callback;
-		utility::any data;
+		engine::task::any data;
 		engine::file::flags mode;
 	};
 
@@ -809,6 +1890,92 @@ namespace
 			return; // error
 	}
 
+	ext::pool_shared_ptr<MappedArchive> map_archive(const ful::heap_string_utf8 & filepath)
+	{
+		const int fd = ::open(filepath.data(), O_RDONLY);
+		if (!debug_verify(fd != -1, "open(\"", filepath, "\", O_RDONLY) failed with errno ", errno))
+			return ext::pool_shared_ptr<MappedArchive>();
+
+		struct stat statbuf;
+		debug_verify(::fstat(fd, &statbuf) == 0, "failed with errno ", errno);
+
+		// note the descriptor is not needed once the archive is mapped
+		void * const map = ::mmap(nullptr, statbuf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		debug_verify(::close(fd) == 0, "failed with errno ", errno);
+
+		if (!debug_verify(map != MAP_FAILED, "failed with errno ", errno))
+			return ext::pool_shared_ptr<MappedArchive>();
+
+		ext::pool_shared_ptr<MappedArchive> ptr(utility::in_place, map, static_cast<ext::usize>(statbuf.st_size));
+		if (!debug_verify(ptr))
+		{
+			debug_verify(::munmap(map, statbuf.st_size) == 0, "failed with errno ", errno);
+			return ext::pool_shared_ptr<MappedArchive>();
+		}
+
+		if (!debug_verify(ptr->archive.open(map, ptr->size), "\"", filepath, "\" is not an archive"))
+			return ext::pool_shared_ptr<MappedArchive>();
+
+		return ptr;
+	}
+
+	void process_register_archive(engine::file::system_impl & system_impl, engine::file::watch_impl & /*watch_impl*/, void * data)
+	{
+		std::unique_ptr<RegisterArchive> ptr(static_cast<RegisterArchive *>(data));
+		auto & x = *ptr;
+
+		if (!debug_verify(find(system_impl.aliases, engine::Token(x.alias)) == system_impl.aliases.end()))
+			return; // error
+
+		const auto parent_alias_it = find(system_impl.aliases, engine::Token(x.parent));
+		if (!debug_verify(parent_alias_it != system_impl.aliases.end()))
+			return; // error
+
+		if (!debug_verify(validate_filepath(ful::view_utf8(x.filepath))))
+			return; // error
+
+		const auto parent_directory_it = find(system_impl.directories, system_impl.aliases.get<Alias>(parent_alias_it)->directory);
+		if (!debug_assert(parent_directory_it != system_impl.directories.end()))
+			return;
+
+		const auto & dirpath = system_impl.get_dirpath(parent_directory_it);
+
+		ful::heap_string_utf8 filepath;
+		if (!debug_verify(ful::append(filepath, dirpath)))
+			return; // error
+
+		if (!debug_verify(ful::append(filepath, x.filepath)))
+			return; // error
+
+		const auto directory_asset = engine::Asset(filepath);
+		const auto directory_it = find(system_impl.directories, engine::Token(directory_asset));
+		if (directory_it != system_impl.directories.end())
+		{
+			const auto archive_ptr = system_impl.directories.get<Archive>(directory_it);
+			if (!debug_verify(archive_ptr))
+				return;
+
+			archive_ptr->share_count++;
+		}
+		else
+		{
+			ext::pool_shared_ptr<MappedArchive> mapped_archive = map_archive(filepath);
+			if (!mapped_archive)
+				return; // error
+
+			// the files are found under the archive as if it was a
+			// directory
+			if (!debug_verify(ful::push_back(filepath, ful::char8{'/'})))
+				return; // error
+
+			if (!debug_verify(system_impl.directories.emplace<Archive>(engine::Token(directory_asset), std::move(filepath), std::move(mapped_archive))))
+				return; // error
+		}
+
+		if (!debug_verify(system_impl.aliases.emplace<Alias>(engine::Token(x.alias), engine::Token(directory_asset))))
+			return; // error
+	}
+
 	void process_register_temporary_directory(engine::file::system_impl & system_impl, engine::file::watch_impl & /*watch_impl*/, void * data)
 	{
 		auto & x = *static_cast<RegisterTemporaryDirectory *>(data);
@@ -865,6 +2032,7 @@ namespace
 		struct
 		{
 			bool operator () (Directory & x) { x.share_count--; return x.share_count < 0; }
+			bool operator () (Archive & x) { x.share_count--; return x.share_count < 0; }
 			bool operator () (TemporaryDirectory & x)
 			{
 				purge_temporary_directory(x.dirpath);
@@ -906,10 +2074,24 @@ namespace
 		if (!debug_verify(ful::append(filepath, x.filepath)))
 			return; // error
 
-		ext::heap_shared_ptr<engine::file::ReadData> data_ptr(utility::in_place, system_impl, std::move(filepath), static_cast<std::uint32_t>(dirpath.size()), x.strand, x.callback, std::move(x.data));
+		ext::pool_shared_ptr<engine::file::ReadData> data_ptr(utility::in_place, system_impl, std::move(filepath), static_cast<std::uint32_t>(dirpath.size()), x.strand, x.callback, std::move(x.data));
 		if (!debug_verify(data_ptr))
 			return; // error
 
+		// note archives never change, so there is nothing to watch
+		if (const Archive * const archive = system_impl.directories.get<Archive>(directory_it))
+		{
+			if (x.mode & engine::file::flags::ADD_WATCH)
+			{
+				debug_verify(system_impl.archive_watches.try_emplace_back(x.id));
+			}
+
+			const std::uint64_t ticket = system_impl.read_order.take(x.strand);
+
+			post_archive_read(ArchiveReadWork{std::move(data_ptr), archive->ptr}, ticket);
+			return;
+		}
+
 		if (x.mode & engine::file::flags::ADD_WATCH)
 		{
 			engine::file::add_file_watch(watch_impl, x.id, data_ptr, static_cast<bool>(x.mode & engine::file::flags::REPORT_MISSING));
@@ -918,10 +2100,56 @@ namespace
 		engine::file::post_work(engine::file::FileReadWork{std::move(data_ptr)});
 	}
 
-	void process_remove_watch(engine::file::system_impl & /*system_impl*/, engine::file::watch_impl & watch_impl, void * data)
+	void process_stream(engine::file::system_impl & system_impl, engine::file::watch_impl & /*watch_impl*/, void * data)
+	{
+		std::unique_ptr<Stream> ptr(static_cast<Stream *>(data));
+		auto & x = *ptr;
+
+		const auto alias_it = find(system_impl.aliases, engine::Token(x.directory));
+		if (!debug_verify(alias_it != system_impl.aliases.end()))
+			return; // error
+
+		const auto alias_ptr = system_impl.aliases.get<Alias>(alias_it);
+		if (!debug_assert(alias_ptr))
+			return;
+
+		const auto directory_it = find(system_impl.directories, alias_ptr->directory);
+		if (!debug_assert(directory_it != system_impl.directories.end()))
+			return;
+
+		const auto & dirpath = system_impl.get_dirpath(directory_it);
+
+		ful::heap_string_utf8 filepath;
+		if (!debug_verify(ful::append(filepath, dirpath)))
+			return; // error
+
+		if (!debug_verify(ful::append(filepath, x.filepath)))
+			return; // error
+
+		ext::pool_shared_ptr<engine::file::StreamData> data_ptr(utility::in_place, system_impl, std::move(filepath), static_cast<std::uint32_t>(dirpath.size()), x.strand, x.callback, std::move(x.data));
+		if (!debug_verify(data_ptr))
+			return; // error
+
+		if (const Archive * const archive = system_impl.directories.get<Archive>(directory_it))
+		{
+			post_archive_stream(ArchiveStreamWork{std::move(data_ptr), archive->ptr});
+			return;
+		}
+
+		engine::file::post_work(engine::file::StreamWork{std::move(data_ptr)});
+	}
+
+	void process_remove_watch(engine::file::system_impl & system_impl, engine::file::watch_impl & watch_impl, void * data)
 	{
 		auto & x = *static_cast<RemoveWatch *>(data);
 
+		const auto archive_watch_it = ext::find(system_impl.archive_watches, x.id);
+		if (archive_watch_it != system_impl.archive_watches.end())
+		{
+			system_impl.archive_watches.erase(archive_watch_it);
+			return;
+		}
+
 		engine::file::remove_watch(watch_impl, x.id);
 	}
 
@@ -945,10 +2173,21 @@ namespace
 		if (!debug_verify(ful::copy(system_impl.get_dirpath(directory_it), dirpath)))
 			return; // error
 
-		ext::heap_shared_ptr<engine::file::ScanData> call_ptr(utility::in_place, system_impl, std::move(dirpath), x.directory, x.strand, x.callback, std::move(x.data), ful::heap_string_utf8());
+		ext::pool_shared_ptr<engine::file::ScanData> call_ptr(utility::in_place, system_impl, std::move(dirpath), x.directory, x.strand, x.callback, std::move(x.data), ful::heap_string_utf8());
 		if (!debug_verify(call_ptr))
 			return; // error
 
+		if (const Archive * const archive = system_impl.directories.get<Archive>(directory_it))
+		{
+			if (x.mode & engine::file::flags::ADD_WATCH)
+			{
+				debug_verify(system_impl.archive_watches.try_emplace_back(x.id));
+			}
+
+			post_archive_scan(ArchiveScanWork{std::move(call_ptr), archive->ptr, static_cast<bool>(x.mode & engine::file::flags::RECURSE_DIRECTORIES)});
+			return;
+		}
+
 		if (x.mode & engine::file::flags::ADD_WATCH)
 		{
 			engine::file::add_scan_watch(watch_impl, x.id, call_ptr, static_cast<bool>(x.mode & engine::file::flags::RECURSE_DIRECTORIES));
@@ -980,6 +2219,9 @@ namespace
 		if (!debug_assert(directory_it != system_impl.directories.end()))
 			return;
 
+		if (!debug_verify(!system_impl.directories.contains<Archive>(directory_it), "archives are read only"))
+			return; // error
+
 		const auto & dirpath = system_impl.get_dirpath(directory_it);
 
 		ful::heap_string_utf8 filepath;
@@ -989,7 +2231,7 @@ namespace
 		if (!debug_verify(ful::append(filepath, x.filepath)))
 			return; // error
 
-		ext::heap_shared_ptr<engine::file::WriteData> ptr(utility::in_place, system_impl, std::move(filepath), static_cast<std::uint32_t>(dirpath.size()), x.strand, x.callback, std::move(x.data), static_cast<bool>(x.mode & engine::file::flags::APPEND_EXISTING), static_cast<bool>(x.mode & engine::file::flags::OVERWRITE_EXISTING));
+		ext::pool_shared_ptr<engine::file::WriteData> ptr(utility::in_place, system_impl, std::move(filepath), static_cast<std::uint32_t>(dirpath.size()), x.strand, x.callback, std::move(x.data), static_cast<bool>(x.mode & engine::file::flags::APPEND_EXISTING), static_cast<bool>(x.mode & engine::file::flags::OVERWRITE_EXISTING));
 		if (!debug_verify(ptr))
 			return; // error
 
@@ -1025,6 +2267,18 @@ namespace
 			}
 		}
 
+		// the reads that came before the write must not see it, and the
+		// reads that come after it are done the blocking way until it is
+		// done
+#if FILE_SYSTEM_USE_IO_URING
+		if (system_impl.ring.valid())
+		{
+			finish_ring(system_impl);
+		}
+#endif
+		finish_pool(system_impl);
+		system_impl.writes_in_flight.fetch_add(1, std::memory_order_relaxed);
+
 		engine::file::post_work(engine::file::FileWriteWork{std::move(ptr)});
 	}
 
@@ -1041,14 +2295,30 @@ namespace
 
 		engine::file::watch_impl watch_impl;
 
+#if FILE_SYSTEM_USE_IO_URING
+		// the ring is polled for completions, operations started during
+		// a round are submitted together at the end of it
+		struct pollfd fds[3] = {
+			{impl.pipe[0], POLLIN, 0},
+			{watch_impl.fd, POLLIN, 0},
+			{impl.ring.fd(), POLLIN, 0},
+		};
+#else
 		struct pollfd fds[2] = {
 			{impl.pipe[0], POLLIN, 0},
 			{watch_impl.fd, POLLIN, 0},
 		};
+#endif
 
 		while (true)
 		{
-			const int n = ::poll(fds, sizeof fds / sizeof fds[0], -1);
+#if FILE_SYSTEM_USE_IO_URING
+			// the kernel may not have taken everything last round
+			const int timeout = impl.ring.unsubmitted() > 0 ? 1 : -1;
+#else
+			const int timeout = -1;
+#endif
+			const int n = ::poll(fds, sizeof fds / sizeof fds[0], timeout);
 			if (n < 0)
 			{
 				if (debug_verify(errno == EINTR))
@@ -1057,7 +2327,7 @@ namespace
 				return core::async::thread_return{};
 			}
 
-			debug_assert(0 < n, "unexpected timeout");
+			debug_assert(0 < n || timeout >= 0, "unexpected timeout");
 
 			if (!debug_verify((fds[0].revents & ~(POLLIN | POLLHUP)) == 0))
 				return core::async::thread_return{};
@@ -1093,6 +2363,19 @@ namespace
 				engine::file::process_watch(watch_impl);
 			}
 
+#if FILE_SYSTEM_USE_IO_URING
+			if (impl.ring.valid())
+			{
+				process_ring(impl);
+				fiw_unused(impl.ring.submit());
+
+				if (terminate)
+				{
+					finish_ring(impl);
+				}
+			}
+#endif
+
 			if (terminate)
 				return core::async::thread_return{};
 		}
@@ -1133,6 +2416,8 @@ namespace engine
 
 			::close(impl.pipe[0]);
 
+			stop_read_threads(impl);
+
 			destroy_impl(impl);
 		}
 
@@ -1153,6 +2438,13 @@ namespace engine
 
 				impl->strand = root_asset; // the strand ought to be something unique, this is probably good enough
 
+#if FILE_SYSTEM_USE_IO_URING
+				// the ring is optional, without it the read threads do
+				// all of the reads
+				fiw_unused(impl->ring.init(ring_entries));
+#endif
+				start_read_threads(*impl);
+
 				if (!debug_verify(impl->aliases.emplace<Alias>(engine::Token(engine::file::working_directory), engine::Token(root_asset))))
 				{
 					destroy_impl(*impl);
@@ -1171,6 +2463,8 @@ namespace engine
 					::close(impl->pipe[0]);
 					::close(impl->pipe[1]);
 
+					stop_read_threads(*impl);
+
 					destroy_impl(*impl);
 					return nullptr;
 				}
@@ -1192,6 +2486,20 @@ namespace engine
 			}
 		}
 
+		void register_archive(system & system, engine::Hash name, ful::heap_string_utf8 && filepath, engine::Hash parent)
+		{
+			if (!debug_assert(system->thread.valid()))
+				return;
+
+			auto * const ptr = new RegisterArchive{name, std::move(filepath), parent}; // todo
+
+			const Message message{process_register_archive, ptr};
+			if (!debug_verify(ext::write_some_nonzero(system->pipe[1], &message, sizeof message) == sizeof message))
+			{
+				delete ptr;
+			}
+		}
+
 		void register_temporary_directory(system & system, engine::Hash name)
 		{
 			if (!debug_assert(system->thread.valid()))
@@ -1227,7 +2535,7 @@ namespace engine
 			ful::heap_string_utf8 && filepath,
 			engine::Hash strand,
 			read_callback * callback,
-			utility::any && data,
+			engine::task::any && data,
 			flags mode)
 		{
 			if (!debug_assert(system->thread.valid()))
@@ -1258,13 +2566,44 @@ namespace engine
 			}
 		}
 
+		read_statistics get_read_statistics(system & system)
+		{
+			read_statistics statistics;
+			statistics.buffered = system->read_counters.buffered.load(std::memory_order_relaxed);
+			statistics.populated = system->read_counters.populated.load(std::memory_order_relaxed);
+			statistics.mapped = system->read_counters.mapped.load(std::memory_order_relaxed);
+			statistics.ring = system->read_counters.ring.load(std::memory_order_relaxed);
+			statistics.archived = system->read_counters.archived.load(std::memory_order_relaxed);
+			return statistics;
+		}
+
+		void stream(
+			system & system,
+			engine::Hash directory,
+			ful::heap_string_utf8 && filepath,
+			engine::Hash strand,
+			stream_callback * callback,
+			engine::task::any && data)
+		{
+			if (!debug_assert(system->thread.valid()))
+				return;
+
+			auto * const ptr = new Stream{directory, std::move(filepath), strand, callback, std::move(data)}; // todo
+
+			const Message message{process_stream, ptr};
+			if (!debug_verify(ext::write_some_nonzero(system->pipe[1], &message, sizeof message) == sizeof message))
+			{
+				delete ptr;
+			}
+		}
+
 		void scan(
 			system & system,
 			engine::Token id,
 			engine::Hash directory,
 			engine::Hash strand,
 			scan_callback * callback,
-			utility::any && data,
+			engine::task::any && data,
 			flags mode)
 		{
 			if (!debug_assert(system->thread.valid()))
@@ -1285,7 +2624,7 @@ namespace engine
 			ful::heap_string_utf8 && filepath,
 			engine::Hash strand,
 			write_callback * callback,
-			utility::any && data,
+			engine::task::any && data,
 			flags mode)
 		{
 			if (!debug_assert(system->thread.valid()))
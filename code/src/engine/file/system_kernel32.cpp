@@ -25,6 +25,9 @@
 #include "ful/string_search.hpp"
 #include "ful/convert.hpp"
 
+#include <atomic>
+#include <cstdlib>
+#include <memory>
 #include <mutex>
 
 #include <Windows.h>
@@ -103,6 +106,9 @@ namespace engine
 			HANDLE hThread;
 			HANDLE hTerminateEvent;
 
+			// note every file is mapped, the small ones included
+			std::atomic<ext::usize> mapped_reads{0};
+
 			system_impl(config_t && config)
 				: config(static_cast<config_t &&>(config))
 			{}
@@ -226,7 +232,7 @@ namespace
 		}
 	}
 
-	bool read_file(engine::file::system_impl & impl, ful::heap_string_utfw & filepath, std::uint32_t root, engine::file::read_callback * callback, utility::any & data, FILETIME & last_write_time)
+	bool read_file(engine::file::system_impl & impl, ful::heap_string_utfw & filepath, std::uint32_t root, engine::file::read_callback * callback, engine::task::any & data, FILETIME & last_write_time)
 	{
 		HANDLE hFile = ::CreateFileW(filepath.data(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_READONLY, NULL);
 		if (hFile == INVALID_HANDLE_VALUE)
@@ -286,6 +292,8 @@ namespace
 				return false;
 			}
 
+			impl.mapped_reads.fetch_add(1, std::memory_order_relaxed);
+
 			core::content content(ful::cstr_utf8(relpath), file_view, file_size.QuadPart);
 
 			engine::file::system filesystem(impl);
@@ -312,7 +320,72 @@ namespace
 		}
 	}
 
-	bool write_file(engine::file::system_impl & impl, ful::heap_string_utfw & filepath, std::uint32_t root, engine::file::write_callback * callback, utility::any & data, bool append, bool overwrite)
+	struct free_deleter
+	{
+		void operator () (char * p) const { std::free(p); }
+	};
+
+	bool stream_chunks(engine::file::StreamData & stream_data, HANDLE hFile, engine::file::system & filesystem, ful::cstr_utf8 relpath)
+	{
+		LARGE_INTEGER file_size;
+		if (!debug_verify(::GetFileSizeEx(hFile, &file_size) != FALSE, "failed with last error ", ::GetLastError()))
+			return false;
+
+		if (file_size.QuadPart == 0)
+			return false;
+
+		const ext::usize stream_size = stream_data.impl.config.stream_size > 0 ? stream_data.impl.config.stream_size : 1;
+		// note ReadFile reads at most 4 GiB at once
+		const ext::usize max_size = stream_size < MAXDWORD ? stream_size : MAXDWORD;
+		const ext::usize buffer_size = max_size < static_cast<ext::usize>(file_size.QuadPart) ? max_size : static_cast<ext::usize>(file_size.QuadPart);
+
+		std::unique_ptr<char, free_deleter> buffer(static_cast<char *>(std::malloc(buffer_size)));
+		if (!debug_verify(buffer))
+			return false;
+
+		ext::usize offset = 0;
+		do
+		{
+			const ext::usize remaining = static_cast<ext::usize>(file_size.QuadPart) - offset;
+
+			DWORD size;
+			if (!debug_verify(::ReadFile(hFile, buffer.get(), static_cast<DWORD>(buffer_size < remaining ? buffer_size : remaining), &size, nullptr) != FALSE, "failed with last error ", ::GetLastError()))
+				return false;
+
+			// the file got shorter since the stream started
+			if (size == 0)
+				return false;
+
+			core::content chunk(relpath, buffer.get(), size);
+			if (!stream_data.callback(filesystem, chunk, offset, static_cast<ext::usize>(file_size.QuadPart), stream_data.data))
+				break;
+
+			offset += size;
+		}
+		while (offset < static_cast<ext::usize>(file_size.QuadPart));
+
+		return true;
+	}
+
+	bool stream_file(engine::file::StreamData & stream_data, engine::file::system & filesystem, ful::cstr_utf8 relpath)
+	{
+		// makes the system read ahead further than it normally would
+		HANDLE hFile = ::CreateFileW(stream_data.filepath.data(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_READONLY | FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+		if (hFile == INVALID_HANDLE_VALUE)
+		{
+			const auto error = ::GetLastError();
+			debug_informw(hFile != INVALID_HANDLE_VALUE, L"CreateFileW(\"", stream_data.filepath, L"\") failed with last error ", error);
+			return false;
+		}
+
+		const bool streamed = stream_chunks(stream_data, hFile, filesystem, relpath);
+
+		debug_verify(::CloseHandle(hFile) != FALSE, "failed with last error ", ::GetLastError());
+
+		return streamed;
+	}
+
+	bool write_file(engine::file::system_impl & impl, ful::heap_string_utfw & filepath, std::uint32_t root, engine::file::write_callback * callback, engine::task::any & data, bool append, bool overwrite)
 	{
 		DWORD dwCreationDisposition = CREATE_NEW;
 		DWORD dwDesiredAccess = GENERIC_WRITE;
@@ -550,7 +623,7 @@ namespace engine
 			engine::task::post_work(
 				taskscheduler,
 				strand,
-				[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, utility::any && data)
+				[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, engine::task::any && data)
 			{
 				if (debug_assert(data.type_id() == utility::type_id<FileMissingWork>()))
 				{
@@ -576,7 +649,7 @@ namespace engine
 					filesystem.detach();
 				}
 			},
-				utility::any(std::move(data)));
+				engine::task::any(std::move(data)));
 		}
 
 		void post_work(FileReadWork && data)
@@ -587,7 +660,7 @@ namespace engine
 			engine::task::post_work(
 				taskscheduler,
 				strand,
-				[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, utility::any && data)
+				[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, engine::task::any && data)
 			{
 				if (debug_assert(data.type_id() == utility::type_id<FileReadWork>()))
 				{
@@ -619,7 +692,43 @@ namespace engine
 					}
 				}
 			},
-				utility::any(std::move(data)));
+				engine::task::any(std::move(data)));
+		}
+
+		void post_work(StreamWork && data)
+		{
+			engine::task::scheduler & taskscheduler = *data.ptr->impl.taskscheduler;
+			engine::Hash strand = data.ptr->strand;
+
+			// note the whole stream is done in one task, as the strand
+			// must not let any writes in between the chunks
+			engine::task::post_work(
+				taskscheduler,
+				strand,
+				[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, engine::task::any && data)
+			{
+				if (debug_assert(data.type_id() == utility::type_id<StreamWork>()))
+				{
+					StreamWork && work = utility::any_cast<StreamWork &&>(std::move(data));
+					engine::file::StreamData & stream_data = *work.ptr;
+
+					ful::heap_string_utf8 relpath;
+					if (!debug_verify(convert(stream_data.filepath.data() + stream_data.root, stream_data.filepath.data() + stream_data.filepath.size(), relpath)))
+						return; // error
+
+					core::file::backslash_to_slash(relpath);
+
+					engine::file::system filesystem(stream_data.impl);
+					if (!stream_file(stream_data, filesystem, ful::cstr_utf8(relpath)))
+					{
+						core::content chunk((ful::cstr_utf8)relpath);
+
+						fiw_unused(stream_data.callback(filesystem, chunk, 0, 0, stream_data.data));
+					}
+					filesystem.detach();
+				}
+			},
+				engine::task::any(std::move(data)));
 		}
 
 		void post_work(ScanChangeWork && data)
@@ -630,7 +739,7 @@ namespace engine
 			engine::task::post_work(
 				taskscheduler,
 				strand,
-				[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, utility::any && data)
+				[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, engine::task::any && data)
 			{
 				if (debug_assert(data.type_id() == utility::type_id<ScanChangeWork>()))
 				{
@@ -677,7 +786,7 @@ namespace engine
 					filesystem.detach();
 				}
 			},
-				utility::any(std::move(data)));
+				engine::task::any(std::move(data)));
 		}
 
 		void post_work(ScanOnceWork && data)
@@ -688,7 +797,7 @@ namespace engine
 			engine::task::post_work(
 				taskscheduler,
 				strand,
-				[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, utility::any && data)
+				[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, engine::task::any && data)
 			{
 				if (debug_assert(data.type_id() == utility::type_id<ScanOnceWork>()))
 				{
@@ -716,7 +825,7 @@ namespace engine
 					filesystem.detach();
 				}
 			},
-				utility::any(std::move(data)));
+				engine::task::any(std::move(data)));
 		}
 
 		void post_work(ScanRecursiveWork && data)
@@ -727,7 +836,7 @@ namespace engine
 			engine::task::post_work(
 				taskscheduler,
 				strand,
-				[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, utility::any && data)
+				[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, engine::task::any && data)
 			{
 				if (debug_assert(data.type_id() == utility::type_id<ScanRecursiveWork>()))
 				{
@@ -755,7 +864,7 @@ namespace engine
 					filesystem.detach();
 				}
 			},
-				utility::any(std::move(data)));
+				engine::task::any(std::move(data)));
 		}
 
 		void post_work(FileWriteWork && data)
@@ -766,7 +875,7 @@ namespace engine
 			engine::task::post_work(
 				taskscheduler,
 				strand,
-				[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, utility::any && data)
+				[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, engine::task::any && data)
 			{
 				if (debug_assert(data.type_id() == utility::type_id<FileWriteWork>()))
 				{
@@ -792,7 +901,7 @@ namespace engine
 					}
 				}
 			},
-				utility::any(std::move(data)));
+				engine::task::any(std::move(data)));
 		}
 	}
 }
@@ -968,7 +1077,7 @@ namespace
 		ful::heap_string_utf8 filepath;
 		engine::Hash strand;
 		engine::file::read_callback * callback;
-		utility::any data;
+		engine::task::any data;
 		engine::file::flags mode;
 
 		static void NTAPI Callback(ULONG_PTR Parameter)
@@ -999,7 +1108,7 @@ namespace
 
 			core::file::slash_to_backslash(filepath.begin() + dirpath.size(), filepath.end());
 
-			ext::heap_shared_ptr<engine::file::ReadData> ptr(utility::in_place, x.impl, std::move(filepath), static_cast<std::uint32_t>(dirpath.size()), x.strand, x.callback, std::move(x.data), FILETIME{});
+			ext::pool_shared_ptr<engine::file::ReadData> ptr(utility::in_place, x.impl, std::move(filepath), static_cast<std::uint32_t>(dirpath.size()), x.strand, x.callback, std::move(x.data), FILETIME{});
 			if (!debug_verify(ptr))
 				return; // error
 
@@ -1012,6 +1121,51 @@ namespace
 		}
 	};
 
+	struct ProcessStream
+	{
+		engine::file::system_impl & impl;
+		engine::Hash directory;
+		ful::heap_string_utf8 filepath;
+		engine::Hash strand;
+		engine::file::stream_callback * callback;
+		engine::task::any data;
+
+		static void NTAPI Callback(ULONG_PTR Parameter)
+		{
+			std::unique_ptr<ProcessStream> data(reinterpret_cast<ProcessStream *>(Parameter));
+			ProcessStream & x = *data;
+
+			const auto alias_it = find(x.impl.aliases, engine::Token(x.directory));
+			if (!debug_verify(alias_it != x.impl.aliases.end()))
+				return; // error
+
+			const auto alias_ptr = x.impl.aliases.get<Alias>(alias_it);
+			if (!debug_assert(alias_ptr))
+				return;
+
+			const auto directory_it = find(x.impl.directories, alias_ptr->directory);
+			if (!debug_assert(directory_it != x.impl.directories.end()))
+				return;
+
+			const auto & dirpath = x.impl.get_dirpath(directory_it);
+
+			ful::heap_string_utfw filepath;
+			if (!debug_verify(ful::append(filepath, dirpath)))
+				return; // error
+
+			if (!debug_verify(convert(x.filepath, filepath)))
+				return; // error
+
+			core::file::slash_to_backslash(filepath.begin() + dirpath.size(), filepath.end());
+
+			ext::pool_shared_ptr<engine::file::StreamData> ptr(utility::in_place, x.impl, std::move(filepath), static_cast<std::uint32_t>(dirpath.size()), x.strand, x.callback, std::move(x.data));
+			if (!debug_verify(ptr))
+				return; // error
+
+			engine::file::post_work(engine::file::StreamWork{std::move(ptr)});
+		}
+	};
+
 	struct ProcessRemoveWatch
 	{
 		engine::file::system_impl & impl;
@@ -1033,7 +1187,7 @@ namespace
 		engine::Hash directory;
 		engine::Hash strand;
 		engine::file::scan_callback * callback;
-		utility::any data;
+		engine::task::any data;
 		engine::file::flags mode;
 
 		static void NTAPI Callback(ULONG_PTR Parameter)
@@ -1057,7 +1211,7 @@ namespace
 			if (!debug_verify(ful::copy(x.impl.get_dirpath(directory_it), dirpath)))
 				return; // error
 
-			ext::heap_shared_ptr<engine::file::ScanData> ptr(utility::in_place, x.impl, std::move(dirpath), x.directory, x.strand, x.callback, std::move(x.data), ful::heap_string_utfw());
+			ext::pool_shared_ptr<engine::file::ScanData> ptr(utility::in_place, x.impl, std::move(dirpath), x.directory, x.strand, x.callback, std::move(x.data), ful::heap_string_utfw());
 			if (!debug_verify(ptr))
 				return; // error
 
@@ -1084,7 +1238,7 @@ namespace
 		ful::heap_string_utf8 filepath;
 		engine::Hash strand;
 		engine::file::write_callback * callback;
-		utility::any data;
+		engine::task::any data;
 		engine::file::flags mode;
 
 		static void NTAPI Callback(ULONG_PTR Parameter)
@@ -1115,7 +1269,7 @@ namespace
 
 			core::file::slash_to_backslash(filepath.begin() + dirpath.size(), filepath.end());
 
-			ext::heap_shared_ptr<engine::file::WriteData> ptr(utility::in_place, x.impl, std::move(filepath), static_cast<std::uint32_t>(dirpath.size()), x.strand, x.callback, std::move(x.data), static_cast<bool>(x.mode & engine::file::flags::APPEND_EXISTING), static_cast<bool>(x.mode & engine::file::flags::OVERWRITE_EXISTING));
+			ext::pool_shared_ptr<engine::file::WriteData> ptr(utility::in_place, x.impl, std::move(filepath), static_cast<std::uint32_t>(dirpath.size()), x.strand, x.callback, std::move(x.data), static_cast<bool>(x.mode & engine::file::flags::APPEND_EXISTING), static_cast<bool>(x.mode & engine::file::flags::OVERWRITE_EXISTING));
 			if (!debug_verify(ptr))
 				return; // error
 
@@ -1282,6 +1436,15 @@ namespace engine
 			try_queue_apc<ProcessRegisterTemporaryDirectory>(system->hThread, *system, name);
 		}
 
+		void register_archive(
+			system & /*system*/,
+			engine::Hash /*name*/,
+			ful::heap_string_utf8 && debug_expression(filepath),
+			engine::Hash /*parent*/)
+		{
+			debug_printline("register_archive(\"", filepath, "\") is not supported yet");
+		}
+
 		void unregister_directory(
 			system & system,
 			engine::Hash name)
@@ -1296,7 +1459,7 @@ namespace engine
 			ful::heap_string_utf8 && filepath,
 			engine::Hash strand,
 			read_callback * callback,
-			utility::any && data,
+			engine::task::any && data,
 			flags mode)
 		{
 			try_queue_apc<ProcessRead>(system->hThread, *system, id, directory, std::move(filepath), strand, callback, std::move(data), mode);
@@ -1309,13 +1472,31 @@ namespace engine
 			try_queue_apc<ProcessRemoveWatch>(system->hThread, *system, id);
 		}
 
+		read_statistics get_read_statistics(system & system)
+		{
+			read_statistics statistics;
+			statistics.mapped = system->mapped_reads.load(std::memory_order_relaxed);
+			return statistics;
+		}
+
+		void stream(
+			system & system,
+			engine::Hash directory,
+			ful::heap_string_utf8 && filepath,
+			engine::Hash strand,
+			stream_callback * callback,
+			engine::task::any && data)
+		{
+			try_queue_apc<ProcessStream>(system->hThread, *system, directory, std::move(filepath), strand, callback, std::move(data));
+		}
+
 		void scan(
 			system & system,
 			engine::Token id,
 			engine::Hash directory,
 			engine::Hash strand,
 			scan_callback * callback,
-			utility::any && data,
+			engine::task::any && data,
 			flags mode)
 		{
 			try_queue_apc<ProcessScan>(system->hThread, *system, id, directory, strand, callback, std::move(data), mode);
@@ -1327,7 +1508,7 @@ namespace engine
 			ful::heap_string_utf8 && filepath,
 			engine::Hash strand,
 			write_callback * callback,
-			utility::any && data,
+			engine::task::any && data,
 			flags mode)
 		{
 			try_queue_apc<ProcessWrite>(system->hThread, *system, directory, std::move(filepath), strand, callback, std::move(data), mode);
@@ -26,17 +26,17 @@ namespace
 
 	struct ReadWatch
 	{
-		ext::heap_shared_ptr<engine::file::ReadData> ptr;
+		ext::pool_shared_ptr<engine::file::ReadData> ptr;
 	};
 
 	struct ScanWatch
 	{
-		ext::heap_shared_ptr<engine::file::ScanData> ptr;
+		ext::pool_shared_ptr<engine::file::ScanData> ptr;
 	};
 
 	struct ScanRecursiveWatch
 	{
-		ext::heap_shared_ptr<engine::file::ScanData> ptr;
+		ext::pool_shared_ptr<engine::file::ScanData> ptr;
 	};
 
 	core::container::Collection
@@ -51,10 +51,10 @@ namespace
 
 	struct Directory
 	{
-		utility::heap_vector<ful::view_utf8, ext::heap_shared_ptr<engine::file::ReadData>> reads;
-		utility::heap_vector<ful::view_utf8, ext::heap_shared_ptr<engine::file::ReadData>> missing_reads;
-		utility::heap_vector<ext::heap_shared_ptr<engine::file::ScanData>> scans;
-		utility::heap_vector<ext::heap_shared_ptr<engine::file::ScanData>> recursive_scans;
+		utility::heap_vector<ful::view_utf8, ext::pool_shared_ptr<engine::file::ReadData>> reads;
+		utility::heap_vector<ful::view_utf8, ext::pool_shared_ptr<engine::file::ReadData>> missing_reads;
+		utility::heap_vector<ext::pool_shared_ptr<engine::file::ScanData>> scans;
+		utility::heap_vector<ext::pool_shared_ptr<engine::file::ScanData>> recursive_scans;
 
 		ful::heap_string_utf8 filepath;
 
@@ -308,7 +308,7 @@ namespace
 		}
 	}
 
-	void add_recursive_scan(ful::view_utf8 filepath, fd_t notify_fd, const ext::heap_shared_ptr<engine::file::ScanData> & ptr)
+	void add_recursive_scan(ful::view_utf8 filepath, fd_t notify_fd, const ext::pool_shared_ptr<engine::file::ScanData> & ptr)
 	{
 		ful::heap_string_utf8 pattern;
 		if (!debug_verify(ful::append(pattern, filepath)))
@@ -380,7 +380,7 @@ namespace
 		}
 	}
 
-	void process_add_read(fd_t notify_fd, engine::Token watch_id, ext::heap_shared_ptr<engine::file::ReadData> && ptr, bool report_missing)
+	void process_add_read(fd_t notify_fd, engine::Token watch_id, ext::pool_shared_ptr<engine::file::ReadData> && ptr, bool report_missing)
 	{
 		if (!debug_verify(watches.emplace<ReadWatch>(watch_id, ptr)))
 			return;
@@ -411,7 +411,7 @@ namespace
 		}
 	}
 
-	void process_add_scan(fd_t notify_fd, engine::Token watch_id, ext::heap_shared_ptr<engine::file::ScanData> && ptr, bool recurse_directories)
+	void process_add_scan(fd_t notify_fd, engine::Token watch_id, ext::pool_shared_ptr<engine::file::ScanData> && ptr, bool recurse_directories)
 	{
 		if (recurse_directories)
 		{
@@ -787,12 +787,12 @@ namespace engine
 			process_notifications(impl.fd);
 		}
 
-		void add_file_watch(watch_impl & impl, engine::Token id, ext::heap_shared_ptr<ReadData> ptr, bool report_missing)
+		void add_file_watch(watch_impl & impl, engine::Token id, ext::pool_shared_ptr<ReadData> ptr, bool report_missing)
 		{
 			process_add_read(impl.fd, id, std::move(ptr), report_missing);
 		}
 
-		void add_scan_watch(watch_impl & impl, engine::Token id, ext::heap_shared_ptr<ScanData> ptr, bool recurse_directories)
+		void add_scan_watch(watch_impl & impl, engine::Token id, ext::pool_shared_ptr<ScanData> ptr, bool recurse_directories)
 		{
 			process_add_scan(impl.fd, id, std::move(ptr), recurse_directories);
 		}
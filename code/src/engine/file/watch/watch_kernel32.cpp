@@ -30,12 +30,12 @@ namespace
 {
 	struct ReadWatch
 	{
-		ext::heap_shared_ptr<engine::file::ReadData> ptr;
+		ext::pool_shared_ptr<engine::file::ReadData> ptr;
 	};
 
 	struct ScanWatch
 	{
-		ext::heap_shared_ptr<engine::file::ScanData> ptr;
+		ext::pool_shared_ptr<engine::file::ScanData> ptr;
 		bool recurse_directories;
 	};
 
@@ -53,9 +53,9 @@ namespace
 	{
 		OVERLAPPED overlapped;
 
-		utility::heap_vector<ful::view_utfw, ext::heap_shared_ptr<engine::file::ReadData>> reads;
-		utility::heap_vector<ful::view_utfw, ext::heap_shared_ptr<engine::file::ReadData>> missing_reads;
-		utility::heap_vector<ext::heap_shared_ptr<engine::file::ScanData>> scans;
+		utility::heap_vector<ful::view_utfw, ext::pool_shared_ptr<engine::file::ReadData>> reads;
+		utility::heap_vector<ful::view_utfw, ext::pool_shared_ptr<engine::file::ReadData>> missing_reads;
+		utility::heap_vector<ext::pool_shared_ptr<engine::file::ScanData>> scans;
 
 		ful::heap_string_utfw filepath;
 
@@ -390,7 +390,7 @@ namespace engine
 		watch_impl::watch_impl()
 		{}
 
-		void add_file_watch(engine::file::watch_impl & /*impl*/, engine::Token id, ext::heap_shared_ptr<ReadData> ptr, bool report_missing)
+		void add_file_watch(engine::file::watch_impl & /*impl*/, engine::Token id, ext::pool_shared_ptr<ReadData> ptr, bool report_missing)
 		{
 			if (!debug_verify(watches.emplace<ReadWatch>(id, ptr)))
 				return;
@@ -421,7 +421,7 @@ namespace engine
 			}
 		}
 
-		void add_scan_watch(engine::file::watch_impl & /*impl*/, engine::Token id, ext::heap_shared_ptr<ScanData> ptr, bool recurse_directories)
+		void add_scan_watch(engine::file::watch_impl & /*impl*/, engine::Token id, ext::pool_shared_ptr<ScanData> ptr, bool recurse_directories)
 		{
 			if (!debug_verify(watches.emplace<ScanWatch>(id, ptr, recurse_directories)))
 				return;
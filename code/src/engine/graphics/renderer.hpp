@@ -11,6 +11,7 @@
 #include "engine/model/data.hpp"
 #include "engine/Token.hpp"
 
+#include "utility/anyfwd.hpp"
 #include "utility/container/vector.hpp"
 #include "utility/optional.hpp"
 
@@ -24,11 +25,6 @@ namespace engine
 	}
 }
 
-namespace utility
-{
-	class any;
-}
-
 namespace engine
 {
 	namespace graphics
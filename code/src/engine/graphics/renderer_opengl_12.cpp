@@ -25,6 +25,7 @@
 #include "engine/HashTable.hpp"
 
 #include "utility/any.hpp"
+#include "utility/frame_allocator.hpp"
 #include "utility/profiling.hpp"
 #include "utility/ranges.hpp"
 #include "utility/variant.hpp"
@@ -1282,6 +1283,10 @@ namespace engine
 					while (active.load(std::memory_order_relaxed))
 					{
 						render_update();
+						// note nothing allocated during the frame is still
+						// alive, so the arena of the render thread is free
+						// to be reused by the next one
+						utility::frame_arena::this_thread().reset();
 
 						event.wait();
 						event.reset();
@@ -31,6 +31,7 @@
 #include "utility/algorithm/find.hpp"
 #include "utility/any.hpp"
 #include "utility/container/vector.hpp"
+#include "utility/frame_allocator.hpp"
 #include "utility/functional/utility.hpp"
 #include "utility/lookup_table.hpp"
 #include "utility/profiling.hpp"
@@ -2008,6 +2009,10 @@ namespace engine
 					while (active.load(std::memory_order_relaxed))
 					{
 						render_update();
+						// note nothing allocated during the frame is still
+						// alive, so the arena of the render thread is free
+						// to be reused by the next one
+						utility::frame_arena::this_thread().reset();
 
 						event.wait();
 						event.reset();
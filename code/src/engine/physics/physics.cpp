@@ -244,7 +244,11 @@ namespace physics
 					if (!debug_assert(find(objects, x.entity) != objects.end()))
 						return; // error
 
-					fiw_unused(debug_verify(objects.emplace<object_t>(x.entity, std::move(x.transform.pos), std::move(x.transform.quat))));
+					object_t * const object = objects.emplace<object_t>(x.entity, std::move(x.transform.pos), std::move(x.transform.quat));
+					if (debug_verify(object))
+					{
+						objects.mark_changed(*object);
+					}
 				}
 				void operator () (MessageRemove && x)
 				{
@@ -261,6 +265,7 @@ namespace physics
 						return; // error
 
 					objects.call(object_it, update_movement{std::move(x.movement.vec)});
+					objects.mark_changed<object_t>(object_it);
 				}
 				void operator () (MessageUpdateOrientationMovement && x)
 				{
@@ -269,6 +274,7 @@ namespace physics
 						return; // error
 
 					objects.call(object_it, update_orientation_movement{std::move(x.movement.quaternion)});
+					objects.mark_changed<object_t>(object_it);
 				}
 				void operator () (MessageUpdateTransform && x)
 				{
@@ -277,6 +283,7 @@ namespace physics
 						return; // error
 
 					objects.call(object_it, update_transform{std::move(x.transform)});
+					objects.mark_changed<object_t>(object_it);
 				}
 			};
 			visit(ProcessMessage{}, std::move(entity_message));
@@ -288,11 +295,14 @@ namespace physics
 
 	void update_finish(simulation &)
 	{
-		for (const auto & object : objects.get<object_t>())
+		// objects only move when told to, so most of them are the
+		// same as last frame
+		objects.for_each_changed<object_t>([](engine::Token entity, const object_t & object)
 		{
 			auto matrix = make_translation_matrix(object.position) * make_matrix(object.orientation);
-			post_update_modelviewmatrix(*::renderer, objects.get_key(object), engine::graphics::data::ModelviewMatrix{std::move(matrix)});
-		}
+			post_update_modelviewmatrix(*::renderer, entity, engine::graphics::data::ModelviewMatrix{std::move(matrix)});
+		});
+		objects.clear_changed<object_t>();
 	}
 
 	void post_add_object(simulation &, engine::Token entity, engine::transform_t && data)
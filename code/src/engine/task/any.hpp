@@ -0,0 +1,13 @@
+#pragma once
+
+#include "utility/anyfwd.hpp"
+
+namespace engine
+{
+	namespace task
+	{
+		// the data that goes along with work, most of what is posted
+		// fits inline and the whole thing still fits in a cache line
+		using any = utility::basic_any<56>;
+	}
+}
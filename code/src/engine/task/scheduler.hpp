@@ -2,13 +2,13 @@
 
 #include "engine/Hash.hpp"
 #include "engine/module.hpp"
+#include "engine/task/any.hpp"
 
 #include "utility/ext/stddef.hpp"
+#include "utility/span.hpp"
 
-namespace utility
-{
-	class any;
-}
+#include <cstdint>
+#include <utility>
 
 namespace engine
 {
@@ -27,12 +27,235 @@ namespace engine
 		using work_callback = void(
 			scheduler & scheduler,
 			engine::Hash strand,
-			utility::any && data);
+			engine::task::any && data);
+
+		enum class priority
+		{
+			interactive,
+			normal,
+			background,
+		};
+
+		constexpr int priority_count = 3;
 
+		constexpr int no_deadline = -1;
+
+		/**
+		 * Works posted on the same strand are called one at a time and in
+		 * the order they were posted, works on different strands (and
+		 * works on the empty strand) may be called at the same time.
+		 *
+		 * Works of a higher priority are generally called before works of
+		 * a lower priority, but every so often the lower priorities are
+		 * given a turn so that they are not starved. A work that is still
+		 * waiting when its deadline (in milliseconds, counted from when it
+		 * is posted) runs out is called before anything else.
+		 *
+		 * A strand is scheduled as its most urgent work, so a work that is
+		 * posted behind lower priority works on the same strand still has
+		 * to wait for them.
+		 */
 		void post_work(
+			scheduler & scheduler,
+			engine::Hash strand,
+			priority priority,
+			int deadline,
+			work_callback * workcall,
+			engine::task::any && data);
+
+		inline void post_work(
+			scheduler & scheduler,
+			engine::Hash strand,
+			priority priority,
+			work_callback * workcall,
+			engine::task::any && data)
+		{
+			post_work(scheduler, strand, priority, no_deadline, workcall, std::move(data));
+		}
+
+		inline void post_work(
 			scheduler & scheduler,
 			engine::Hash strand,
 			work_callback * workcall,
-			utility::any && data);
+			engine::task::any && data)
+		{
+			post_work(scheduler, strand, priority::normal, no_deadline, workcall, std::move(data));
+		}
+
+		using timer_callback = void(
+			scheduler & scheduler,
+			engine::Hash strand,
+			engine::task::any & data);
+
+		/**
+		 * Identifies a delayed or periodic work, zero is never used.
+		 */
+		enum class timer_id : std::uint64_t {};
+
+		/**
+		 * Posts the work after delay milliseconds, with normal priority.
+		 */
+		timer_id post_work_after(
+			scheduler & scheduler,
+			engine::Hash strand,
+			int delay,
+			work_callback * workcall,
+			engine::task::any && data);
+
+		/**
+		 * Calls the work every interval milliseconds, with normal priority,
+		 * until it is cancelled. The next interval starts when the call
+		 * returns so calls never overlap, and the data is kept between
+		 * them.
+		 */
+		timer_id post_work_every(
+			scheduler & scheduler,
+			engine::Hash strand,
+			int interval,
+			timer_callback * timercall,
+			engine::task::any && data);
+
+		/**
+		 * Returns false if there is no such timer, e.g. if it is a
+		 * delayed work that has already been posted.
+		 */
+		bool cancel_timer(
+			scheduler & scheduler,
+			timer_id timer);
+
+		struct priority_stats
+		{
+			ext::usize posted;
+			ext::usize called;
+			// the number of works that were called after their deadline
+			// had run out
+			ext::usize promoted;
+
+			// the time between a work being posted and it being called
+			ext::usize total_wait_microseconds;
+			ext::usize max_wait_microseconds;
+		};
+
+		priority_stats get_stats(
+			const scheduler & scheduler,
+			priority priority);
+
+		using range_callback = void(
+			scheduler & scheduler,
+			ext::usize begin,
+			ext::usize end,
+			void * data);
+
+		struct fork_data;
+
+		/**
+		 * Frees a range that is never joined, without waiting for it.
+		 */
+		void abandon(
+			fork_data * data);
+
+		/**
+		 * Refers to a range started by `fork_range`, it must be passed to
+		 * `join` before the data given to `fork_range` goes away.
+		 *
+		 * A handle that is destroyed without being joined abandons the
+		 * range, whose chunks might then not all be called.
+		 */
+		class join_handle
+		{
+		private:
+
+			fork_data * data_ = nullptr;
+
+		public:
+
+			~join_handle()
+			{
+				if (data_)
+				{
+					abandon(data_);
+				}
+			}
+			join_handle() = default;
+
+			explicit join_handle(fork_data * data)
+				: data_(data)
+			{}
+
+			join_handle(join_handle && other)
+				: data_(std::exchange(other.data_, nullptr))
+			{}
+
+			join_handle & operator = (join_handle && other)
+			{
+				std::swap(data_, other.data_);
+
+				return *this;
+			}
+
+		public:
+
+			explicit operator bool () const { return data_ != nullptr; }
+
+			fork_data * release() { return std::exchange(data_, nullptr); }
+		};
+
+		/**
+		 * Splits [0, count) into chunks of (at most) grain indices and
+		 * calls the callback once for each chunk, possibly at the same
+		 * time on different threads.
+		 */
+		join_handle fork_range(
+			scheduler & scheduler,
+			ext::usize count,
+			ext::usize grain,
+			range_callback * callback,
+			void * data);
+
+		/**
+		 * Blocks until every chunk of the range has been called, the
+		 * calling thread helps out by calling chunks that have not yet
+		 * been picked up by a worker.
+		 */
+		void join(
+			scheduler & scheduler,
+			join_handle && handle);
+
+		/**
+		 * Calls func with consecutive subspans of (at most) grain values
+		 * that together cover the span, and returns when all of them are
+		 * done.
+		 *
+		 * Subspans may be processed at the same time on different threads.
+		 */
+		template <typename T, typename F>
+		void parallel_for(
+			scheduler & scheduler,
+			utility::span<T> span,
+			ext::usize grain,
+			F && func)
+		{
+			struct Data
+			{
+				utility::span<T> span;
+				F & func;
+			};
+
+			Data data{span, func};
+
+			join(
+				scheduler,
+				fork_range(
+					scheduler,
+					span.size(),
+					grain,
+					[](engine::task::scheduler & /*scheduler*/, ext::usize begin, ext::usize end, void * data)
+					{
+						Data & d = *static_cast<Data *>(data);
+
+						d.func(utility::subspan(d.span, begin, end - begin));
+					},
+					&data));
+		}
 	}
 }
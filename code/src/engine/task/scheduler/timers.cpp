@@ -0,0 +1,136 @@
+#include "core/debug.hpp"
+
+#include "engine/task/scheduler/timers.hpp"
+
+#include <mutex>
+
+namespace engine
+{
+	namespace task
+	{
+		timer_id timers::add(engine::Hash strand, int delay, work_callback * workcall, engine::task::any && data)
+		{
+			return add(delay, Timer{strand, workcall, nullptr, 0, std::move(data)});
+		}
+
+		timer_id timers::add_periodic(engine::Hash strand, int interval, timer_callback * timercall, engine::task::any && data)
+		{
+			return add(interval, Timer{strand, nullptr, timercall, interval, std::move(data)});
+		}
+
+		bool timers::cancel(timer_id timer)
+		{
+			std::lock_guard<utility::spinlock> guard(lock_);
+
+			return wheel_.erase(to_handle(timer));
+		}
+
+		uint64_t timers::advance(scheduler_impl & impl)
+		{
+			std::lock_guard<utility::spinlock> guard(lock_);
+
+			wheel_.advance(current_tick() - wheel_.now(), [this, &impl](TimerWheel::Handle handle, Timer & timer){ fire(impl, handle, timer); });
+
+			const uint64_t ticks = wheel_.ticks_until_next();
+			wakeup_ = ticks == uint64_t(-1) ? ticks : wheel_.now() + ticks;
+
+			return ticks;
+		}
+
+		timer_id timers::add(int delay, Timer && timer)
+		{
+			std::lock_guard<utility::spinlock> guard(lock_);
+
+			const uint64_t ticks = delay_ticks(delay);
+
+			const TimerWheel::Handle handle = wheel_.insert(ticks, std::move(timer));
+			if (!debug_verify(handle))
+				return timer_id{};
+
+			wake(wheel_.now() + ticks);
+
+			return to_timer_id(handle);
+		}
+
+		timer_id timers::to_timer_id(TimerWheel::Handle handle)
+		{
+			return static_cast<timer_id>(uint64_t(handle.generation) << 32 | handle.index);
+		}
+
+		timers::TimerWheel::Handle timers::to_handle(timer_id timer)
+		{
+			const uint64_t value = static_cast<uint64_t>(timer);
+
+			return TimerWheel::Handle{static_cast<uint32_t>(value), static_cast<uint32_t>(value >> 32)};
+		}
+
+		uint64_t timers::current_tick() const
+		{
+			return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_).count());
+		}
+
+		uint64_t timers::delay_ticks(int delay) const
+		{
+			// the wheel may lag behind the clock
+			return current_tick() - wheel_.now() + static_cast<uint64_t>(delay > 0 ? delay : 0);
+		}
+
+		void timers::wake(uint64_t expiry)
+		{
+			if (expiry < wakeup_)
+			{
+				wakeup_ = expiry;
+				wakecall_(wake_data_);
+			}
+		}
+
+		void timers::fire(scheduler_impl & impl, TimerWheel::Handle handle, Timer & timer)
+		{
+			engine::task::scheduler scheduler(impl);
+
+			if (timer.timercall)
+			{
+				post_work(scheduler, timer.strand, call_period, engine::task::any(utility::in_place_type<Period>, this, handle, timer.timercall, timer.interval, std::move(timer.data)));
+			}
+			else
+			{
+				post_work(scheduler, timer.strand, timer.workcall, std::move(timer.data));
+
+				wheel_.erase(handle);
+			}
+
+			scheduler.detach();
+		}
+
+		void timers::call_period(scheduler & scheduler, engine::Hash strand, engine::task::any && data)
+		{
+			Period * const period = utility::any_cast<Period>(&data);
+			if (!debug_assert(period))
+				return;
+
+			timers & self = *period->self;
+
+			{
+				std::lock_guard<utility::spinlock> guard(self.lock_);
+
+				if (!self.wheel_.find(period->handle))
+					return; // cancelled
+			}
+
+			period->timercall(scheduler, strand, period->data);
+
+			std::lock_guard<utility::spinlock> guard(self.lock_);
+
+			Timer * const timer = self.wheel_.find(period->handle);
+			if (!timer)
+				return; // cancelled
+
+			timer->data = std::move(period->data);
+
+			const uint64_t ticks = self.delay_ticks(period->interval);
+			self.wheel_.reschedule(period->handle, ticks);
+
+			self.wake(self.wheel_.now() + ticks);
+		}
+	}
+}
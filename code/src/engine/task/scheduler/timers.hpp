@@ -0,0 +1,95 @@
+#pragma once
+
+#include "core/container/TimerWheel.hpp"
+
+#include "engine/task/scheduler.hpp"
+
+#include "utility/any.hpp"
+#include "utility/spinlock.hpp"
+
+#include <chrono>
+#include <cstdint>
+
+namespace engine
+{
+	namespace task
+	{
+		// the delayed and periodic works of a scheduler, the wheel ticks
+		// once every millisecond
+		//
+		// the backend has a thread of its own call `advance` and then
+		// sleep for as long as it is told to, `wake` is called (with the
+		// lock held) when a timer is added that expires before that
+		class timers
+		{
+		public:
+			using wake_callback = void(void * data);
+
+		private:
+			struct Timer
+			{
+				engine::Hash strand;
+				work_callback * workcall;
+				timer_callback * timercall;
+				int interval;
+				engine::task::any data;
+			};
+
+			using TimerWheel = core::container::TimerWheel<Timer>;
+
+			// the periodic timer stays in the wheel while it is being
+			// called, but its data is moved out and back again
+			struct Period
+			{
+				timers * self;
+				TimerWheel::Handle handle;
+				timer_callback * timercall;
+				int interval;
+				engine::task::any data;
+			};
+
+		private:
+			utility::spinlock lock_;
+			TimerWheel wheel_;
+			// the tick at which the waiting thread will wake up
+			uint64_t wakeup_ = uint64_t(-1);
+			std::chrono::steady_clock::time_point start_ = std::chrono::steady_clock::now();
+
+			wake_callback * wakecall_;
+			void * wake_data_;
+
+		public:
+			timers(wake_callback * wakecall, void * wake_data)
+				: wakecall_(wakecall)
+				, wake_data_(wake_data)
+			{}
+
+		public:
+			timer_id add(engine::Hash strand, int delay, work_callback * workcall, engine::task::any && data);
+			timer_id add_periodic(engine::Hash strand, int interval, timer_callback * timercall, engine::task::any && data);
+
+			bool cancel(timer_id timer);
+
+			// posts the works whose timers have expired, returns the
+			// number of ticks until it needs to be called again, or -1
+			// if there are no timers
+			uint64_t advance(scheduler_impl & impl);
+
+		private:
+			timer_id add(int delay, Timer && timer);
+
+			static timer_id to_timer_id(TimerWheel::Handle handle);
+			static TimerWheel::Handle to_handle(timer_id timer);
+
+			uint64_t current_tick() const;
+			// assumes the lock is held
+			uint64_t delay_ticks(int delay) const;
+			// assumes the lock is held
+			void wake(uint64_t expiry);
+			// assumes the lock is held
+			void fire(scheduler_impl & impl, TimerWheel::Handle handle, Timer & timer);
+
+			static void call_period(scheduler & scheduler, engine::Hash strand, engine::task::any && data);
+		};
+	}
+}
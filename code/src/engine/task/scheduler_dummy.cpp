@@ -3,25 +3,45 @@
 #if TASK_USE_DUMMY
 
 #include "core/async/Thread.hpp"
+#include "core/container/Collection.hpp"
 #include "core/container/Queue.hpp"
 #include "core/sync/Event.hpp"
 
 #include "engine/task/scheduler.hpp"
+#include "engine/task/scheduler/timers.hpp"
 
 #include "utility/any.hpp"
+#include "utility/container/vector.hpp"
 #include "utility/optional.hpp"
 #include "utility/spinlock.hpp"
 #include "utility/variant.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <mutex>
 
 namespace
 {
+	using clock = std::chrono::steady_clock;
+
+	constexpr clock::time_point no_deadline_time = clock::time_point::max();
+
 	struct Work
 	{
 		engine::Hash strand;
 		engine::task::work_callback * workcall;
-		utility::any data;
+		engine::task::any data;
+
+		engine::task::priority priority;
+		clock::time_point post_time;
+		clock::time_point deadline;
+	};
+
+	// call the next work that is queued up within the strand
+	struct Drain
+	{
+		engine::Hash strand;
 	};
 
 	struct Terminate
@@ -31,17 +51,98 @@ namespace
 	using Message = utility::variant
 	<
 		Work,
+		Drain,
 		Terminate
 	>;
+
+	// messages that have a deadline are kept in a heap with the earliest
+	// deadline on top, instead of in the queue of their priority
+	struct Deadline
+	{
+		clock::time_point time;
+		Message message;
+	};
+
+	struct later_deadline
+	{
+		bool operator () (const Deadline & a, const Deadline & b) const { return b.time < a.time; }
+	};
+
+	// works are queued within their strand and called one at a time by
+	// drain messages, the strand is only present in the lookup while it
+	// has a drain message queued or being handled
+	//
+	// a work that is more urgent than the queued drain message gets a
+	// drain message of its own, whichever of them is popped first calls
+	// the next work and the others may find the strand empty
+	struct Strand
+	{
+		utility::heap_vector<Work> works;
+		// the works before it have been called
+		ext::usize front = 0;
+
+		// the number of queued works of each priority
+		int counts[engine::task::priority_count] = {};
+
+		// the number of drain messages that have not been popped yet
+		int drains = 0;
+		// the priority of the most urgent of them
+		int drain_priority = engine::task::priority_count;
+		bool draining = false;
+	};
+
+	// every so often the search for a message starts at a lower priority
+	constexpr ext::usize starvation_interval = 8;
+
+	// only written to by the scheduler thread, but read by anyone asking
+	// for stats
+	struct Stats
+	{
+		std::atomic<ext::usize> posted{0};
+		std::atomic<ext::usize> called{0};
+		std::atomic<ext::usize> promoted{0};
+		std::atomic<ext::usize> total_wait_microseconds{0};
+		std::atomic<ext::usize> max_wait_microseconds{0};
+	};
+
+	// the thread waits for messages and timers alike
+	void wake_thread(void * data);
 }
 
 namespace engine
 {
 	namespace task
 	{
+		// there is only the one thread so all chunks are called by the
+		// thread that joins
+		struct fork_data
+		{
+			range_callback * callback;
+			void * data;
+			ext::usize count;
+			ext::usize grain;
+		};
+
 		struct scheduler_impl
 		{
-			core::container::PageQueue<utility::heap_storage<Message>> queue;
+			utility::spinlock lock;
+			core::container::PageQueue<utility::heap_storage<Message>> queues[priority_count];
+			utility::heap_vector<Deadline> deadlines[priority_count];
+
+			core::container::Collection
+			<
+				engine::Hash,
+				utility::heap_storage_traits,
+				utility::heap_storage<Strand>
+			>
+			strands;
+
+			// the number of times the thread has looked for a message
+			ext::usize picks = 0;
+
+			Stats stats[priority_count];
+
+			engine::task::timers timers{wake_thread, this};
 
 			core::async::Thread thread;
 			core::sync::Event<true> event;
@@ -76,21 +177,218 @@ namespace
 
 namespace
 {
+	// assumes the lock is held
+	bool push_message(engine::task::scheduler_impl & impl, int priority, clock::time_point deadline, Message && message)
+	{
+		if (deadline == no_deadline_time)
+			return impl.queues[priority].try_push(std::move(message));
+
+		utility::heap_vector<Deadline> & deadlines = impl.deadlines[priority];
+		if (!deadlines.try_emplace_back(Deadline{deadline, std::move(message)}))
+			return false;
+
+		std::push_heap(deadlines.begin(), deadlines.end(), later_deadline{});
+		return true;
+	}
+
+	// assumes the lock is held
+	void pop_deadline(engine::task::scheduler_impl & impl, int priority, Message & message)
+	{
+		utility::heap_vector<Deadline> & deadlines = impl.deadlines[priority];
+
+		std::pop_heap(deadlines.begin(), deadlines.end(), later_deadline{});
+		message = std::move(ext::back(deadlines).message);
+		ext::pop_back(deadlines);
+	}
+
+	// assumes the lock is held
+	bool try_pop_expired(engine::task::scheduler_impl & impl, Message & message)
+	{
+		const clock::time_point now = clock::now();
+
+		int expired = -1;
+		for (int priority = 0; priority < engine::task::priority_count; priority++)
+		{
+			const utility::heap_vector<Deadline> & deadlines = impl.deadlines[priority];
+			if (ext::empty(deadlines) || now < deadlines[0].time)
+				continue;
+
+			if (expired < 0 || deadlines[0].time < impl.deadlines[expired][0].time)
+			{
+				expired = priority;
+			}
+		}
+
+		if (expired < 0)
+			return false;
+
+		pop_deadline(impl, expired, message);
+
+		Stats & stats = impl.stats[expired];
+		stats.promoted.store(stats.promoted.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		return true;
+	}
+
+	// assumes the lock is held
+	bool try_pop_message(engine::task::scheduler_impl & impl, Message & message)
+	{
+		if (try_pop_expired(impl, message))
+			return true;
+
+		// usually the search starts at the highest priority, but every
+		// so often it starts at one of the lower ones instead
+		impl.picks++;
+		const int first = impl.picks % starvation_interval != 0 ? 0 : static_cast<int>(1 + impl.picks / starvation_interval % (engine::task::priority_count - 1));
+
+		for (int i = 0; i < engine::task::priority_count; i++)
+		{
+			const int priority = (first + i) % engine::task::priority_count;
+
+			if (impl.queues[priority].try_pop(message))
+				return true;
+
+			if (!ext::empty(impl.deadlines[priority]))
+			{
+				pop_deadline(impl, priority, message);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	// assumes the lock is held
+	bool try_pop_strand(engine::task::scheduler_impl & impl, engine::Hash strand, Work & work)
+	{
+		const auto strand_it = find(impl.strands, strand);
+		if (!debug_assert(strand_it != impl.strands.end()))
+			return false;
+
+		Strand * const strand_data = impl.strands.get<Strand>(strand_it);
+		strand_data->drains--;
+		// note the drain messages that have not been popped may be of
+		// any priority
+		strand_data->drain_priority = strand_data->drains > 0 ? engine::task::priority_count - 1 : engine::task::priority_count;
+
+		if (strand_data->front == strand_data->works.size())
+		{
+			// the strand is left for the remaining drain messages to
+			// find, the last of them removes it
+			if (strand_data->drains == 0)
+			{
+				impl.strands.erase(strand_it);
+			}
+			return false;
+		}
+
+		work = std::move(strand_data->works[strand_data->front]);
+		strand_data->front++;
+		strand_data->counts[static_cast<int>(work.priority)]--;
+		strand_data->draining = true;
+		return true;
+	}
+
+	// assumes the lock is held
+	void finish_strand(engine::task::scheduler_impl & impl, engine::Hash strand)
+	{
+		const auto strand_it = find(impl.strands, strand);
+		if (!debug_assert(strand_it != impl.strands.end()))
+			return;
+
+		Strand * const strand_data = impl.strands.get<Strand>(strand_it);
+		strand_data->draining = false;
+
+		if (strand_data->front == strand_data->works.size())
+		{
+			strand_data->works.clear();
+			strand_data->front = 0;
+
+			if (strand_data->drains == 0)
+			{
+				impl.strands.erase(strand_it);
+			}
+			return;
+		}
+
+		// the remaining works are scheduled as the most urgent one of
+		// them, and with the deadline of the next one
+		const int priority = static_cast<int>(std::find_if(strand_data->counts, strand_data->counts + engine::task::priority_count, [](int x){ return x != 0; }) - strand_data->counts);
+		const clock::time_point deadline = strand_data->works[strand_data->front].deadline;
+
+		if (debug_verify(push_message(impl, priority, deadline, Drain{strand})))
+		{
+			strand_data->drains++;
+			if (priority < strand_data->drain_priority)
+			{
+				strand_data->drain_priority = priority;
+			}
+		}
+	}
+
+	void record_wait(engine::task::scheduler_impl & impl, Work & work)
+	{
+		const ext::usize wait = static_cast<ext::usize>(std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - work.post_time).count());
+
+		Stats & stats = impl.stats[static_cast<int>(work.priority)];
+		stats.called.store(stats.called.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		stats.total_wait_microseconds.store(stats.total_wait_microseconds.load(std::memory_order_relaxed) + wait, std::memory_order_relaxed);
+		if (stats.max_wait_microseconds.load(std::memory_order_relaxed) < wait)
+		{
+			stats.max_wait_microseconds.store(wait, std::memory_order_relaxed);
+		}
+	}
+
+	void call_work(engine::task::scheduler_impl & impl, Work && work)
+	{
+		record_wait(impl, work);
+
+		engine::task::scheduler scheduler(impl);
+		work.workcall(scheduler, work.strand, std::move(work.data));
+		scheduler.detach();
+	}
+
 	bool parse_message(engine::task::scheduler_impl & impl)
 	{
-		Message message;
-		while (impl.queue.try_pop(message))
+		// the terminate message is popped before works of a lower
+		// priority, but those were posted before it and are called
+		// anyway
+		bool terminate = false;
+
+		while (true)
 		{
+			Message message;
+			{
+				std::lock_guard<utility::spinlock> guard(impl.lock);
+
+				if (!try_pop_message(impl, message))
+					break;
+			}
+
 			struct
 			{
 				engine::task::scheduler_impl & impl;
 
 				bool operator () (Work && x)
 				{
-					engine::task::scheduler scheduler(impl);
-					x.workcall(scheduler, x.strand, std::move(x.data));
-					scheduler.detach();
+					call_work(impl, std::move(x));
+
+					return true;
+				}
+
+				bool operator () (Drain && x)
+				{
+					Work work;
+					{
+						std::lock_guard<utility::spinlock> guard(impl.lock);
+
+						if (!try_pop_strand(impl, x.strand, work))
+							return true;
+					}
+
+					call_work(impl, std::move(work));
 
+					std::lock_guard<utility::spinlock> guard(impl.lock);
+
+					finish_strand(impl, x.strand);
 					return true;
 				}
 
@@ -99,9 +397,16 @@ namespace
 			} visitor{impl};
 
 			if (!visit(visitor, std::move(message)))
-				return false;
+			{
+				terminate = true;
+			}
 		}
-		return true;
+		return !terminate;
+	}
+
+	void wake_thread(void * data)
+	{
+		static_cast<engine::task::scheduler_impl *>(data)->event.set();
 	}
 
 	core::async::thread_return thread_decl scheduler_thread(core::async::thread_param arg)
@@ -110,7 +415,15 @@ namespace
 
 		do
 		{
-			impl.event.wait();
+			const uint64_t ticks = impl.timers.advance(impl);
+			if (ticks == uint64_t(-1))
+			{
+				impl.event.wait();
+			}
+			else
+			{
+				impl.event.wait(static_cast<int>(ticks));
+			}
 			impl.event.reset();
 		}
 		while (parse_message(impl));
@@ -138,7 +451,14 @@ namespace engine
 
 		void scheduler::destruct(scheduler_impl & impl)
 		{
-			if (debug_verify(impl.queue.try_emplace(utility::in_place_type<Terminate>)))
+			bool pushed;
+			{
+				std::lock_guard<utility::spinlock> guard(impl.lock);
+
+				pushed = impl.queues[static_cast<int>(priority::interactive)].try_emplace(utility::in_place_type<Terminate>);
+			}
+
+			if (debug_verify(pushed))
 			{
 				impl.event.set();
 				impl.thread.join();
@@ -151,13 +471,155 @@ namespace engine
 		void post_work(
 			scheduler & scheduler,
 			engine::Hash strand,
+			priority priority,
+			int deadline,
 			work_callback * workcall,
-			utility::any && data)
+			engine::task::any && data)
 		{
-			if (debug_verify(scheduler->queue.try_emplace(utility::in_place_type<Work>, strand, workcall, std::move(data))))
+			const int index = static_cast<int>(priority);
+			if (!debug_assert((0 <= index && index < priority_count)))
+				return;
+
+			scheduler_impl & impl = *scheduler;
+
+			const clock::time_point now = clock::now();
+			const clock::time_point deadline_time = deadline < 0 ? no_deadline_time : now + std::chrono::milliseconds(deadline);
+
+			impl.stats[index].posted.fetch_add(1, std::memory_order_relaxed);
+
 			{
-				scheduler->event.set();
+				std::lock_guard<utility::spinlock> guard(impl.lock);
+
+				if (strand != engine::Hash{})
+				{
+					Strand * strand_data;
+
+					const auto strand_it = find(impl.strands, strand);
+					if (strand_it != impl.strands.end())
+					{
+						strand_data = impl.strands.get<Strand>(strand_it);
+					}
+					else
+					{
+						strand_data = impl.strands.emplace<Strand>(strand);
+						if (!debug_verify(strand_data))
+							return;
+					}
+
+					if (!debug_verify(strand_data->works.try_emplace_back(Work{strand, workcall, std::move(data), priority, now, deadline_time})))
+					{
+						if (strand_data->drains == 0 && !strand_data->draining && strand_data->front == strand_data->works.size())
+						{
+							impl.strands.erase(find(impl.strands, strand));
+						}
+						return;
+					}
+					strand_data->counts[index]++;
+
+					// a strand that is being drained schedules the work
+					// when the current one returns, otherwise it is
+					// scheduled again if the work is more urgent than the
+					// strand is
+					if (strand_data->draining || strand_data->drain_priority <= index)
+						return;
+
+					if (!debug_verify(push_message(impl, index, deadline_time, Drain{strand})))
+						return;
+
+					strand_data->drains++;
+					strand_data->drain_priority = index;
+				}
+				else
+				{
+					if (!debug_verify(push_message(impl, index, deadline_time, Work{strand, workcall, std::move(data), priority, now, deadline_time})))
+						return;
+				}
 			}
+			impl.event.set();
+		}
+
+		timer_id post_work_after(
+			scheduler & scheduler,
+			engine::Hash strand,
+			int delay,
+			work_callback * workcall,
+			engine::task::any && data)
+		{
+			return scheduler->timers.add(strand, delay, workcall, std::move(data));
+		}
+
+		timer_id post_work_every(
+			scheduler & scheduler,
+			engine::Hash strand,
+			int interval,
+			timer_callback * timercall,
+			engine::task::any && data)
+		{
+			return scheduler->timers.add_periodic(strand, interval, timercall, std::move(data));
+		}
+
+		bool cancel_timer(
+			scheduler & scheduler,
+			timer_id timer)
+		{
+			return scheduler->timers.cancel(timer);
+		}
+
+		priority_stats get_stats(
+			const scheduler & scheduler,
+			priority priority)
+		{
+			const int index = static_cast<int>(priority);
+			if (!debug_assert((0 <= index && index < priority_count)))
+				return priority_stats{};
+
+			const Stats & stats = scheduler->stats[index];
+
+			priority_stats ret{};
+			ret.posted = stats.posted.load(std::memory_order_relaxed);
+			ret.called = stats.called.load(std::memory_order_relaxed);
+			ret.promoted = stats.promoted.load(std::memory_order_relaxed);
+			ret.total_wait_microseconds = stats.total_wait_microseconds.load(std::memory_order_relaxed);
+			ret.max_wait_microseconds = stats.max_wait_microseconds.load(std::memory_order_relaxed);
+
+			return ret;
+		}
+
+		join_handle fork_range(
+			scheduler & /*scheduler*/,
+			ext::usize count,
+			ext::usize grain,
+			range_callback * callback,
+			void * data)
+		{
+			if (grain == 0)
+			{
+				grain = 1;
+			}
+
+			return join_handle(new fork_data{callback, data, count, grain});
+		}
+
+		void join(
+			scheduler & scheduler,
+			join_handle && handle)
+		{
+			fork_data * const fork = handle.release();
+			if (!debug_assert(fork))
+				return;
+
+			for (ext::usize begin = 0; begin < fork->count; begin += fork->grain)
+			{
+				fork->callback(scheduler, begin, std::min(begin + fork->grain, fork->count), fork->data);
+			}
+
+			delete fork;
+		}
+
+		void abandon(
+			fork_data * data)
+		{
+			delete data;
 		}
 	}
 }
@@ -0,0 +1,955 @@
+#include "config.h"
+
+#if TASK_USE_POOL
+
+#include "core/async/Thread.hpp"
+#include "core/container/Collection.hpp"
+#include "core/debug.hpp"
+#include "core/sync/Event.hpp"
+
+#include "engine/task/scheduler.hpp"
+#include "engine/task/scheduler/timers.hpp"
+
+#include "utility/any.hpp"
+#include "utility/container/array.hpp"
+#include "utility/container/vector.hpp"
+#include "utility/optional.hpp"
+#include "utility/spinlock.hpp"
+#include "utility/variant.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+namespace
+{
+	using clock = std::chrono::steady_clock;
+
+	constexpr clock::time_point no_deadline_time = clock::time_point::max();
+
+	struct Work
+	{
+		engine::Hash strand;
+		engine::task::work_callback * workcall;
+		engine::task::any data;
+
+		engine::task::priority priority;
+		clock::time_point post_time;
+		clock::time_point deadline;
+	};
+
+	// continue calling the works that are queued up within the strand
+	struct Drain
+	{
+		engine::Hash strand;
+	};
+
+	// call chunks of a forked range until there are none left
+	struct Chunks
+	{
+		engine::task::fork_data * data;
+	};
+
+	using Task = utility::variant
+	<
+		Work,
+		Drain,
+		Chunks
+	>;
+
+	// a double ended queue, values are pushed at the back but may be
+	// popped from either end
+	//
+	// values popped from the front are left in the vector (moved from)
+	// until either the queue runs empty or they make up most of it, at
+	// which point they are erased all at once
+	template <typename T>
+	class WorkQueue
+	{
+	private:
+
+		utility::heap_vector<T> values_;
+		ext::usize front_ = 0;
+
+	public:
+
+		bool empty() const { return front_ == values_.size(); }
+
+		const T & front() const { return values_[front_]; }
+
+		bool push_back(T && value)
+		{
+			if (empty())
+			{
+				values_.clear();
+				front_ = 0;
+			}
+			return values_.push_back(std::move(value));
+		}
+
+		bool try_pop_back(T & value)
+		{
+			if (empty())
+				return false;
+
+			value = ext::back(std::move(values_));
+			ext::pop_back(values_);
+
+			return true;
+		}
+
+		bool try_pop_front(T & value)
+		{
+			if (empty())
+				return false;
+
+			value = std::move(values_[front_]);
+			front_++;
+
+			if (empty())
+			{
+				values_.clear();
+				front_ = 0;
+			}
+			else if (values_.size() < 2 * front_)
+			{
+				values_.erase(utility::stable, values_.begin(), values_.begin() + front_);
+				front_ = 0;
+			}
+
+			return true;
+		}
+	};
+
+	// the owning worker pushes and pops tasks at the back while other
+	// workers steal from the front, there is one queue per priority
+	class TaskDeque
+	{
+	private:
+
+		utility::spinlock lock_;
+
+		WorkQueue<Task> tasks_[engine::task::priority_count];
+
+	public:
+
+		bool push_back(int priority, Task && task)
+		{
+			std::lock_guard<utility::spinlock> guard(lock_);
+
+			return tasks_[priority].push_back(std::move(task));
+		}
+
+		bool try_pop_back(int priority, Task & task)
+		{
+			std::lock_guard<utility::spinlock> guard(lock_);
+
+			return tasks_[priority].try_pop_back(task);
+		}
+
+		bool try_steal(int priority, Task & task)
+		{
+			std::lock_guard<utility::spinlock> guard(lock_);
+
+			return tasks_[priority].try_pop_front(task);
+		}
+	};
+
+	// tasks that have a deadline are kept in a heap with the earliest
+	// deadline on top, so that finding the ones that have run out is
+	// cheap
+	struct Deadline
+	{
+		clock::time_point time;
+		Task task;
+	};
+
+	struct later_deadline
+	{
+		bool operator () (const Deadline & a, const Deadline & b) const { return b.time < a.time; }
+	};
+
+	// only written to by the owning worker, but read by anyone asking for
+	// stats
+	struct WorkerStats
+	{
+		std::atomic<ext::usize> called{0};
+		std::atomic<ext::usize> promoted{0};
+		std::atomic<ext::usize> total_wait_microseconds{0};
+		std::atomic<ext::usize> max_wait_microseconds{0};
+	};
+
+	struct Worker
+	{
+		engine::task::scheduler_impl * impl;
+		ext::index index;
+
+		TaskDeque tasks;
+
+		// the number of times the worker has looked for a task, used to
+		// decide when to give the lower priorities a turn
+		ext::usize picks = 0;
+
+		WorkerStats stats[engine::task::priority_count];
+
+		std::atomic_bool sleeping{false};
+		core::sync::Event<false> event;
+
+		core::async::Thread thread;
+	};
+
+	// works are queued within their strand and at most one worker at a
+	// time drains them in order, the strand is only present in the
+	// lookup while it has a drain task scheduled or running
+	//
+	// a work that is more urgent than the scheduled drain task gets a
+	// drain task of its own, whichever of them starts first drains the
+	// strand and the others find it busy or empty
+	struct Strand
+	{
+		WorkQueue<Work> works;
+
+		// the number of queued works of each priority
+		int counts[engine::task::priority_count] = {};
+
+		// the number of drain tasks that have not started yet
+		int drains = 0;
+		// the priority of the most urgent of them
+		int drain_priority = engine::task::priority_count;
+		bool draining = false;
+	};
+
+	// the maximum number of works that are called in one go before the
+	// drain task is put back in the deque
+	constexpr int strand_batch_size = 16;
+
+	// every so often the search for a task starts at a lower priority
+	constexpr ext::usize starvation_interval = 8;
+
+	// the timers have a thread of their own
+	void wake_timers(void * data);
+
+	thread_local Worker * current_worker = nullptr;
+}
+
+namespace engine
+{
+	namespace task
+	{
+		// chunks are claimed in order by whoever gets to them first, be it
+		// a worker or the thread that joins
+		struct fork_data
+		{
+			range_callback * callback;
+			void * data;
+			ext::usize count;
+			ext::usize grain;
+			ext::usize chunk_count;
+
+			std::atomic_size_t next_chunk{0};
+			std::atomic_size_t remaining_chunks;
+
+			// one for the handle and one for each chunks task
+			std::atomic_int references;
+
+			core::sync::Event<true> done;
+
+			explicit fork_data(range_callback * callback, void * data, ext::usize count, ext::usize grain, int references)
+				: callback(callback)
+				, data(data)
+				, count(count)
+				, grain(grain)
+				, chunk_count((count + grain - 1) / grain)
+				, remaining_chunks(chunk_count)
+				, references(references)
+			{}
+		};
+
+		struct scheduler_impl
+		{
+			utility::heap_array<Worker> workers;
+
+			utility::spinlock strands_lock;
+			core::container::Collection
+			<
+				engine::Hash,
+				utility::heap_storage_traits,
+				utility::heap_storage<Strand>
+			>
+			strands;
+
+			utility::spinlock deadlines_lock;
+			utility::heap_vector<Deadline> deadlines[priority_count];
+			std::atomic_int deadline_count{0};
+
+			std::atomic<ext::usize> posted[priority_count] = {};
+
+			engine::task::timers timers{wake_timers, this};
+			core::sync::Event<false> timers_event;
+			core::async::Thread timers_thread;
+
+			std::atomic_size_t next_worker{0};
+			std::atomic_bool terminating{false};
+
+			explicit scheduler_impl(ext::ssize thread_count)
+				: workers(thread_count)
+			{}
+		};
+	}
+}
+
+namespace
+{
+	utility::spinlock singelton_lock;
+	utility::optional<engine::task::scheduler_impl> singelton;
+
+	engine::task::scheduler_impl * create_impl(ext::ssize thread_count)
+	{
+		std::lock_guard<utility::spinlock> guard(singelton_lock);
+
+		if (singelton)
+			return nullptr;
+
+		singelton.emplace(thread_count);
+
+		return &singelton.value();
+	}
+
+	void destroy_impl(engine::task::scheduler_impl & /*impl*/)
+	{
+		std::lock_guard<utility::spinlock> guard(singelton_lock);
+
+		singelton.reset();
+	}
+}
+
+namespace
+{
+	ext::index worker_count(const engine::task::scheduler_impl & impl)
+	{
+		return static_cast<ext::index>(impl.workers.size());
+	}
+
+	bool try_wake(Worker & worker)
+	{
+		if (!worker.sleeping.exchange(false, std::memory_order_relaxed))
+			return false;
+
+		worker.event.set();
+
+		return true;
+	}
+
+	void wake_any(engine::task::scheduler_impl & impl, ext::index first)
+	{
+		// pairs with the fence in `worker_thread`, either the sleeping
+		// worker sees the new work or we see it sleeping
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+
+		const ext::index count = worker_count(impl);
+		for (ext::index i = 0; i < count; i++)
+		{
+			if (try_wake(impl.workers[(first + i) % count]))
+				return;
+		}
+	}
+
+	bool push_deadline(engine::task::scheduler_impl & impl, int priority, clock::time_point deadline, Task && task)
+	{
+		std::lock_guard<utility::spinlock> guard(impl.deadlines_lock);
+
+		utility::heap_vector<Deadline> & deadlines = impl.deadlines[priority];
+		if (!deadlines.try_emplace_back(Deadline{deadline, std::move(task)}))
+			return false;
+
+		std::push_heap(deadlines.begin(), deadlines.end(), later_deadline{});
+		impl.deadline_count.fetch_add(1, std::memory_order_relaxed);
+
+		return true;
+	}
+
+	bool try_pop_deadline(engine::task::scheduler_impl & impl, int priority, Task & task)
+	{
+		std::lock_guard<utility::spinlock> guard(impl.deadlines_lock);
+
+		utility::heap_vector<Deadline> & deadlines = impl.deadlines[priority];
+		if (ext::empty(deadlines))
+			return false;
+
+		std::pop_heap(deadlines.begin(), deadlines.end(), later_deadline{});
+		task = std::move(ext::back(deadlines).task);
+		ext::pop_back(deadlines);
+		impl.deadline_count.fetch_sub(1, std::memory_order_relaxed);
+
+		return true;
+	}
+
+	// finds the task whose deadline ran out first, of any priority
+	bool try_pop_expired(engine::task::scheduler_impl & impl, Worker & worker, Task & task)
+	{
+		const clock::time_point now = clock::now();
+
+		std::lock_guard<utility::spinlock> guard(impl.deadlines_lock);
+
+		int expired = -1;
+		for (int priority = 0; priority < engine::task::priority_count; priority++)
+		{
+			const utility::heap_vector<Deadline> & deadlines = impl.deadlines[priority];
+			if (ext::empty(deadlines) || now < deadlines[0].time)
+				continue;
+
+			if (expired < 0 || deadlines[0].time < impl.deadlines[expired][0].time)
+			{
+				expired = priority;
+			}
+		}
+
+		if (expired < 0)
+			return false;
+
+		utility::heap_vector<Deadline> & deadlines = impl.deadlines[expired];
+		std::pop_heap(deadlines.begin(), deadlines.end(), later_deadline{});
+		task = std::move(ext::back(deadlines).task);
+		ext::pop_back(deadlines);
+		impl.deadline_count.fetch_sub(1, std::memory_order_relaxed);
+
+		WorkerStats & stats = worker.stats[expired];
+		stats.promoted.store(stats.promoted.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+		return true;
+	}
+
+	void push_task(engine::task::scheduler_impl & impl, int priority, clock::time_point deadline, Task && task)
+	{
+		const ext::index count = worker_count(impl);
+
+		if (deadline != no_deadline_time)
+		{
+			if (debug_verify(push_deadline(impl, priority, deadline, std::move(task))))
+			{
+				wake_any(impl, current_worker && current_worker->impl == &impl ? current_worker->index + 1 : 0);
+			}
+		}
+		else if (current_worker && current_worker->impl == &impl)
+		{
+			if (debug_verify(current_worker->tasks.push_back(priority, std::move(task))))
+			{
+				wake_any(impl, current_worker->index + 1);
+			}
+		}
+		else
+		{
+			const ext::index first = static_cast<ext::index>(impl.next_worker.fetch_add(1, std::memory_order_relaxed) % count);
+
+			if (debug_verify(impl.workers[first].tasks.push_back(priority, std::move(task))))
+			{
+				wake_any(impl, first);
+			}
+		}
+	}
+
+	void push_task(engine::task::scheduler_impl & impl, int priority, Task && task)
+	{
+		push_task(impl, priority, no_deadline_time, std::move(task));
+	}
+
+	bool find_task(engine::task::scheduler_impl & impl, Worker & worker, int priority, Task & task)
+	{
+		if (worker.tasks.try_pop_back(priority, task))
+			return true;
+
+		const ext::index count = worker_count(impl);
+		for (ext::index i = 1; i < count; i++)
+		{
+			if (impl.workers[(worker.index + i) % count].tasks.try_steal(priority, task))
+				return true;
+		}
+
+		return impl.deadline_count.load(std::memory_order_relaxed) != 0 && try_pop_deadline(impl, priority, task);
+	}
+
+	bool find_task(engine::task::scheduler_impl & impl, Worker & worker, Task & task)
+	{
+		if (impl.deadline_count.load(std::memory_order_relaxed) != 0 && try_pop_expired(impl, worker, task))
+			return true;
+
+		// usually the search starts at the highest priority, but every
+		// so often it starts at one of the lower ones instead
+		worker.picks++;
+		const int first = worker.picks % starvation_interval != 0 ? 0 : static_cast<int>(1 + worker.picks / starvation_interval % (engine::task::priority_count - 1));
+
+		for (int i = 0; i < engine::task::priority_count; i++)
+		{
+			if (find_task(impl, worker, (first + i) % engine::task::priority_count, task))
+				return true;
+		}
+
+		return false;
+	}
+
+	void record_wait(Work & work)
+	{
+		if (!current_worker)
+			return;
+
+		const ext::usize wait = static_cast<ext::usize>(std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - work.post_time).count());
+
+		WorkerStats & stats = current_worker->stats[static_cast<int>(work.priority)];
+		stats.called.store(stats.called.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		stats.total_wait_microseconds.store(stats.total_wait_microseconds.load(std::memory_order_relaxed) + wait, std::memory_order_relaxed);
+		if (stats.max_wait_microseconds.load(std::memory_order_relaxed) < wait)
+		{
+			stats.max_wait_microseconds.store(wait, std::memory_order_relaxed);
+		}
+	}
+
+	void call_work(engine::task::scheduler_impl & impl, Work && work)
+	{
+		record_wait(work);
+
+		engine::task::scheduler scheduler(impl);
+		work.workcall(scheduler, work.strand, std::move(work.data));
+		scheduler.detach();
+	}
+
+	void drain_strand(engine::task::scheduler_impl & impl, engine::Hash strand)
+	{
+		int priority = 0;
+		clock::time_point deadline = no_deadline_time;
+
+		for (int count = 0;; count++)
+		{
+			Work work;
+			{
+				std::lock_guard<utility::spinlock> guard(impl.strands_lock);
+
+				const auto strand_it = find(impl.strands, strand);
+				if (!debug_assert(strand_it != impl.strands.end()))
+					return;
+
+				Strand * const strand_data = impl.strands.get<Strand>(strand_it);
+				if (count == 0)
+				{
+					strand_data->drains--;
+
+					// another worker got to the strand first
+					if (strand_data->draining)
+						return;
+
+					strand_data->draining = true;
+					// note the drain tasks that have not started may be
+					// of any priority
+					strand_data->drain_priority = strand_data->drains > 0 ? engine::task::priority_count - 1 : engine::task::priority_count;
+				}
+
+				if (strand_data->works.empty())
+				{
+					strand_data->draining = false;
+
+					// the strand is left for the remaining drain tasks to
+					// find, the last of them removes it
+					if (strand_data->drains == 0)
+					{
+						impl.strands.erase(strand_it);
+					}
+					return;
+				}
+
+				if (count == strand_batch_size)
+				{
+					// the remaining works are scheduled as the most urgent
+					// one of them, and with the deadline of the next one
+					priority = static_cast<int>(std::find_if(strand_data->counts, strand_data->counts + engine::task::priority_count, [](int x){ return x != 0; }) - strand_data->counts);
+					deadline = strand_data->works.front().deadline;
+
+					strand_data->draining = false;
+					strand_data->drains++;
+					if (priority < strand_data->drain_priority)
+					{
+						strand_data->drain_priority = priority;
+					}
+					break;
+				}
+
+				strand_data->works.try_pop_front(work);
+				strand_data->counts[static_cast<int>(work.priority)]--;
+			}
+
+			call_work(impl, std::move(work));
+		}
+
+		push_task(impl, priority, deadline, Drain{strand});
+	}
+
+	void call_chunks(engine::task::scheduler_impl & impl, engine::task::fork_data & data)
+	{
+		while (true)
+		{
+			const ext::usize chunk = data.next_chunk.fetch_add(1, std::memory_order_relaxed);
+			if (chunk >= data.chunk_count)
+				return;
+
+			const ext::usize begin = chunk * data.grain;
+			const ext::usize end = std::min(begin + data.grain, data.count);
+
+			engine::task::scheduler scheduler(impl);
+			data.callback(scheduler, begin, end, data.data);
+			scheduler.detach();
+
+			if (data.remaining_chunks.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			{
+				data.done.set();
+			}
+		}
+	}
+
+	void release_chunks(engine::task::fork_data & data)
+	{
+		if (data.references.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			delete &data;
+		}
+	}
+
+	void execute(engine::task::scheduler_impl & impl, Task && task)
+	{
+		struct
+		{
+			engine::task::scheduler_impl & impl;
+
+			void operator () (Work && x)
+			{
+				call_work(impl, std::move(x));
+			}
+
+			void operator () (Drain && x)
+			{
+				drain_strand(impl, x.strand);
+			}
+
+			void operator () (Chunks && x)
+			{
+				call_chunks(impl, *x.data);
+				release_chunks(*x.data);
+			}
+
+		} visitor{impl};
+
+		visit(visitor, std::move(task));
+	}
+
+	core::async::thread_return thread_decl worker_thread(core::async::thread_param arg)
+	{
+		Worker & worker = *static_cast<Worker *>(arg);
+		engine::task::scheduler_impl & impl = *worker.impl;
+
+		current_worker = &worker;
+
+		Task task;
+		while (true)
+		{
+			if (find_task(impl, worker, task))
+			{
+				execute(impl, std::move(task));
+				continue;
+			}
+
+			worker.sleeping.store(true, std::memory_order_relaxed);
+			// pairs with the fence in `wake_any`
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+
+			if (find_task(impl, worker, task))
+			{
+				if (!worker.sleeping.exchange(false, std::memory_order_relaxed))
+				{
+					// someone else tried to wake us up in the meantime,
+					// so pass that on to another worker
+					wake_any(impl, worker.index + 1);
+				}
+
+				execute(impl, std::move(task));
+				continue;
+			}
+
+			if (impl.terminating.load(std::memory_order_relaxed))
+				break;
+
+			worker.event.wait();
+		}
+
+		current_worker = nullptr;
+
+		return core::async::thread_return{};
+	}
+
+	void wake_timers(void * data)
+	{
+		static_cast<engine::task::scheduler_impl *>(data)->timers_event.set();
+	}
+
+	core::async::thread_return thread_decl timers_thread(core::async::thread_param arg)
+	{
+		engine::task::scheduler_impl & impl = *static_cast<engine::task::scheduler_impl *>(arg);
+
+		while (!impl.terminating.load(std::memory_order_relaxed))
+		{
+			const uint64_t ticks = impl.timers.advance(impl);
+			if (ticks == uint64_t(-1))
+			{
+				impl.timers_event.wait();
+			}
+			else
+			{
+				impl.timers_event.wait(static_cast<int>(ticks));
+			}
+		}
+
+		return core::async::thread_return{};
+	}
+}
+
+namespace engine
+{
+	namespace task
+	{
+		scheduler_impl * scheduler::construct(ext::ssize thread_count)
+		{
+			if (!debug_verify(0 < thread_count))
+				return nullptr;
+
+			scheduler_impl * const impl = create_impl(thread_count);
+			if (debug_verify(impl))
+			{
+				if (!debug_verify(worker_count(*impl) == thread_count))
+				{
+					destroy_impl(*impl);
+					return nullptr;
+				}
+
+				for (ext::index i = 0; i < thread_count; i++)
+				{
+					Worker & worker = impl->workers[i];
+					worker.impl = impl;
+					worker.index = i;
+				}
+
+				for (Worker & worker : impl->workers)
+				{
+					worker.thread = core::async::Thread(worker_thread, &worker);
+				}
+
+				impl->timers_thread = core::async::Thread(timers_thread, impl);
+			}
+			return impl;
+		}
+
+		void scheduler::destruct(scheduler_impl & impl)
+		{
+			impl.terminating.store(true, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+
+			impl.timers_event.set();
+			impl.timers_thread.join();
+
+			for (Worker & worker : impl.workers)
+			{
+				worker.event.set();
+			}
+
+			for (Worker & worker : impl.workers)
+			{
+				worker.thread.join();
+			}
+
+			destroy_impl(impl);
+		}
+
+		void post_work(
+			scheduler & scheduler,
+			engine::Hash strand,
+			priority priority,
+			int deadline,
+			work_callback * workcall,
+			engine::task::any && data)
+		{
+			scheduler_impl & impl = *scheduler;
+
+			const int index = static_cast<int>(priority);
+			if (!debug_assert((0 <= index && index < priority_count)))
+				return;
+
+			const clock::time_point now = clock::now();
+			const clock::time_point deadline_time = deadline < 0 ? no_deadline_time : now + std::chrono::milliseconds(deadline);
+
+			impl.posted[index].fetch_add(1, std::memory_order_relaxed);
+
+			if (strand != engine::Hash{})
+			{
+				bool schedule = false;
+				{
+					std::lock_guard<utility::spinlock> guard(impl.strands_lock);
+
+					Strand * strand_data;
+
+					const auto strand_it = find(impl.strands, strand);
+					if (strand_it != impl.strands.end())
+					{
+						strand_data = impl.strands.get<Strand>(strand_it);
+					}
+					else
+					{
+						strand_data = impl.strands.emplace<Strand>(strand);
+						if (!debug_verify(strand_data))
+							return;
+
+						schedule = true;
+					}
+
+					if (!debug_verify(strand_data->works.push_back(Work{strand, workcall, std::move(data), priority, now, deadline_time})))
+					{
+						if (schedule)
+						{
+							impl.strands.erase(find(impl.strands, strand));
+						}
+						return;
+					}
+					strand_data->counts[index]++;
+
+					// a strand that is being drained picks the work up
+					// anyway, otherwise it is scheduled again if the work
+					// is more urgent than the strand is
+					if (!strand_data->draining && index < strand_data->drain_priority)
+					{
+						strand_data->drains++;
+						strand_data->drain_priority = index;
+
+						schedule = true;
+					}
+				}
+
+				if (schedule)
+				{
+					push_task(impl, index, deadline_time, Drain{strand});
+				}
+			}
+			else
+			{
+				push_task(impl, index, deadline_time, Work{strand, workcall, std::move(data), priority, now, deadline_time});
+			}
+		}
+
+		timer_id post_work_after(
+			scheduler & scheduler,
+			engine::Hash strand,
+			int delay,
+			work_callback * workcall,
+			engine::task::any && data)
+		{
+			return scheduler->timers.add(strand, delay, workcall, std::move(data));
+		}
+
+		timer_id post_work_every(
+			scheduler & scheduler,
+			engine::Hash strand,
+			int interval,
+			timer_callback * timercall,
+			engine::task::any && data)
+		{
+			return scheduler->timers.add_periodic(strand, interval, timercall, std::move(data));
+		}
+
+		bool cancel_timer(
+			scheduler & scheduler,
+			timer_id timer)
+		{
+			return scheduler->timers.cancel(timer);
+		}
+
+		priority_stats get_stats(
+			const scheduler & scheduler,
+			priority priority)
+		{
+			const scheduler_impl & impl = *scheduler;
+
+			const int index = static_cast<int>(priority);
+			if (!debug_assert((0 <= index && index < priority_count)))
+				return priority_stats{};
+
+			priority_stats stats{};
+			stats.posted = impl.posted[index].load(std::memory_order_relaxed);
+
+			for (const Worker & worker : impl.workers)
+			{
+				const WorkerStats & worker_stats = worker.stats[index];
+				stats.called += worker_stats.called.load(std::memory_order_relaxed);
+				stats.promoted += worker_stats.promoted.load(std::memory_order_relaxed);
+				stats.total_wait_microseconds += worker_stats.total_wait_microseconds.load(std::memory_order_relaxed);
+				stats.max_wait_microseconds = std::max(stats.max_wait_microseconds, worker_stats.max_wait_microseconds.load(std::memory_order_relaxed));
+			}
+
+			return stats;
+		}
+
+		join_handle fork_range(
+			scheduler & scheduler,
+			ext::usize count,
+			ext::usize grain,
+			range_callback * callback,
+			void * data)
+		{
+			scheduler_impl & impl = *scheduler;
+
+			if (grain == 0)
+			{
+				grain = 1;
+			}
+
+			const ext::usize chunk_count = (count + grain - 1) / grain;
+
+			// the joining thread calls chunks too, so there is no point in
+			// having more tasks than there are other chunks to go around
+			const int task_count = static_cast<int>(std::min(chunk_count > 0 ? chunk_count - 1 : 0, static_cast<ext::usize>(worker_count(impl))));
+
+			fork_data * const fork = new fork_data(callback, data, count, grain, 1 + task_count);
+
+			// someone is waiting for the chunks to finish
+			for (int i = 0; i < task_count; i++)
+			{
+				push_task(impl, static_cast<int>(priority::interactive), Chunks{fork});
+			}
+
+			return join_handle(fork);
+		}
+
+		void join(
+			scheduler & scheduler,
+			join_handle && handle)
+		{
+			fork_data * const fork = handle.release();
+			if (!debug_assert(fork))
+				return;
+
+			call_chunks(*scheduler, *fork);
+
+			// every chunk has been claimed by now, but some of them may
+			// still be in progress on other threads
+			if (fork->remaining_chunks.load(std::memory_order_acquire) != 0)
+			{
+				fork->done.wait();
+			}
+
+			release_chunks(*fork);
+		}
+
+		void abandon(
+			fork_data * data)
+		{
+			// note the chunks tasks keep the range alive for as long as
+			// they need it
+			release_chunks(*data);
+		}
+	}
+}
+
+#endif
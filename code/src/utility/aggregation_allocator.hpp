@@ -1,5 +1,6 @@
 #pragma once
 
+#include "utility/concepts.hpp"
 #include "utility/iterator.hpp"
 #include "utility/type_traits.hpp"
 
@@ -8,6 +9,18 @@
 
 namespace utility
 {
+	template <typename Allocator, typename = void>
+	struct can_reallocate : mpl::false_type {};
+	template <typename Allocator>
+	struct can_reallocate<Allocator, mpl::void_t<decltype(std::declval<Allocator &>().reallocate(std::declval<typename Allocator::pointer>(), std::size_t{}, std::size_t{}))>> : mpl::true_type {};
+
+	// the alignment of every allocation, allocators that align to more
+	// than the fundamental alignment say so with a static `alignment`
+	template <typename Allocator, typename = void>
+	struct allocator_alignment : mpl::index_constant<alignof(std::max_align_t)> {};
+	template <typename Allocator>
+	struct allocator_alignment<Allocator, mpl::void_t<decltype(Allocator::alignment)>> : mpl::index_constant<Allocator::alignment> {};
+
 	template <template <typename> class Allocator, typename Header, typename ...Ts>
 	class aggregation_allocator
 		: Allocator<char>
@@ -15,6 +28,8 @@ namespace utility
 	private:
 		using base_type = Allocator<char>;
 
+		enum : std::size_t { alignment = allocator_alignment<base_type>::value };
+
 	public:
 		using size_type = typename base_type::size_type;
 		using difference_type = typename base_type::difference_type;
@@ -51,9 +66,9 @@ namespace utility
 
 		pointer allocate(size_type n, const void * hint = nullptr)
 		{
-			static_assert(mpl::integral_max<std::size_t, 1, alignof(Ts)...>::value <= alignof(std::max_align_t), "operator new only guarantees correct alignment for fundamental types");
+			static_assert(mpl::integral_max<std::size_t, 1, alignof(Ts)...>::value <= alignment, "the allocator does not guarantee correct alignment for the types");
 			char * const p = base().allocate(size_of(n), hint);
-			fiw_assert(reinterpret_cast<std::uintptr_t>(p) % alignof(std::max_align_t) == 0);
+			fiw_assert(reinterpret_cast<std::uintptr_t>(p) % alignment == 0);
 
 			return reinterpret_cast<value_type *>(p);
 		}
@@ -61,6 +76,18 @@ namespace utility
 		{
 			base().deallocate(reinterpret_cast<char *>(p), size_of(n));
 		}
+		// note only single types can be reallocated, everything after
+		// the first type is placed according to the capacity
+		template <typename Base = base_type,
+		          REQUIRES((sizeof...(Ts) == 1 && can_reallocate<Base>::value))>
+		pointer reallocate(pointer p, size_type old_n, size_type new_n)
+		{
+			static_assert(mpl::integral_max<std::size_t, 1, alignof(Ts)...>::value <= alignment, "the allocator does not guarantee correct alignment for the types");
+			char * const q = base().reallocate(reinterpret_cast<char *>(p), size_of(old_n), size_of(new_n));
+			fiw_assert(reinterpret_cast<std::uintptr_t>(q) % alignment == 0);
+
+			return reinterpret_cast<value_type *>(q);
+		}
 
 		size_type max_size() const { return (base().max_size() - sizeof(Header)) / mpl::integral_sum<mpl::index_sequence<sizeof(Ts)...>>::value; }
 
@@ -144,6 +171,15 @@ namespace utility
 			return (n + a - 1) / a * a;
 		}
 
+		// every column is aligned to the size of its type, unless the
+		// allocator aligns to more than the fundamental alignment, in
+		// which case every column gets that same alignment
+		template <typename U>
+		static constexpr std::size_t column_alignment()
+		{
+			return alignment > alignof(std::max_align_t) ? std::size_t(alignment) : sizeof(U);
+		}
+
 		template <typename U1>
 		static std::size_t offset_of_impl(std::size_t /*capacity*/, std::size_t acc, mpl::type_list<U1>)
 		{
@@ -152,13 +188,13 @@ namespace utility
 		template <typename U1, typename U2, typename ...Us>
 		static std::size_t offset_of_impl(std::size_t capacity, std::size_t acc, mpl::type_list<U1, U2, Us...>)
 		{
-			return offset_of_impl(capacity, align_upwards(acc + sizeof(U1) * capacity, sizeof(U2)), mpl::type_list<U2, Us...>{});
+			return offset_of_impl(capacity, align_upwards(acc + sizeof(U1) * capacity, column_alignment<U2>()), mpl::type_list<U2, Us...>{});
 		}
 
 		template <typename U1, typename ...Us>
 		static std::size_t offset_of(std::size_t capacity, mpl::type_list<U1, Us...>)
 		{
-			return offset_of_impl(capacity, align_upwards(mpl::size_of<Header>::value, sizeof(U1)), mpl::type_list<U1, Us...>{});
+			return offset_of_impl(capacity, align_upwards(mpl::size_of<Header>::value, column_alignment<U1>()), mpl::type_list<U1, Us...>{});
 		}
 
 		static std::size_t size_of(std::size_t capacity)
@@ -177,13 +213,13 @@ namespace utility
 		template <typename U1, typename U2, typename ...Us, typename ...Is>
 		static std::array<std::size_t, sizeof...(Ts)> offsets_impl(std::size_t capacity, std::size_t acc, mpl::type_list<U1, U2, Us...>, Is ...is)
 		{
-			return offsets_impl(capacity, align_upwards(acc + sizeof(U1) * capacity, sizeof(U2)), mpl::type_list<U2, Us...>{}, is..., acc);
+			return offsets_impl(capacity, align_upwards(acc + sizeof(U1) * capacity, column_alignment<U2>()), mpl::type_list<U2, Us...>{}, is..., acc);
 		}
 		static std::array<std::size_t, sizeof...(Ts)> offsets(std::size_t capacity)
 		{
 			using U1 = mpl::car<Ts...>;
 
-			return offsets_impl(capacity, align_upwards(mpl::size_of<Header>::value, sizeof(U1)), mpl::type_list<Ts...>{});
+			return offsets_impl(capacity, align_upwards(mpl::size_of<Header>::value, column_alignment<U1>()), mpl::type_list<Ts...>{});
 		}
 	};
 }
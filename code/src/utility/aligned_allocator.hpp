@@ -0,0 +1,127 @@
+#ifndef UTILITY_ALIGNED_ALLOCATOR_HPP
+#define UTILITY_ALIGNED_ALLOCATOR_HPP
+
+#include "utility/utility.hpp"
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+
+#if defined(_MSC_VER)
+# include <malloc.h>
+#endif
+
+namespace utility
+{
+	enum : std::size_t
+	{
+		// enough for the widest aligned simd loads (avx)
+		simd_alignment = 32,
+		// the common size of a cache line, data that is written by
+		// different threads should be at least this far apart
+		cache_line_alignment = 64,
+		page_alignment = 4096,
+	};
+
+	// note alignment must be a power of two, and at least the alignment
+	// of fundamental types
+	inline void * aligned_malloc(std::size_t size, std::size_t alignment)
+	{
+#if defined(_MSC_VER)
+		return _aligned_malloc(size > 0 ? size : 1, alignment);
+#else
+		void * p;
+		if (posix_memalign(&p, alignment, size > 0 ? size : 1) != 0)
+			return nullptr;
+
+		return p;
+#endif
+	}
+
+	inline void aligned_free(void * p)
+	{
+#if defined(_MSC_VER)
+		_aligned_free(p);
+#else
+		std::free(p);
+#endif
+	}
+
+	// note realloc does not keep the alignment, so the contents are
+	// always copied, on failure the old allocation is left as is
+	inline void * aligned_realloc(void * p, std::size_t old_size, std::size_t new_size, std::size_t alignment)
+	{
+		void * const q = aligned_malloc(new_size, alignment);
+		if (!q)
+			return nullptr;
+
+		if (p)
+		{
+			std::memcpy(q, p, old_size < new_size ? old_size : new_size);
+			aligned_free(p);
+		}
+		return q;
+	}
+
+	// allocates from the heap, aligned to at least `Alignment` bytes
+	template <typename T, std::size_t Alignment>
+	class aligned_allocator
+	{
+		static_assert((Alignment & (Alignment - 1)) == 0, "the alignment must be a power of two");
+
+	public:
+		using size_type = std::size_t;
+		using difference_type = std::ptrdiff_t;
+		using pointer = T *;
+		using const_pointer = const T *;
+		using reference = T &;
+		using const_reference = const T &;
+		using value_type = T;
+
+		template <typename U>
+		struct rebind { using other = aligned_allocator<U, Alignment>; };
+
+		using propagate_on_container_move_assignment = std::true_type;
+
+		static constexpr std::size_t alignment = Alignment < alignof(std::max_align_t) ? alignof(std::max_align_t) : Alignment;
+
+		pointer address(reference x) const { return std::addressof(x); }
+		const_pointer address(const_reference x) const { return std::addressof(x); }
+
+		pointer allocate(size_type n, const void * = nullptr)
+		{
+			if (n > max_size())
+				return nullptr;
+
+			static_assert(alignof(T) <= alignment, "the alignment is too small for the type");
+			return static_cast<T *>(aligned_malloc(n * sizeof(T), alignment));
+		}
+		void deallocate(pointer p, size_type)
+		{
+			aligned_free(p);
+		}
+
+		constexpr size_type max_size() const { return size_t(-1) / sizeof(T); }
+
+		template <typename U, typename ...Ps>
+		void construct(U * p, Ps && ...ps) { utility::construct_at<U>(p, std::forward<Ps>(ps)...); }
+		template <typename U>
+		void destroy(U * p) { p->U::~U(); }
+	};
+
+	template <typename T, std::size_t Alignment>
+	constexpr std::size_t aligned_allocator<T, Alignment>::alignment;
+
+	// the aligned allocator as a template of only the type, which is what
+	// the storages expect, e.g.
+	//
+	//   dynamic_storage<aligned_to<simd_alignment>::allocator, Matrix4x4f>
+	template <std::size_t Alignment>
+	struct aligned_to
+	{
+		template <typename T>
+		using allocator = aligned_allocator<T, Alignment>;
+	};
+}
+
+#endif /* UTILITY_ALIGNED_ALLOCATOR_HPP */
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "utility/anyfwd.hpp"
 #include "utility/concepts.hpp"
 #include "utility/stream.hpp"
 #include "utility/type_info.hpp"
@@ -10,6 +11,7 @@
 #include "ful/heap.hpp"
 #include "ful/string_init.hpp"
 
+#include <atomic>
 #include <memory>
 
 namespace utility
@@ -25,50 +27,64 @@ namespace utility
 			const_ostream
 		};
 
+		template <std::size_t Size>
 		struct any_data;
 
+		template <std::size_t Size>
 		union any_input
 		{
-			any_data * data_;
-			const any_data * const_data_;
+			any_data<Size> * data_;
+			const any_data<Size> * const_data_;
 
 			any_input() = default;
-			any_input(any_data & data) : data_(&data) {}
-			any_input(const any_data & const_data) : const_data_(&const_data) {}
+			any_input(any_data<Size> & data) : data_(&data) {}
+			any_input(const any_data<Size> & const_data) : const_data_(&const_data) {}
 		};
 
+		template <std::size_t Size>
 		union any_output
 		{
-			any_data * data_;
+			any_data<Size> * data_;
 			utility::type_id_t type_id_;
 			fio::stdostream<ful::heap_string_utf8> * ostream_;
 			const void * const_ptr_;
 
 			any_output() = default;
-			any_output(any_data & data) : data_(&data) {}
+			any_output(any_data<Size> & data) : data_(&data) {}
 			any_output(utility::type_id_t type_id) : type_id_(type_id) {}
 			any_output(fio::stdostream<ful::heap_string_utf8> & ostream) : ostream_(&ostream) {}
 		};
 
-		template <typename T>
+		// the number of values that did not fit in the buffer of their
+		// any, and had to be put on the heap
+		inline std::atomic<std::size_t> & any_spills()
+		{
+			static std::atomic<std::size_t> spills{0};
+			return spills;
+		}
+
+		template <std::size_t Size, typename T>
 		struct any_big;
-		template <typename T>
+		template <std::size_t Size, typename T>
 		struct any_small;
 
+		template <std::size_t Size>
 		struct any_data
 		{
-			using this_type = any_data;
+			using this_type = any_data<Size>;
+
+			static_assert(sizeof(void *) <= Size, "the buffer must be able to hold the pointer to big values");
 
-			using buffer_type = std::aligned_storage_t<sizeof(void *), alignof(void *)>;
+			using buffer_type = std::aligned_storage_t<Size, alignof(void *)>;
 
 			template <typename T>
-			using any_type = mpl::conditional_t<(sizeof(T) <= sizeof(typename any_data::buffer_type) &&
-			                                     alignof(T) <= alignof(typename any_data::buffer_type) &&
+			using any_type = mpl::conditional_t<(sizeof(T) <= sizeof(buffer_type) &&
+			                                     alignof(T) <= alignof(buffer_type) &&
 			                                     std::is_nothrow_move_constructible<T>::value),
-			                                    any_small<T>,
-			                                    any_big<T>>;
+			                                    any_small<Size, T>,
+			                                    any_big<Size, T>>;
 
-			void (* handler_)(any_action action, any_input in, any_output & out);
+			void (* handler_)(any_action action, any_input<Size> in, any_output<Size> & out);
 
 			union
 			{
@@ -80,8 +96,8 @@ namespace utility
 			{
 				if (handler_)
 				{
-					any_input in(*this);
-					any_output out;
+					any_input<Size> in(*this);
+					any_output<Size> out;
 					handler_(any_action::destruct, in, out);
 				}
 			}
@@ -95,8 +111,8 @@ namespace utility
 			{
 				if (other.handler_)
 				{
-					any_input in(other);
-					any_output out(*this);
+					any_input<Size> in(other);
+					any_output<Size> out(*this);
 					other.handler_(any_action::move, in, out);
 					other.handler_ = nullptr;
 				}
@@ -114,8 +130,8 @@ namespace utility
 
 				if (other.handler_)
 				{
-					any_input in(other);
-					any_output out(*this);
+					any_input<Size> in(other);
+					any_output<Size> out(*this);
 					other.handler_(any_action::move, in, out);
 					other.handler_ = nullptr;
 				}
@@ -129,35 +145,35 @@ namespace utility
 					if (this == &other)
 						return; // move from other to this would crash otherwise
 
-					any_data tmp;
+					this_type tmp;
 					{
-						any_input in(*this);
-						any_output out(tmp);
+						any_input<Size> in(*this);
+						any_output<Size> out(tmp);
 						handler_(any_action::move, in, out);
 					}
 					{
-						any_input in(other);
-						any_output out(*this);
+						any_input<Size> in(other);
+						any_output<Size> out(*this);
 						other.handler_(any_action::move, in, out);
 					}
 					{
-						any_input in(tmp);
-						any_output out(other);
+						any_input<Size> in(tmp);
+						any_output<Size> out(other);
 						tmp.handler_(any_action::move, in, out);
 						tmp.handler_ = nullptr;
 					}
 				}
 				else if (handler_)
 				{
-					any_input in(*this);
-					any_output out(other);
+					any_input<Size> in(*this);
+					any_output<Size> out(other);
 					handler_(any_action::move, in, out);
 					handler_ = nullptr;
 				}
 				else if (other.handler_)
 				{
-					any_input in(other);
-					any_output out(*this);
+					any_input<Size> in(other);
+					any_output<Size> out(*this);
 					other.handler_(any_action::move, in, out);
 					other.handler_ = nullptr;
 				}
@@ -173,8 +189,8 @@ namespace utility
 			{
 				if (handler_)
 				{
-					any_input in(*this);
-					any_output out;
+					any_input<Size> in(*this);
+					any_output<Size> out;
 					handler_(any_action::destruct, in, out);
 					handler_ = nullptr;
 				}
@@ -194,8 +210,8 @@ namespace utility
 				if (!handler_)
 					return nullptr;
 
-				any_input in(*this);
-				any_output out(utility::type_id<T>());
+				any_input<Size> in(*this);
+				any_output<Size> out(utility::type_id<T>());
 				handler_(any_action::const_get, in, out);
 				return static_cast<const T *>(out.const_ptr_);
 			}
@@ -205,8 +221,8 @@ namespace utility
 				if (!handler_)
 					return utility::type_id<void>();
 
-				any_input in{};
-				any_output out;
+				any_input<Size> in{};
+				any_output<Size> out;
 				handler_(any_action::none_type_id, in, out);
 				return out.type_id_;
 			}
@@ -216,17 +232,17 @@ namespace utility
 				if (!handler_)
 					return stream << "(empty)";
 
-				any_input in(*this);
-				any_output out(stream);
+				any_input<Size> in(*this);
+				any_output<Size> out(stream);
 				handler_(any_action::const_ostream, in, out);
 				return *out.ostream_;
 			}
 		};
 
-		template <typename T>
+		template <std::size_t Size, typename T>
 		struct any_big
 		{
-			static void handler(any_action action, any_input in, any_output & out)
+			static void handler(any_action action, any_input<Size> in, any_output<Size> & out)
 			{
 				switch (action)
 				{
@@ -235,7 +251,7 @@ namespace utility
 					break;
 				case any_action::move:
 					out.data_->ptr_ = in.data_->ptr_;
-					out.data_->handler_ = &any_big<T>::handler;
+					out.data_->handler_ = &any_big<Size, T>::handler;
 					break;
 				case any_action::none_type_id:
 					out.type_id_ = utility::type_id<T>();
@@ -250,19 +266,21 @@ namespace utility
 			}
 
 			template <typename ...Ps>
-			static T & construct(any_data & data, Ps && ...ps)
+			static T & construct(any_data<Size> & data, Ps && ...ps)
 			{
+				any_spills().fetch_add(1, std::memory_order_relaxed);
+
 				T * ptr = utility::construct_new<T>(std::forward<Ps>(ps)...);
 				data.ptr_ = ptr;
-				data.handler_ = &any_big<T>::handler;
+				data.handler_ = &any_big<Size, T>::handler;
 				return *ptr;
 			}
 		};
 
-		template <typename T>
+		template <std::size_t Size, typename T>
 		struct any_small
 		{
-			static void handler(any_action action, any_input in, any_output & out)
+			static void handler(any_action action, any_input<Size> in, any_output<Size> & out)
 			{
 				switch (action)
 				{
@@ -274,7 +292,7 @@ namespace utility
 					auto & x = utility::construct_at<T>(&out.data_->buffer_, static_cast<T &&>(*static_cast<T *>(static_cast<void *>(&in.data_->buffer_))));
 					fiw_unused(x);
 					fiw_assert(static_cast<void *>(&x) == static_cast<void *>(&out.data_->buffer_)); // [new.delete.placement]§2
-					out.data_->handler_ = &any_small<T>::handler;
+					out.data_->handler_ = &any_small<Size, T>::handler;
 					static_cast<T *>(static_cast<void *>(&in.data_->buffer_))->~T();
 					break;
 				}
@@ -291,10 +309,10 @@ namespace utility
 			}
 
 			template <typename ...Ps>
-			static T & construct(any_data & data, Ps && ...ps)
+			static T & construct(any_data<Size> & data, Ps && ...ps)
 			{
 				T & obj = utility::construct_at<T>(&data.buffer_, std::forward<Ps>(ps)...);
-				data.handler_ = &any_small<T>::handler;
+				data.handler_ = &any_small<Size, T>::handler;
 				return obj;
 			}
 		};
@@ -302,30 +320,33 @@ namespace utility
 		struct any_cast_helper;
 	}
 
-	class any
+	// values that fit in `Size` bytes are stored inline, bigger ones
+	// are put on the heap
+	template <std::size_t Size>
+	class basic_any
 	{
 		friend struct detail::any_cast_helper;
 
-		using this_type = any;
+		using this_type = basic_any<Size>;
 
 	private:
 
-		detail::any_data data_;
+		detail::any_data<Size> data_;
 
 	public:
 
-		any() = default;
+		basic_any() = default;
 
 		template <typename P,
 		          typename T = mpl::decay_t<P>,
 		          REQUIRES((!mpl::is_same<this_type, T>::value))
 		          >
-		explicit any(P && p)
+		explicit basic_any(P && p)
 			: data_(utility::in_place_type<T>, std::forward<P>(p))
 		{}
 
 		template <typename T, typename ...Ps>
-		explicit any(in_place_type_t<T>, Ps && ...ps)
+		explicit basic_any(in_place_type_t<T>, Ps && ...ps)
 			: data_(utility::in_place_type<T>, std::forward<Ps>(ps)...)
 		{}
 
@@ -335,7 +356,7 @@ namespace utility
 		          >
 		this_type & operator = (P && p)
 		{
-			data_ = detail::any_data(utility::in_place_type<T>, std::forward<P>(p));
+			data_ = detail::any_data<Size>(utility::in_place_type<T>, std::forward<P>(p));
 			return *this;
 		}
 
@@ -352,7 +373,7 @@ namespace utility
 		T & emplace(Ps && ...ps)
 		{
 			data_.destroy();
-			return data_.create<T>(std::forward<Ps>(ps)...);
+			return data_.template create<T>(std::forward<Ps>(ps)...);
 		}
 
 		void reset()
@@ -375,11 +396,18 @@ namespace utility
 		}
 	};
 
-	inline void swap(any & x, any & y)
+	template <std::size_t Size>
+	void swap(basic_any<Size> & x, basic_any<Size> & y)
 	{
 		x.swap(y);
 	}
 
+	// the number of values that have been put on the heap by any `any`
+	inline std::size_t any_spill_count()
+	{
+		return detail::any_spills().load(std::memory_order_relaxed);
+	}
+
 	namespace detail
 	{
 		struct any_cast_helper
@@ -392,41 +420,41 @@ namespace utility
 		};
 	}
 
-	template <typename T>
-	T * any_cast(any * x) noexcept
+	template <typename T, std::size_t Size>
+	T * any_cast(basic_any<Size> * x) noexcept
 	{
 		return detail::any_cast_helper{}.any_cast<T>(x);
 	}
-	template <typename T>
-	const T * any_cast(const any * x) noexcept
+	template <typename T, std::size_t Size>
+	const T * any_cast(const basic_any<Size> * x) noexcept
 	{
 		return detail::any_cast_helper{}.any_cast<T>(x);
 	}
 
-	template <typename T,
+	template <typename T, std::size_t Size,
 	          typename U = mpl::remove_cvref_t<T>,
 	          REQUIRES((std::is_constructible<T, U &>::value))>
-	T any_cast(any & x)
+	T any_cast(basic_any<Size> & x)
 	{
 		return static_cast<T>(*any_cast<U>(&x));
 	}
-	template <typename T,
+	template <typename T, std::size_t Size,
 	          typename U = mpl::remove_cvref_t<T>,
 	          REQUIRES((std::is_constructible<T, const U &>::value))>
-	T any_cast(const any & x)
+	T any_cast(const basic_any<Size> & x)
 	{
 		return static_cast<T>(*any_cast<U>(&x));
 	}
-	template <typename T,
+	template <typename T, std::size_t Size,
 	          typename U = mpl::remove_cvref_t<T>,
 	          REQUIRES((std::is_constructible<T, U>::value))>
-	T any_cast(any && x)
+	T any_cast(basic_any<Size> && x)
 	{
 		return static_cast<T>(static_cast<U &&>(*any_cast<U>(&x)));
 	}
 
-	template <typename T>
-	bool holds_alternative(const any & x)
+	template <typename T, std::size_t Size>
+	bool holds_alternative(const basic_any<Size> & x)
 	{
 		return x.type_id() == utility::type_id<T>();
 	}
@@ -0,0 +1,11 @@
+#pragma once
+
+#include <cstddef>
+
+namespace utility
+{
+	template <std::size_t Size>
+	class basic_any;
+
+	using any = basic_any<sizeof(void *)>;
+}
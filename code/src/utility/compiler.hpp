@@ -76,6 +76,21 @@ extern "C" __declspec(noreturn) void __fastfail(unsigned int code);
 # define fiw_likely(x) !!(x)
 #endif
 
+#if defined(__x86_64__) || defined(__i386__)
+// hint to the processor that we are busy waiting
+# define fiw_pause() __builtin_ia32_pause()
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+extern "C" void _mm_pause(void);
+// hint to the processor that we are busy waiting
+# define fiw_pause() _mm_pause()
+#elif defined(__aarch64__) || defined(__arm__)
+// hint to the processor that we are busy waiting
+# define fiw_pause() __asm__ __volatile__("yield")
+#else
+// hint to the processor that we are busy waiting
+# define fiw_pause() static_cast<void>(0)
+#endif
+
 #if __has_builtin(__builtin_unreachable) ||\
 	(defined(__GNUC__) && (__GNUC__ > 4 || (__GNUC__ == 4 && (__GNUC_MINOR__ >= 5))))
 // optimize knowing that this branch is impossible
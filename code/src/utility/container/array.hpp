@@ -282,6 +282,9 @@ namespace utility
 	template <typename ...Ts>
 	using heap_array = array<heap_storage<Ts...>>;
 
+	template <typename ...Ts>
+	using frame_array = array<frame_storage<Ts...>>;
+
 	template <std::size_t Capacity, typename ...Ts>
 	using static_array = array<static_storage<Capacity, Ts...>>;
 }
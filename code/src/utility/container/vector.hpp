@@ -100,6 +100,12 @@ namespace utility
 
 		using StorageTraits = utility::storage_traits<Storage>;
 
+		// trivially relocatable items can be left to the allocator to
+		// move, unless someone asked to be in charge of relocating them
+		using can_reallocate_in_place =
+			mpl::conjunction<std::is_same<RelocationStrategy, utility::relocate_move>,
+			                 typename StorageTraits::unpacked::reallocatable>;
+
 	public:
 		using storage_type = Storage;
 
@@ -218,6 +224,9 @@ namespace utility
 			if (new_capacity < min_capacity)
 				return false;
 
+			if (try_reallocate_in_place(can_reallocate_in_place{}, new_capacity))
+				return true;
+
 			this_type new_data;
 			if (!new_data.allocate(new_capacity))
 				return false;
@@ -231,6 +240,27 @@ namespace utility
 
 			return true;
 		}
+
+		bool try_reallocate_in_place(mpl::false_type /*can reallocate in place*/, std::size_t /*new_capacity*/)
+		{
+			return false;
+		}
+
+		bool try_reallocate_in_place(mpl::true_type /*can reallocate in place*/, std::size_t new_capacity)
+		{
+			const auto old_capacity = this->capacity();
+			if (old_capacity == 0)
+				return false;
+
+			const auto size = this->size();
+			if (!this->storage_.reallocate(old_capacity, new_capacity))
+				return false;
+
+			this->set_cap(this->storage_.place(new_capacity));
+			this->set_end(begin_storage() + size);
+
+			return true;
+		}
 	};
 
 	template <typename Data>
@@ -505,6 +535,12 @@ namespace utility
 	template <typename ...Ts>
 	using heap_vector = vector<heap_storage<Ts...>>;
 
+	template <typename ...Ts>
+	using frame_vector = vector<frame_storage<Ts...>>;
+
+	template <std::size_t Alignment, typename ...Ts>
+	using aligned_heap_vector = vector<aligned_heap_storage<Alignment, Ts...>>;
+
 	template <std::size_t Capacity, typename ...Ts>
 	using static_vector = vector<static_storage<Capacity, Ts...>>;
 }
@@ -3,10 +3,52 @@
 #include "utility/compiler.hpp"
 #include "utility/ext/stddef.hpp"
 
+#include <errno.h>
 #include <unistd.h>
 
 namespace ext
 {
+	// fd - blocking file descriptor
+	inline ssize pread_some_nonzero(int fd, void * buffer, usize size, usize offset)
+	{
+		if (!fiw_expect(size != 0))
+			return 0;
+
+	try_again:
+		const ssize n = ::pread(fd, buffer, size, offset);
+		if (n < 0)
+		{
+			if (errno == EINTR)
+				goto try_again;
+		}
+		return n;
+	}
+
+	// fd - blocking file descriptor
+	//
+	// reads less than size only on errors, or if the file ends
+	inline usize pread_all_nonzero(int fd, void * buffer, usize size, usize offset)
+	{
+		char * ptr = static_cast<char *>(buffer);
+		usize remaining = size;
+
+		do
+		{
+			fiw_assert(remaining <= size);
+
+			const ssize n = pread_some_nonzero(fd, ptr, remaining, offset + (size - remaining));
+			if (n <= 0)
+				break;
+
+			fiw_assert(static_cast<usize>(n) <= remaining);
+			ptr += n;
+			remaining -= n;
+		}
+		while (0 < remaining);
+
+		return size - remaining;
+	}
+
 	// fd - blocking file descriptor
 	inline ssize write_some_nonzero(int fd, const void * buffer, usize size)
 	{
@@ -0,0 +1,214 @@
+#ifndef UTILITY_FRAME_ALLOCATOR_HPP
+#define UTILITY_FRAME_ALLOCATOR_HPP
+
+#include "utility/utility.hpp"
+
+#include <cstddef>
+#include <new>
+
+namespace utility
+{
+	// linear arena for data that does not outlive the current frame,
+	// allocating is bumping a pointer and deallocating is (mostly) free,
+	// everything is given back at once by `reset`
+	//
+	// allocations that do not fit in the arena are forwarded to the
+	// heap, and the arena is grown at the next reset to fit everything
+	// that was asked of it during the frame
+	//
+	// the render threads reset their arena after every frame, other
+	// threads that allocate from it have to do the same
+	class frame_arena
+	{
+	public:
+		enum : std::size_t { default_capacity = std::size_t(1) << 20 };
+
+		struct statistics
+		{
+			// the number of bytes in use right now
+			std::size_t used;
+			// the most bytes that were in use at once
+			std::size_t peak;
+			std::size_t allocations;
+			// the number of allocations that did not fit in the arena
+			std::size_t overflows;
+			std::size_t overflow_bytes;
+		};
+
+	private:
+		char * begin_ = nullptr;
+		char * top_ = nullptr;
+		char * end_ = nullptr;
+
+		statistics frame_ = {};
+		statistics last_frame_ = {};
+
+	public:
+		~frame_arena()
+		{
+			::operator delete(begin_, std::nothrow);
+		}
+		frame_arena() = default;
+		frame_arena(const frame_arena &) = delete;
+		frame_arena & operator = (const frame_arena &) = delete;
+
+	public:
+		std::size_t capacity() const { return end_ - begin_; }
+
+		// statistics of the frame in progress
+		const statistics & current_frame() const { return frame_; }
+		// statistics of the frame that ended with the last reset
+		const statistics & last_frame() const { return last_frame_; }
+
+		bool owns(const void * p) const
+		{
+			return begin_ <= static_cast<const char *>(p) && static_cast<const char *>(p) < end_;
+		}
+
+		void * allocate(std::size_t size)
+		{
+			const std::size_t rounded = round_up(size);
+
+			if (!begin_)
+			{
+				fiw_unused(reserve(default_capacity));
+			}
+
+			frame_.allocations++;
+
+			if (rounded <= static_cast<std::size_t>(end_ - top_))
+			{
+				void * const p = top_;
+				top_ += rounded;
+
+				frame_.used = top_ - begin_;
+				if (frame_.peak < frame_.used)
+				{
+					frame_.peak = frame_.used;
+				}
+				return p;
+			}
+
+			frame_.overflows++;
+			frame_.overflow_bytes += rounded;
+			return ::operator new(size, std::nothrow);
+		}
+
+		void deallocate(void * p, std::size_t size)
+		{
+			if (!owns(p))
+			{
+				::operator delete(p, std::nothrow);
+				return;
+			}
+
+			// only the latest allocation can be given back, anything
+			// else stays taken until the next reset
+			if (static_cast<char *>(p) + round_up(size) == top_)
+			{
+				top_ = static_cast<char *>(p);
+				frame_.used = top_ - begin_;
+			}
+		}
+
+		// replaces the arena with one of the given capacity, fails if
+		// some of it is still in use
+		bool reserve(std::size_t capacity)
+		{
+			if (top_ != begin_)
+				return false;
+
+			char * const begin = static_cast<char *>(::operator new(round_up(capacity), std::nothrow));
+			if (!begin)
+				return false;
+
+			::operator delete(begin_, std::nothrow);
+
+			begin_ = begin;
+			top_ = begin;
+			end_ = begin + round_up(capacity);
+			return true;
+		}
+
+		// ends the frame, everything allocated from the arena during
+		// the frame must be dead by now
+		void reset()
+		{
+			top_ = begin_;
+
+			if (frame_.overflows > 0)
+			{
+				std::size_t capacity = this->capacity();
+				while (capacity < frame_.peak + frame_.overflow_bytes)
+				{
+					capacity = capacity ? capacity * 2 : std::size_t(default_capacity);
+				}
+				fiw_unused(reserve(capacity));
+			}
+
+			last_frame_ = frame_;
+			frame_ = statistics{};
+		}
+
+		// the arena of the calling thread, memory allocated from it must
+		// be deallocated from the same thread
+		static frame_arena & this_thread()
+		{
+			thread_local frame_arena arena;
+			return arena;
+		}
+
+	private:
+		static std::size_t round_up(std::size_t size)
+		{
+			// every allocation is aligned for fundamental types, and has
+			// at least one byte so that no two allocations share address
+			constexpr std::size_t alignment = alignof(std::max_align_t);
+			return size ? (size + (alignment - 1)) & ~(alignment - 1) : alignment;
+		}
+	};
+
+	// allocates from the frame arena of the calling thread
+	template <typename T>
+	class frame_allocator
+	{
+	public:
+		using size_type = std::size_t;
+		using difference_type = std::ptrdiff_t;
+		using pointer = T *;
+		using const_pointer = const T *;
+		using reference = T &;
+		using const_reference = const T &;
+		using value_type = T;
+
+		template <typename U>
+		struct rebind { using other = frame_allocator<U>; };
+
+		using propagate_on_container_move_assignment = std::true_type;
+
+		pointer address(reference x) const { return std::addressof(x); }
+		const_pointer address(const_reference x) const { return std::addressof(x); }
+
+		pointer allocate(size_type n, const void * = nullptr)
+		{
+			if (n > max_size())
+				return nullptr;
+
+			static_assert(alignof(T) <= alignof(std::max_align_t), "the frame arena only guarantees correct alignment for fundamental types");
+			return static_cast<T *>(frame_arena::this_thread().allocate(n * sizeof(T)));
+		}
+		void deallocate(pointer p, size_type n)
+		{
+			frame_arena::this_thread().deallocate(p, n * sizeof(T));
+		}
+
+		constexpr size_type max_size() const { return size_t(-1) / sizeof(T); }
+
+		template <typename U, typename ...Ps>
+		void construct(U * p, Ps && ...ps) { utility::construct_at<U>(p, std::forward<Ps>(ps)...); }
+		template <typename U>
+		void destroy(U * p) { p->U::~U(); }
+	};
+}
+
+#endif /* UTILITY_FRAME_ALLOCATOR_HPP */
@@ -4,6 +4,8 @@
 
 #include "utility/utility.hpp"
 
+#include <cstdlib>
+
 namespace utility
 {
 	template <typename T>
@@ -31,12 +33,33 @@ namespace utility
 			if (n > max_size())
 				return nullptr;
 
-			static_assert(alignof(T) <= alignof(std::max_align_t), "operator new only guarantees correct alignment for fundamental types");
-			return static_cast<T *>(::operator new(n * sizeof(T), std::nothrow));
+			static_assert(alignof(T) <= alignof(std::max_align_t), "malloc only guarantees correct alignment for fundamental types");
+			return static_cast<T *>(std::malloc(n > 0 ? n * sizeof(T) : 1));
 		}
 		void deallocate(pointer p, size_type)
 		{
-			::operator delete(p, std::nothrow);
+			std::free(p);
+		}
+		// grows (or shrinks) the allocation, the contents are kept but
+		// may have moved, on failure the old allocation is left as is
+		//
+		// note large allocations are mapped memory which realloc grows
+		// by remapping pages, rather than by copying them
+		//
+		// note the call is kept out of line, as gcc 12 otherwise sinks
+		// reads of the old allocation past realloc and then rejects them
+		// with -Wuse-after-free
+#if defined(__GNUC__)
+		__attribute__((noinline))
+#elif defined(_MSC_VER)
+		__declspec(noinline)
+#endif
+		pointer reallocate(pointer p, size_type, size_type n)
+		{
+			if (n > max_size())
+				return nullptr;
+
+			return static_cast<T *>(std::realloc(p, n > 0 ? n * sizeof(T) : 1));
 		}
 
 		constexpr size_type max_size() const { return size_t(-1) / sizeof(T); }
@@ -0,0 +1,273 @@
+#ifndef UTILITY_POOL_ALLOCATOR_HPP
+#define UTILITY_POOL_ALLOCATOR_HPP
+
+#include "utility/compiler.hpp"
+#include "utility/ext/stddef.hpp"
+#include "utility/utility.hpp"
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+
+namespace utility
+{
+	// hands out blocks of a single size, carved from slabs that are
+	// never given back to the system (until the pool itself dies, and
+	// only if nothing is still alive by then)
+	//
+	// every thread keeps a cache of free blocks, so that allocating and
+	// deallocating are mostly plain list operations, and only trades
+	// blocks with the shared free list in batches
+	//
+	// the shared free list is lock free, blocks are pushed onto it and
+	// the whole list is taken at once, which leaves no room for the ABA
+	// problem
+	template <std::size_t BlockSize>
+	class slab_pool
+	{
+		static_assert(BlockSize % alignof(std::max_align_t) == 0, "blocks must keep the alignment of the slab");
+
+	public:
+		enum : std::size_t
+		{
+			block_size = BlockSize,
+			blocks_per_slab = BlockSize * 64 < 16384 ? 16384 / BlockSize : 64,
+			// the number of free blocks a thread may keep for itself
+			cache_limit = 64,
+		};
+
+		struct statistics
+		{
+			std::size_t live;
+			std::size_t peak;
+			std::size_t slabs;
+		};
+
+	private:
+		struct node
+		{
+			node * next;
+		};
+
+		struct alignas(std::max_align_t) slab
+		{
+			slab * next;
+		};
+
+		// the free blocks owned by one thread, given back to the pool
+		// when the thread exits
+		struct cache
+		{
+			node * head = nullptr;
+			std::size_t count = 0;
+
+			~cache()
+			{
+				if (head)
+				{
+					instance().push(head);
+				}
+			}
+		};
+
+	private:
+		std::atomic<node *> free_{nullptr};
+		std::atomic<slab *> slabs_{nullptr};
+
+		std::atomic<std::size_t> live_{0};
+		std::atomic<std::size_t> peak_{0};
+		std::atomic<std::size_t> slab_count_{0};
+
+	public:
+		~slab_pool()
+		{
+			// blocks that are still alive (in statics that are destroyed
+			// after the pool) keep their slabs
+			if (live_.load(std::memory_order_relaxed) != 0)
+				return;
+
+			slab * s = slabs_.load(std::memory_order_relaxed);
+			while (s)
+			{
+				::operator delete(std::exchange(s, s->next), std::nothrow);
+			}
+		}
+		slab_pool() = default;
+		slab_pool(const slab_pool &) = delete;
+		slab_pool & operator = (const slab_pool &) = delete;
+
+	public:
+		statistics stats() const
+		{
+			return statistics{
+				live_.load(std::memory_order_relaxed),
+				peak_.load(std::memory_order_relaxed),
+				slab_count_.load(std::memory_order_relaxed)};
+		}
+
+		void * allocate()
+		{
+			cache & local = local_cache();
+			if (!local.head)
+			{
+				local.count = count(local.head = free_.exchange(nullptr, std::memory_order_acquire));
+
+				if (!local.head && !grow(local))
+					return nullptr;
+			}
+
+			node * const n = local.head;
+			local.head = n->next;
+			local.count--;
+
+			const std::size_t live = live_.fetch_add(1, std::memory_order_relaxed) + 1;
+			std::size_t peak = peak_.load(std::memory_order_relaxed);
+			while (peak < live && !peak_.compare_exchange_weak(peak, live, std::memory_order_relaxed));
+
+			return n;
+		}
+
+		void deallocate(void * p)
+		{
+			live_.fetch_sub(1, std::memory_order_relaxed);
+
+			cache & local = local_cache();
+			node * const n = static_cast<node *>(p);
+			n->next = local.head;
+			local.head = n;
+			local.count++;
+
+			if (local.count > 2 * cache_limit)
+			{
+				// keep the most recently freed blocks, they are the most
+				// likely to still be in the cache
+				node * last = local.head;
+				for (std::size_t i = 1; i < cache_limit; i++)
+				{
+					last = last->next;
+				}
+				push(std::exchange(last->next, nullptr));
+				local.count = cache_limit;
+			}
+		}
+
+		static slab_pool & instance()
+		{
+			static slab_pool pool;
+			return pool;
+		}
+
+	private:
+		bool grow(cache & local)
+		{
+			slab * const s = static_cast<slab *>(::operator new(sizeof(slab) + blocks_per_slab * block_size, std::nothrow));
+			if (!s)
+				return false;
+
+			s->next = slabs_.load(std::memory_order_relaxed);
+			while (!slabs_.compare_exchange_weak(s->next, s, std::memory_order_release, std::memory_order_relaxed));
+			slab_count_.fetch_add(1, std::memory_order_relaxed);
+
+			char * const blocks = reinterpret_cast<char *>(s + 1);
+			for (std::size_t i = blocks_per_slab; i-- > 0;)
+			{
+				node * const n = reinterpret_cast<node *>(blocks + i * block_size);
+				n->next = local.head;
+				local.head = n;
+			}
+			local.count = blocks_per_slab;
+			return true;
+		}
+
+		void push(node * first)
+		{
+			node * last = first;
+			while (last->next)
+			{
+				last = last->next;
+			}
+
+			last->next = free_.load(std::memory_order_relaxed);
+			while (!free_.compare_exchange_weak(last->next, first, std::memory_order_release, std::memory_order_relaxed));
+		}
+
+		static std::size_t count(node * n)
+		{
+			std::size_t count = 0;
+			for (; n; n = n->next)
+			{
+				count++;
+			}
+			return count;
+		}
+
+		static cache & local_cache()
+		{
+			// the pool is constructed before the cache so that it is
+			// destroyed after it
+			fiw_unused(instance());
+
+			thread_local cache local;
+			return local;
+		}
+	};
+
+	// allocates single objects from the slab pool of their size, and
+	// arrays from the heap
+	template <typename T>
+	class pool_allocator
+	{
+	public:
+		using size_type = std::size_t;
+		using difference_type = std::ptrdiff_t;
+		using pointer = T *;
+		using const_pointer = const T *;
+		using reference = T &;
+		using const_reference = const T &;
+		using value_type = T;
+
+		template <typename U>
+		struct rebind { using other = pool_allocator<U>; };
+
+		using propagate_on_container_move_assignment = std::true_type;
+
+		using pool_type = slab_pool<(sizeof(T) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t)>;
+
+		pointer address(reference x) const { return std::addressof(x); }
+		const_pointer address(const_reference x) const { return std::addressof(x); }
+
+		pointer allocate(size_type n, const void * = nullptr)
+		{
+			if (n > max_size())
+				return nullptr;
+
+			static_assert(alignof(T) <= alignof(std::max_align_t), "the pool only guarantees correct alignment for fundamental types");
+			if (n == 1)
+				return static_cast<T *>(pool_type::instance().allocate());
+
+			return static_cast<T *>(::operator new(n * sizeof(T), std::nothrow));
+		}
+		void deallocate(pointer p, size_type n)
+		{
+			if (n == 1)
+			{
+				pool_type::instance().deallocate(p);
+			}
+			else
+			{
+				::operator delete(p, std::nothrow);
+			}
+		}
+
+		constexpr size_type max_size() const { return size_t(-1) / sizeof(T); }
+
+		template <typename U, typename ...Ps>
+		void construct(U * p, Ps && ...ps) { utility::construct_at<U>(p, std::forward<Ps>(ps)...); }
+		template <typename U>
+		void destroy(U * p) { p->U::~U(); }
+
+		static typename pool_type::statistics stats() { return pool_type::instance().stats(); }
+	};
+}
+
+#endif /* UTILITY_POOL_ALLOCATOR_HPP */
@@ -3,6 +3,7 @@
 #include "utility/compiler.hpp"
 #include "utility/ext/stddef.hpp"
 #include "utility/heap_allocator.hpp"
+#include "utility/pool_allocator.hpp"
 #include "utility/storing.hpp"
 
 #include <atomic>
@@ -203,4 +204,6 @@ namespace ext
 
 	template <typename T>
 	using heap_shared_ptr = shared_ptr<utility::heap_allocator, T>;
+	template <typename T>
+	using pool_shared_ptr = shared_ptr<utility::pool_allocator, T>;
 }
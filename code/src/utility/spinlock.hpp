@@ -1,26 +1,227 @@
-
 #ifndef UTILITY_SPINLOCK_HPP
 #define UTILITY_SPINLOCK_HPP
 
+#include "utility/compiler.hpp"
+
 #include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
 
 namespace utility
 {
-	class spinlock
+	namespace detail
+	{
+		// waits a little longer every time it is called, until the wait
+		// gets long enough that it is better to give the time slice to
+		// someone else (hopefully the lock holder)
+		class spinlock_backoff
+		{
+			enum : std::uint32_t { max_pauses = 64 };
+
+		private:
+			std::uint32_t pauses_ = 1;
+
+		public:
+			void operator () ()
+			{
+				if (pauses_ <= max_pauses)
+				{
+					for (std::uint32_t i = 0; i < pauses_; i++)
+					{
+						fiw_pause();
+					}
+					pauses_ <<= 1;
+				}
+				else
+				{
+					std::this_thread::yield();
+				}
+			}
+		};
+	}
+
+	class no_spinlock_stats
+	{
+	protected:
+		struct wait_start {};
+
+		wait_start start_wait() const { return wait_start{}; }
+
+		void record() {}
+		void record(std::uint32_t /*spins*/, wait_start /*start*/) {}
+	};
+
+	// keeps count of how the lock is used, the counters are only ever
+	// written to by the lock holder so reading them is cheap but the
+	// values may be slightly out of date
+	class spinlock_stats
+	{
+	public:
+		struct values
+		{
+			std::uint64_t acquisitions;
+			// the number of acquisitions that had to wait
+			std::uint64_t contended;
+			// the total number of backoff rounds
+			std::uint64_t spins;
+			// the total time spent waiting
+			std::uint64_t wait_nanoseconds;
+			// the longest time a single acquisition had to wait
+			std::uint64_t max_wait_nanoseconds;
+		};
+
+	private:
+		std::atomic<std::uint64_t> acquisitions_{0};
+		std::atomic<std::uint64_t> contended_{0};
+		std::atomic<std::uint64_t> spins_{0};
+		std::atomic<std::uint64_t> wait_nanoseconds_{0};
+		std::atomic<std::uint64_t> max_wait_nanoseconds_{0};
+
+	public:
+		values stats() const
+		{
+			return values{
+				acquisitions_.load(std::memory_order_relaxed),
+				contended_.load(std::memory_order_relaxed),
+				spins_.load(std::memory_order_relaxed),
+				wait_nanoseconds_.load(std::memory_order_relaxed),
+				max_wait_nanoseconds_.load(std::memory_order_relaxed)};
+		}
+
+	protected:
+		// note the clock is only read by acquisitions that have to wait
+		using wait_start = std::chrono::steady_clock::time_point;
+
+		wait_start start_wait() const { return std::chrono::steady_clock::now(); }
+
+		void record()
+		{
+			acquisitions_.store(acquisitions_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+		}
+
+		void record(std::uint32_t spins, wait_start start)
+		{
+			const std::uint64_t nanoseconds = static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+
+			acquisitions_.store(acquisitions_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			contended_.store(contended_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			spins_.store(spins_.load(std::memory_order_relaxed) + spins, std::memory_order_relaxed);
+			wait_nanoseconds_.store(wait_nanoseconds_.load(std::memory_order_relaxed) + nanoseconds, std::memory_order_relaxed);
+			if (max_wait_nanoseconds_.load(std::memory_order_relaxed) < nanoseconds)
+			{
+				max_wait_nanoseconds_.store(nanoseconds, std::memory_order_relaxed);
+			}
+		}
+	};
+
+	// test and test-and-set lock, waiters only read the flag while it
+	// is taken so they do not steal the cache line from the holder
+	template <typename Stats>
+	class basic_spinlock
+		: public Stats
+	{
+	private:
+		std::atomic<bool> locked_{false};
+
+	public:
+		bool try_lock()
+		{
+			if (locked_.load(std::memory_order_relaxed) || locked_.exchange(true, std::memory_order_acquire))
+				return false;
+
+			this->record();
+			return true;
+		}
+
+		void lock()
+		{
+			if (!locked_.exchange(true, std::memory_order_acquire))
+			{
+				this->record();
+				return;
+			}
+
+			const auto start = this->start_wait();
+
+			std::uint32_t spins = 0;
+			detail::spinlock_backoff backoff;
+			do
+			{
+				do
+				{
+					backoff();
+					spins++;
+				}
+				while (locked_.load(std::memory_order_relaxed));
+			}
+			while (locked_.exchange(true, std::memory_order_acquire));
+			this->record(spins, start);
+		}
+
+		void unlock()
+		{
+			locked_.store(false, std::memory_order_release);
+		}
+	};
+
+	// fair lock, waiters get the lock in the order they arrived
+	//
+	// a waiter that is not running blocks everyone behind it, so this
+	// lock is a poor choice when there are more threads than cores, the
+	// backoff eventually yields which keeps it from being a disaster
+	template <typename Stats>
+	class basic_ticket_spinlock
+		: public Stats
 	{
 	private:
-		std::atomic_flag flag = ATOMIC_FLAG_INIT;
+		std::atomic<std::uint32_t> next_{0};
+		std::atomic<std::uint32_t> serving_{0};
 
 	public:
+		bool try_lock()
+		{
+			std::uint32_t serving = serving_.load(std::memory_order_relaxed);
+			if (!next_.compare_exchange_strong(serving, serving + 1, std::memory_order_acquire, std::memory_order_relaxed))
+				return false;
+
+			this->record();
+			return true;
+		}
+
 		void lock()
 		{
-			while (this->flag.test_and_set());
+			const std::uint32_t ticket = next_.fetch_add(1, std::memory_order_relaxed);
+			if (serving_.load(std::memory_order_acquire) == ticket)
+			{
+				this->record();
+				return;
+			}
+
+			const auto start = this->start_wait();
+
+			std::uint32_t spins = 0;
+			detail::spinlock_backoff backoff;
+			do
+			{
+				backoff();
+				spins++;
+			}
+			while (serving_.load(std::memory_order_acquire) != ticket);
+			this->record(spins, start);
 		}
+
 		void unlock()
 		{
-			this->flag.clear();
+			serving_.store(serving_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
 		}
 	};
+
+	using spinlock = basic_spinlock<no_spinlock_stats>;
+	using ticket_spinlock = basic_ticket_spinlock<no_spinlock_stats>;
+
+	using instrumented_spinlock = basic_spinlock<spinlock_stats>;
+	using instrumented_ticket_spinlock = basic_ticket_spinlock<spinlock_stats>;
 }
 
 #endif /* UTILITY_SPINLOCK_HPP */
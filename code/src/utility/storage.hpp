@@ -1,11 +1,13 @@
 #pragma once
 
 #include "utility/aggregation_allocator.hpp"
+#include "utility/aligned_allocator.hpp"
 #include "utility/algorithm.hpp"
 #include "utility/annotate.hpp"
 #include "utility/bitmanip.hpp"
 #include "utility/compound.hpp"
 #include "utility/ext/stddef.hpp"
+#include "utility/frame_allocator.hpp"
 #include "utility/heap_allocator.hpp"
 #include "utility/iterator.hpp"
 #include "utility/null_allocator.hpp"
@@ -23,6 +25,12 @@ namespace utility
 	};
 	constexpr zero_initialize_t zero_initialize = zero_initialize_t{};
 
+	// types that can be moved to a new address by copying their bytes,
+	// and then forgetting about the old ones, specialize it for types
+	// that are not trivially copyable but do not care where they live
+	template <typename T>
+	struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
 	template <std::size_t Capacity, typename ...Ts>
 	class static_storage_impl
 	{
@@ -67,6 +75,8 @@ namespace utility
 			           mpl::transform<std::is_trivially_default_constructible,
 			                          utility::storing<Ts>...>>;
 
+		using reallocatable = mpl::false_type;
+
 	private:
 		utility::tuple<std::array<storing_type_for<Ts>, Capacity>...> arrays;
 
@@ -299,6 +309,10 @@ namespace utility
 			           mpl::transform<std::is_trivially_default_constructible,
 			                          Ts...>>;
 
+		using reallocatable =
+			mpl::conjunction<is_trivially_relocatable<Ts>...,
+			                 can_reallocate<allocator_type>>;
+
 	private:
 		using allocator_traits = std::allocator_traits<allocator_type>;
 
@@ -360,6 +374,22 @@ namespace utility
 #endif
 		}
 
+		template <typename Reallocatable = reallocatable,
+		          REQUIRES((Reallocatable::value))>
+		annotate_nodiscard
+		bool reallocate(std::size_t old_capacity, std::size_t new_capacity)
+		{
+#if defined(_DEBUG) || !defined(NDEBUG)
+			fiw_assert(storage());
+#endif
+			void * const new_storage = allocator().reallocate(storage(), old_capacity, new_capacity);
+			if (!new_storage)
+				return false;
+
+			storage() = new_storage;
+			return true;
+		}
+
 		template <typename T, typename ...Ps>
 		T & construct_at(T * ptr_, Ps && ...ps)
 		{
@@ -606,6 +636,8 @@ namespace utility
 			using position = typename storage_type::position;
 			using const_position = typename storage_type::const_position;
 
+			using reallocatable = typename storage_type::reallocatable;
+
 		private:
 			unpacked_dynamic_storage_data<Allocator, Ts...> data_;
 
@@ -629,6 +661,18 @@ namespace utility
 				return data_.storage_.deallocate(capacity);
 			}
 
+			template <typename Reallocatable = reallocatable,
+			          REQUIRES((Reallocatable::value))>
+			annotate_nodiscard
+			bool reallocate(std::size_t old_capacity, std::size_t new_capacity)
+			{
+				if (!data_.storage_.reallocate(old_capacity, new_capacity))
+					return false;
+
+				data_.set(data_.storage_.begin(new_capacity));
+				return true;
+			}
+
 			template <typename T, typename ...Ps>
 			T & construct_at(T * ptr_, Ps && ...ps)
 			{
@@ -1012,6 +1056,14 @@ namespace utility
 
 	template <typename ...Ts>
 	using heap_storage = dynamic_storage<utility::heap_allocator, Ts...>;
+	template <typename ...Ts>
+	using frame_storage = dynamic_storage<utility::frame_allocator, Ts...>;
+	// every array starts on a multiple of `Alignment`, e.g.
+	// `simd_alignment` for aligned vector loads, `cache_line_alignment`
+	// to keep arrays from sharing cache lines, or `page_alignment` for
+	// big buffers
+	template <std::size_t Alignment, typename ...Ts>
+	using aligned_heap_storage = dynamic_storage<utility::aligned_to<Alignment>::template allocator, Ts...>;
 
 	template <typename Storage>
 	struct storage_traits;
@@ -1067,6 +1119,9 @@ namespace utility
 	template <template <typename> class Allocator>
 	using dynamic_storage_traits = storage_traits<dynamic_storage<Allocator, int>>; // todo remove int?
 	using heap_storage_traits = dynamic_storage_traits<heap_allocator>;
+	using frame_storage_traits = dynamic_storage_traits<frame_allocator>;
+	template <std::size_t Alignment>
+	using aligned_heap_storage_traits = dynamic_storage_traits<aligned_to<Alignment>::template allocator>;
 	using null_storage_traits = dynamic_storage_traits<null_allocator>;
 
 	template <typename Storage>
@@ -155,4 +155,6 @@ namespace ext
 
 	template <typename T>
 	using heap_weak_ptr = weak_ptr<utility::heap_allocator, T>;
+	template <typename T>
+	using pool_weak_ptr = weak_ptr<utility::pool_allocator, T>;
 }
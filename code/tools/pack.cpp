@@ -0,0 +1,157 @@
+#include "config.h"
+
+#include "engine/file/archive.hpp"
+
+#include "ful/string_modify.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+
+#if FILE_SYSTEM_USE_POSIX
+# include <ftw.h>
+#endif
+
+// packs all files in a directory into an archive
+//
+//   fiwpack <directory> <archive>
+//
+// the files are named by their path relative to the directory, and are
+// read by registering the archive with `engine::file::register_archive`
+
+namespace
+{
+	engine::file::archive_builder builder;
+	std::size_t root_size = 0;
+
+#if FILE_SYSTEM_USE_POSIX
+	int collect(const char * fpath, const struct stat * sb, int typeflag, struct FTW * /*ftwbuf*/)
+	{
+		if (typeflag != FTW_F)
+			return 0;
+
+		const char * const name = fpath + root_size;
+		if (!builder.add(ful::view_utf8(name, std::strlen(name)), static_cast<ext::usize>(sb->st_size)))
+			return -1;
+
+		return 0;
+	}
+#endif
+
+	bool pad(std::FILE * file, std::uint64_t from, std::uint64_t to)
+	{
+		static const char zeros[engine::file::archive_alignment] = {};
+
+		return std::fwrite(zeros, 1, static_cast<std::size_t>(to - from), file) == to - from;
+	}
+
+	bool copy(std::FILE * file, const char * filepath, std::uint64_t size)
+	{
+		std::FILE * const from = std::fopen(filepath, "rb");
+		if (!from)
+		{
+			std::fprintf(stderr, "failed to open \"%s\"\n", filepath);
+			return false;
+		}
+
+		char buffer[1 << 16];
+		std::uint64_t remaining = size;
+		while (remaining > 0)
+		{
+			const std::size_t amount = std::fread(buffer, 1, remaining < sizeof buffer ? static_cast<std::size_t>(remaining) : sizeof buffer, from);
+			if (amount == 0)
+				break;
+
+			if (std::fwrite(buffer, 1, amount, file) != amount)
+				break;
+
+			remaining -= amount;
+		}
+
+		// note the file must not have changed since it was collected
+		const bool ok = remaining == 0 && std::fgetc(from) == EOF;
+		if (!ok)
+		{
+			std::fprintf(stderr, "failed to copy \"%s\", has it changed?\n", filepath);
+		}
+
+		std::fclose(from);
+		return ok;
+	}
+}
+
+int main(int argc, char * argv[])
+{
+	if (argc != 3)
+	{
+		std::fprintf(stderr, "usage: %s <directory> <archive>\n", argv[0]);
+		return 1;
+	}
+
+	ful::heap_string_utf8 filepath;
+	if (!ful::append(filepath, argv[1], argv[1] + std::strlen(argv[1])))
+		return 1;
+
+	if (filepath.end()[-1] != '/')
+	{
+		if (!ful::push_back(filepath, ful::char8{'/'}))
+			return 1;
+	}
+	root_size = filepath.size();
+
+#if FILE_SYSTEM_USE_POSIX
+	if (::nftw(argv[1], collect, 16, FTW_PHYS) != 0)
+	{
+		std::fprintf(stderr, "failed to collect the files in \"%s\"\n", argv[1]);
+		return 1;
+	}
+#else
+	std::fprintf(stderr, "packing is not supported on this platform yet\n");
+	return 1;
+#endif
+
+	if (!builder.finish())
+		return 1;
+
+	std::unique_ptr<char[]> index(new char[builder.index_size()]);
+	builder.write_index(index.get());
+
+	std::FILE * const file = std::fopen(argv[2], "wb");
+	if (!file)
+	{
+		std::fprintf(stderr, "failed to open \"%s\"\n", argv[2]);
+		return 1;
+	}
+
+	bool ok = std::fwrite(index.get(), 1, builder.index_size(), file) == builder.index_size();
+
+	std::uint64_t offset = builder.index_size();
+	for (const engine::file::archive_entry & entry : builder)
+	{
+		if (!ok)
+			break;
+
+		const ful::view_utf8 name = builder.name(entry);
+
+		ful::reduce(filepath, filepath.begin() + root_size);
+		ok = ful::append(filepath, name.begin(), name.end())
+			&& pad(file, offset, entry.offset)
+			&& copy(file, filepath.data(), entry.size);
+
+		offset = entry.offset + entry.size;
+	}
+
+	if (std::fclose(file) != 0)
+	{
+		ok = false;
+	}
+
+	if (!ok)
+	{
+		std::fprintf(stderr, "failed to pack \"%s\"\n", argv[2]);
+		std::remove(argv[2]);
+		return 1;
+	}
+
+	return 0;
+}
@@ -2,6 +2,9 @@
 
 #include <catch2/catch.hpp>
 
+#include <algorithm>
+#include <vector>
+
 namespace
 {
 	struct get_value
@@ -183,3 +186,436 @@ TEST_CASE("collection static_storage", "[core][container]")
 		CHECK(it == ints.end());
 	}
 }
+
+TEST_CASE("collection with many keys", "[core][container]")
+{
+	core::container::Collection
+	<
+		unsigned int,
+		utility::heap_storage_traits,
+		utility::heap_storage<int>
+	>
+	collection;
+
+	for (unsigned int key = 1; key <= 10000; key++)
+	{
+		REQUIRE(collection.emplace<int>(key, static_cast<int>(key)));
+	}
+	CHECK(collection.get<int>().size() == 10000);
+	CHECK(collection.table_size() <= 16384);
+
+	SECTION("finds all of them")
+	{
+		for (unsigned int key = 1; key <= 10000; key++)
+		{
+			const auto it = find(collection, key);
+			REQUIRE(it != collection.end());
+			REQUIRE(collection.get<int>(it));
+			CHECK(*collection.get<int>(it) == static_cast<int>(key));
+		}
+		CHECK(find(collection, 10001u) == collection.end());
+	}
+
+	SECTION("finds the remaining ones after erasing")
+	{
+		for (unsigned int key = 1; key <= 10000; key += 2)
+		{
+			collection.erase(find(collection, key));
+		}
+		CHECK(collection.get<int>().size() == 5000);
+
+		for (unsigned int key = 1; key <= 10000; key++)
+		{
+			const auto it = find(collection, key);
+			if (key % 2 == 1)
+			{
+				CHECK(it == collection.end());
+			}
+			else
+			{
+				REQUIRE(it != collection.end());
+				REQUIRE(collection.get<int>(it));
+				CHECK(*collection.get<int>(it) == static_cast<int>(key));
+			}
+		}
+	}
+}
+
+TEST_CASE("collection reuses erased buckets", "[core][container]")
+{
+	SECTION("without growing")
+	{
+		core::container::Collection
+		<
+			unsigned int,
+			utility::heap_storage_traits,
+			utility::heap_storage<int>
+		>
+		collection;
+
+		for (unsigned int key = 1; key <= 90; key++)
+		{
+			REQUIRE(collection.emplace<int>(key, static_cast<int>(key)));
+		}
+		const auto table_size = collection.table_size();
+
+		for (unsigned int key = 91; key <= 10000; key++)
+		{
+			collection.erase(find(collection, key - 90));
+			REQUIRE(collection.emplace<int>(key, static_cast<int>(key)));
+		}
+		CHECK(collection.table_size() == table_size);
+
+		for (unsigned int key = 9911; key <= 10000; key++)
+		{
+			const auto it = find(collection, key);
+			REQUIRE(it != collection.end());
+			CHECK(*collection.get<int>(it) == static_cast<int>(key));
+		}
+	}
+
+	SECTION("when the table cannot grow")
+	{
+		core::container::Collection
+		<
+			unsigned int,
+			utility::static_storage_traits<40>,
+			utility::static_storage<32, int>
+		>
+		collection;
+
+		for (unsigned int key = 1; key <= 32; key++)
+		{
+			REQUIRE(collection.emplace<int>(key, static_cast<int>(key)));
+		}
+
+		for (unsigned int key = 33; key <= 1000; key++)
+		{
+			collection.erase(find(collection, key - 32));
+			REQUIRE(collection.emplace<int>(key, static_cast<int>(key)));
+		}
+
+		for (unsigned int key = 969; key <= 1000; key++)
+		{
+			const auto it = find(collection, key);
+			REQUIRE(it != collection.end());
+			CHECK(*collection.get<int>(it) == static_cast<int>(key));
+		}
+	}
+}
+
+TEST_CASE("collection slots", "[core][container]")
+{
+	SECTION("narrow slots have 24 bits of index")
+	{
+		core::container::collection_slot32 slot;
+		slot.set(3, 0x00fedcba);
+		CHECK(slot.get_type() == 3);
+		CHECK(slot.get_index() == 0x00fedcba);
+
+		slot.set_index(0x00abcdef);
+		CHECK(slot.get_type() == 3);
+		CHECK(slot.get_index() == 0x00abcdef);
+	}
+
+	SECTION("wide slots have 56 bits of index")
+	{
+		core::container::collection_slot64 slot;
+		slot.set(3, 0x00fedcba98765432ull);
+		CHECK(slot.get_type() == 3);
+		CHECK(slot.get_index() == 0x00fedcba98765432ull);
+
+		slot.set_index(0x0000000123456789ull);
+		CHECK(slot.get_type() == 3);
+		CHECK(slot.get_index() == 0x0000000123456789ull);
+	}
+}
+
+TEST_CASE("wide collection", "[core][container]")
+{
+	core::container::WideCollection
+	<
+		unsigned int,
+		utility::heap_storage_traits,
+		utility::heap_storage<int>,
+		utility::heap_storage<char>
+	>
+	collection;
+
+	CHECK(collection.emplace<int>(1u, 1));
+	CHECK(collection.emplace<char>(2u, 'b'));
+	CHECK(collection.emplace<int>(3u, 3));
+
+	const auto one_it = find(collection, 1u);
+	REQUIRE(one_it != collection.end());
+	CHECK(collection.contains<int>(one_it));
+	CHECK(*collection.get<int>(one_it) == 1);
+
+	const auto two_it = find(collection, 2u);
+	REQUIRE(two_it != collection.end());
+	CHECK(collection.contains<char>(two_it));
+	CHECK(*collection.get<char>(two_it) == 'b');
+
+	collection.erase(one_it);
+	CHECK(find(collection, 1u) == collection.end());
+
+	const auto three_it = find(collection, 3u);
+	REQUIRE(three_it != collection.end());
+	CHECK(*collection.get<int>(three_it) == 3);
+	CHECK(collection.get<int>().size() == 1);
+}
+
+TEST_CASE("collection batches", "[core][container]")
+{
+	core::container::Collection
+	<
+		unsigned int,
+		utility::heap_storage_traits,
+		utility::heap_storage<int>,
+		utility::heap_storage<char>
+	>
+	collection;
+
+	REQUIRE(collection.reserve(1000));
+	const auto table_size = collection.table_size();
+
+	unsigned int keys[1000];
+	int values[1000];
+	for (int i = 0; i < 1000; i++)
+	{
+		keys[i] = static_cast<unsigned int>(i + 1);
+		values[i] = i + 1;
+	}
+	CHECK(collection.emplace_range<int>(keys, keys + 1000, values) == 1000);
+	CHECK(collection.table_size() == table_size);
+	CHECK(collection.get<int>().size() == 1000);
+	CHECK(collection.emplace<char>(1001u, 'a'));
+
+	SECTION("emplace_range makes every key findable")
+	{
+		for (unsigned int key = 1; key <= 1000; key++)
+		{
+			const auto it = find(collection, key);
+			REQUIRE(it != collection.end());
+			CHECK(*collection.get<int>(it) == static_cast<int>(key));
+		}
+	}
+
+	SECTION("erase_many keeps the order of the remaining components")
+	{
+		unsigned int odd_keys[501];
+		for (int i = 0; i < 500; i++)
+		{
+			odd_keys[i] = static_cast<unsigned int>(2 * i + 1);
+		}
+		odd_keys[500] = 1001u;
+
+		const unsigned int missing_key = 5000u;
+
+		CHECK(collection.erase_many(odd_keys, odd_keys + 501) == 501);
+		CHECK(collection.erase_many(&missing_key, &missing_key + 1) == 0);
+		CHECK(collection.get<char>().size() == 0);
+
+		auto ints = collection.get<int>();
+		REQUIRE(ints.size() == 500);
+		for (int i = 0; i < 500; i++)
+		{
+			CHECK(ints[i] == 2 * i + 2);
+			CHECK(collection.get_key(ints[i]) == static_cast<unsigned int>(2 * i + 2));
+		}
+
+		for (unsigned int key = 1; key <= 1000; key++)
+		{
+			const auto it = find(collection, key);
+			if (key % 2 == 1)
+			{
+				CHECK(it == collection.end());
+			}
+			else
+			{
+				REQUIRE(it != collection.end());
+				CHECK(*collection.get<int>(it) == static_cast<int>(key));
+			}
+		}
+	}
+}
+
+TEST_CASE("unordered collection batches", "[core][container]")
+{
+	core::container::UnorderedCollection
+	<
+		unsigned int,
+		utility::heap_storage_traits,
+		utility::heap_storage<int>
+	>
+	collection;
+
+	REQUIRE(collection.reserve(100));
+
+	unsigned int keys[100];
+	int values[100];
+	for (int i = 0; i < 100; i++)
+	{
+		keys[i] = static_cast<unsigned int>(i + 1);
+		values[i] = i + 1;
+	}
+	CHECK(collection.emplace_range<int>(keys, keys + 100, values) == 100);
+
+	CHECK(collection.erase_many(keys, keys + 50) == 50);
+	for (unsigned int key = 1; key <= 100; key++)
+	{
+		const auto it = find(collection, key);
+		if (key <= 50)
+		{
+			CHECK(it == collection.end());
+		}
+		else
+		{
+			REQUIRE(it != collection.end());
+			CHECK(*collection.get<int>(it) == static_cast<int>(key));
+		}
+	}
+}
+
+TEST_CASE("collection change tracking", "[core][container]")
+{
+	core::container::Collection
+	<
+		unsigned int,
+		utility::heap_storage_traits,
+		utility::heap_storage<int>
+	>
+	collection;
+
+	for (unsigned int key = 1; key <= 200; key++)
+	{
+		REQUIRE(collection.emplace<int>(key, static_cast<int>(key)));
+	}
+
+	const auto changed_keys = [&collection]()
+	{
+		std::vector<unsigned int> keys;
+		collection.for_each_changed<int>([&keys](unsigned int key, int & value){ CHECK(value == static_cast<int>(key)); keys.push_back(key); });
+		std::sort(keys.begin(), keys.end());
+		return keys;
+	};
+
+	SECTION("nothing is changed by default")
+	{
+		CHECK(changed_keys().empty());
+	}
+
+	collection.mark_changed<int>(find(collection, 3u));
+	collection.mark_changed<int>(find(collection, 100u));
+	collection.mark_changed(*collection.get<int>(find(collection, 200u)));
+
+	SECTION("marked components are visited once")
+	{
+		collection.mark_changed<int>(find(collection, 3u));
+		CHECK(changed_keys() == (std::vector<unsigned int>{3u, 100u, 200u}));
+		CHECK(collection.is_changed(*collection.get<int>(find(collection, 3u))));
+		CHECK_FALSE(collection.is_changed(*collection.get<int>(find(collection, 4u))));
+	}
+
+	SECTION("clear_changed unmarks everything")
+	{
+		collection.clear_changed<int>();
+		CHECK(changed_keys().empty());
+	}
+
+	SECTION("marks follow components that are moved by erase")
+	{
+		collection.erase(find(collection, 3u));
+		CHECK(changed_keys() == (std::vector<unsigned int>{100u, 200u}));
+
+		REQUIRE(collection.emplace<int>(201u, 201));
+		CHECK(changed_keys() == (std::vector<unsigned int>{100u, 200u}));
+	}
+
+	SECTION("marks are dropped with the last component when it is erased")
+	{
+		collection.erase(find(collection, 200u));
+		CHECK(changed_keys() == (std::vector<unsigned int>{3u, 100u}));
+
+		REQUIRE(collection.emplace<int>(201u, 201));
+		CHECK(changed_keys() == (std::vector<unsigned int>{3u, 100u}));
+	}
+
+	SECTION("marks follow components that are moved by erase_many")
+	{
+		const unsigned int keys[] = {1u, 2u, 3u, 150u};
+		CHECK(collection.erase_many(keys, keys + 4) == 4);
+		CHECK(changed_keys() == (std::vector<unsigned int>{100u, 200u}));
+
+		REQUIRE(collection.emplace<int>(201u, 201));
+		CHECK(changed_keys() == (std::vector<unsigned int>{100u, 200u}));
+	}
+}
+
+TEST_CASE("collection with multiple fields", "[core][container]")
+{
+	struct Position { float x, y, z; };
+	struct Orientation { float x, y, z, w; };
+
+	core::container::Collection
+	<
+		unsigned int,
+		utility::heap_storage_traits,
+		utility::heap_storage<Position, Orientation>,
+		utility::heap_storage<int>
+	>
+	collection;
+
+	CHECK(collection.emplace<Position>(1u, Position{1.f, 0.f, 0.f}, Orientation{0.f, 0.f, 0.f, 1.f}));
+	CHECK(collection.emplace<int>(2u, 2));
+	CHECK(collection.emplace<Position>(3u, Position{3.f, 0.f, 0.f}, Orientation{0.f, 0.f, 1.f, 0.f}));
+
+	const std::tuple<Position, Orientation> fields[] = {
+		std::make_tuple(Position{4.f, 0.f, 0.f}, Orientation{0.f, 1.f, 0.f, 0.f}),
+		std::make_tuple(Position{5.f, 0.f, 0.f}, Orientation{1.f, 0.f, 0.f, 0.f}),
+	};
+	const unsigned int keys[] = {4u, 5u};
+	CHECK(collection.emplace_range<Position>(keys, keys + 2, fields) == 2);
+
+	SECTION("every field has a column of its own")
+	{
+		auto positions = collection.get<Position>();
+		auto orientations = collection.get<Position, 1>();
+		REQUIRE(positions.size() == 4);
+		REQUIRE(orientations.size() == 4);
+
+		CHECK(positions[0].x == 1.f);
+		CHECK(orientations[0].w == 1.f);
+		CHECK(positions[1].x == 3.f);
+		CHECK(orientations[1].z == 1.f);
+		CHECK(positions[3].x == 5.f);
+		CHECK(orientations[3].x == 1.f);
+
+		CHECK(collection.get_key(positions[2]) == 4u);
+	}
+
+	SECTION("fields are found by key")
+	{
+		const auto it = find(collection, 3u);
+		REQUIRE(it != collection.end());
+		CHECK(collection.contains<Position>(it));
+		CHECK_FALSE(collection.contains<int>(it));
+		REQUIRE(collection.get<Position>(it));
+		CHECK(collection.get<Position>(it)->x == 3.f);
+		REQUIRE(collection.get<Position, 1>(it));
+		CHECK(collection.get<Position, 1>(it)->z == 1.f);
+	}
+
+	SECTION("fields stay together when erasing")
+	{
+		collection.erase(find(collection, 1u));
+		const unsigned int more_keys[] = {3u};
+		CHECK(collection.erase_many(more_keys, more_keys + 1) == 1);
+
+		const auto it = find(collection, 5u);
+		REQUIRE(it != collection.end());
+		CHECK(collection.get<Position>(it)->x == 5.f);
+		CHECK(collection.get<Position, 1>(it)->x == 1.f);
+		CHECK(collection.get<Position>().size() == 2);
+	}
+}
@@ -0,0 +1,112 @@
+#include "core/async/Thread.hpp"
+#include "core/container/ExchangeQueue.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <array>
+#include <memory>
+
+namespace
+{
+	using Frames = core::container::ExchangeQueueSRMW<std::array<int, 1024>>;
+
+	core::async::thread_return thread_decl write_frames(core::async::thread_param arg)
+	{
+		Frames & q = *static_cast<Frames *>(arg);
+
+		for (int i = 1; i <= 1000; i++)
+		{
+			auto & frame = q.begin_write();
+			frame.fill(i);
+			q.commit();
+		}
+		return core::async::thread_return{};
+	}
+}
+
+TEST_CASE("exchange queue", "[core][container]")
+{
+	core::container::ExchangeQueueSRSW<std::unique_ptr<int>> q;
+
+	SECTION("is empty by default")
+	{
+		std::unique_ptr<int> v;
+		CHECK_FALSE(q.try_pop(v));
+		CHECK(q.begin_read() == nullptr);
+	}
+
+	SECTION("only keeps the latest item")
+	{
+		REQUIRE(q.try_push(std::make_unique<int>(1)));
+		REQUIRE(q.try_push(std::make_unique<int>(2)));
+
+		std::unique_ptr<int> v;
+		REQUIRE(q.try_pop(v));
+		REQUIRE(v);
+		CHECK(*v == 2);
+		CHECK_FALSE(q.try_pop(v));
+	}
+
+	SECTION("can be written and read in place")
+	{
+		std::unique_ptr<int> & a = q.begin_write();
+		CHECK_FALSE(a);
+		a = std::make_unique<int>(1);
+		const int * const address = a.get();
+		q.commit();
+
+		std::unique_ptr<int> * const b = q.begin_read();
+		REQUIRE(b);
+		REQUIRE(*b);
+		CHECK(b->get() == address);
+		q.end_read();
+
+		CHECK(q.begin_read() == nullptr);
+	}
+
+	SECTION("reuses slots when written in place")
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			std::unique_ptr<int> & a = q.begin_write();
+			if (!a)
+			{
+				a = std::make_unique<int>(0);
+			}
+			*a = i;
+			q.commit();
+		}
+
+		// the reader gets the latest one, and the writer keeps on
+		// writing into the items it has written into before
+		std::unique_ptr<int> * const b = q.begin_read();
+		REQUIRE(b);
+		CHECK(**b == 3);
+		q.end_read();
+
+		CHECK(q.begin_write());
+	}
+}
+
+TEST_CASE("exchange queue between threads", "[core][container]")
+{
+	Frames q;
+
+	core::async::Thread writer(write_frames, &q);
+
+	int last = 0;
+	while (last < 1000)
+	{
+		const auto * frame = q.begin_read();
+		if (frame)
+		{
+			const int value = (*frame)[0];
+			CHECK(value > last);
+			CHECK((*frame)[1023] == value);
+			last = value;
+		}
+		q.end_read();
+	}
+
+	writer.join();
+}
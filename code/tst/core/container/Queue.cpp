@@ -587,3 +587,130 @@ TEST_CASE("", "")
 		CHECK_FALSE(q.try_emplace(7, "7", std::make_unique<int>(7)));
 	}
 }
+
+TEST_CASE("", "")
+{
+	core::container::SimpleQueue<utility::heap_storage<int>> q(8);
+
+	const int values[] = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+
+	SECTION("")
+	{
+		int v[4];
+		CHECK(q.try_pop_n(v, 4) == 0);
+	}
+
+	SECTION("")
+	{
+		REQUIRE(q.try_push_range(values, values + 9) == 7);
+		CHECK_FALSE(q.try_emplace(7));
+
+		int v[9] = {};
+		REQUIRE(q.try_pop_n(v, 3) == 3);
+		CHECK(v[0] == 1);
+		CHECK(v[1] == 2);
+		CHECK(v[2] == 3);
+
+		// wraps around the end
+		REQUIRE(q.try_push_range(values, values + 3) == 3);
+
+		REQUIRE(q.drain_into(utility::span<int>(v)) == 7);
+		CHECK(v[0] == 4);
+		CHECK(v[3] == 7);
+		CHECK(v[4] == 1);
+		CHECK(v[6] == 3);
+
+		CHECK_FALSE(q.try_pop(v[0]));
+	}
+}
+
+TEST_CASE("", "")
+{
+	core::container::PageQueue<utility::heap_storage<int>> q;
+
+	const int values[] = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+
+	SECTION("")
+	{
+		int v[4];
+		CHECK(q.try_pop_n(v, 4) == 0);
+	}
+
+	SECTION("")
+	{
+		REQUIRE(q.try_push_range(values, values + 3) == 3);
+		REQUIRE(q.try_push_range(values + 3, values + 9) == 6);
+		REQUIRE(q.try_emplace(10));
+
+		int v[10] = {};
+		REQUIRE(q.try_pop_n(v, 2) == 2);
+		CHECK(v[0] == 1);
+		CHECK(v[1] == 2);
+
+		// reads across pages
+		REQUIRE(q.drain_into(utility::span<int>(v)) == 8);
+		for (int i = 0; i < 8; i++)
+		{
+			CHECK(v[i] == i + 3);
+		}
+
+		CHECK_FALSE(q.try_pop(v[0]));
+	}
+}
+
+TEST_CASE("", "")
+{
+	core::container::PageQueue<utility::heap_storage<int, std::string, std::unique_ptr<int>>> q(4);
+
+	std::tuple<int, std::string, std::unique_ptr<int>> values[3] = {
+		std::make_tuple(1, "1", std::make_unique<int>(1)),
+		std::make_tuple(2, "2", std::make_unique<int>(2)),
+		std::make_tuple(3, "3", std::make_unique<int>(3)),
+	};
+	REQUIRE(q.try_push_range(std::make_move_iterator(values), std::make_move_iterator(values + 3)) == 3);
+
+	std::tuple<int, std::string, std::unique_ptr<int>> v[3];
+	REQUIRE(q.try_pop_n(v, 3) == 3);
+	CHECK(std::get<0>(v[2]) == 3);
+	CHECK(std::get<1>(v[2]) == "3");
+	REQUIRE(std::get<2>(v[2]));
+	CHECK(*std::get<2>(v[2]) == 3);
+}
+
+TEST_CASE("", "")
+{
+	core::container::PageQueue<utility::heap_storage<int>> q(4);
+	CHECK(q.stats().allocated == 1);
+
+	const int values[] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+	int v[16];
+
+	REQUIRE(q.try_push_range(values, values + 4) == 4);
+	CHECK(q.stats().allocated == 2);
+
+	REQUIRE(q.try_pop_n(v, 16) == 4);
+	CHECK(q.stats().recycled == 0);
+	CHECK(q.stats().released == 0);
+
+	SECTION("")
+	{
+		q.set_free_page_limit(0);
+		CHECK(q.stats().released == 1);
+	}
+
+	SECTION("")
+	{
+		REQUIRE(q.try_push_range(values, values + 16) == 16);
+		REQUIRE(q.try_pop_n(v, 16) == 16);
+		CHECK(q.stats().allocated == 3);
+		CHECK(q.stats().released == 0);
+
+		REQUIRE(q.try_push_range(values, values + 16) == 16);
+		REQUIRE(q.try_pop_n(v, 16) == 16);
+		CHECK(q.stats().allocated == 3);
+		CHECK(q.stats().released == 0);
+
+		q.set_free_page_limit(1);
+		CHECK(q.stats().released == 1);
+	}
+}
@@ -0,0 +1,148 @@
+#include "core/container/TimerWheel.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <vector>
+
+namespace
+{
+	struct Expired
+	{
+		uint64_t tick;
+		int value;
+	};
+
+	template <typename T>
+	std::vector<Expired> advance_and_erase(core::container::TimerWheel<T> & wheel, uint64_t ticks)
+	{
+		std::vector<Expired> expired;
+		std::vector<typename core::container::TimerWheel<T>::Handle> handles;
+
+		wheel.advance(ticks, [&](typename core::container::TimerWheel<T>::Handle handle, T & value)
+		{
+			expired.push_back(Expired{wheel.now(), value});
+			handles.push_back(handle);
+		});
+
+		for (auto handle : handles)
+		{
+			CHECK(wheel.erase(handle));
+		}
+		return expired;
+	}
+}
+
+TEST_CASE("timer wheel", "[core][container]")
+{
+	core::container::TimerWheel<int> wheel;
+
+	SECTION("is empty by default")
+	{
+		CHECK(wheel.size() == 0);
+		CHECK(wheel.ticks_until_next() == uint64_t(-1));
+		CHECK(advance_and_erase(wheel, 1000).empty());
+		CHECK(wheel.now() == 1000);
+	}
+
+	SECTION("calls timers when they run out")
+	{
+		const uint64_t delays[] = {1, 5, 63, 64, 65, 100, 4095, 4096, 4097, 300000, 16777215, 16777216, 20000000};
+
+		const int count = sizeof delays / sizeof delays[0];
+
+		for (int i = 0; i < count; i++)
+		{
+			REQUIRE(wheel.insert(delays[i], int(i)));
+		}
+		CHECK(wheel.size() == count);
+
+		const auto expired = advance_and_erase(wheel, 20000000);
+		REQUIRE(expired.size() == count);
+		for (int i = 0; i < count; i++)
+		{
+			CHECK(expired[i].value == i);
+			CHECK(expired[i].tick == delays[i]);
+		}
+		CHECK(wheel.size() == 0);
+	}
+
+	SECTION("calls timers no sooner than the next tick")
+	{
+		REQUIRE(wheel.insert(0, 7));
+
+		const auto expired = advance_and_erase(wheel, 1);
+		REQUIRE(expired.size() == 1);
+		CHECK(expired[0].tick == 1);
+	}
+
+	SECTION("does not call erased timers")
+	{
+		const auto a = wheel.insert(10, 1);
+		const auto b = wheel.insert(10, 2);
+		const auto c = wheel.insert(1000, 3);
+		REQUIRE(a);
+		REQUIRE(b);
+		REQUIRE(c);
+
+		CHECK(wheel.erase(b));
+		CHECK(wheel.erase(c));
+		CHECK_FALSE(wheel.erase(c));
+		CHECK(wheel.find(b) == nullptr);
+		CHECK(wheel.find(a) != nullptr);
+
+		const auto expired = advance_and_erase(wheel, 2000);
+		REQUIRE(expired.size() == 1);
+		CHECK(expired[0].value == 1);
+	}
+
+	SECTION("does not mix up reused timers")
+	{
+		const auto a = wheel.insert(10, 1);
+		REQUIRE(wheel.erase(a));
+
+		const auto b = wheel.insert(10, 2);
+		REQUIRE(b);
+		CHECK(b.index == a.index);
+		CHECK(b != a);
+		CHECK_FALSE(wheel.erase(a));
+		CHECK(wheel.find(b) != nullptr);
+	}
+
+	SECTION("can reschedule timers that have run out")
+	{
+		const auto a = wheel.insert(100, 1);
+		REQUIRE(a);
+
+		int calls = 0;
+		for (int i = 0; i < 10; i++)
+		{
+			wheel.advance(100, [&](core::container::TimerWheel<int>::Handle handle, int & value)
+			{
+				CHECK(handle == a);
+				CHECK(value == 1);
+				CHECK(wheel.now() == uint64_t(100 * (calls + 1)));
+				calls++;
+
+				CHECK(wheel.reschedule(handle, 100));
+			});
+		}
+		CHECK(calls == 10);
+		CHECK(wheel.size() == 1);
+	}
+
+	SECTION("knows when the next timer may run out")
+	{
+		REQUIRE(wheel.insert(10, 1));
+		CHECK(wheel.ticks_until_next() == 10);
+
+		REQUIRE(wheel.insert(5, 2));
+		CHECK(wheel.ticks_until_next() == 5);
+
+		CHECK(advance_and_erase(wheel, 5).size() == 1);
+		CHECK(wheel.ticks_until_next() == 5);
+
+		REQUIRE(wheel.insert(1000, 3));
+		CHECK(advance_and_erase(wheel, 5).size() == 1);
+		CHECK(wheel.ticks_until_next() == 64 - 10);
+	}
+}
@@ -0,0 +1,89 @@
+#include "config.h"
+
+#include "core/content.hpp"
+#include "core/native/file.hpp"
+
+#include "ful/cstr.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <cstdio>
+
+#if FILE_SYSTEM_USE_POSIX
+
+namespace
+{
+	bool write_file(const char * filepath, char value)
+	{
+		std::FILE * const file = std::fopen(filepath, "wb");
+		if (!file)
+			return false;
+
+		const bool written = std::fputc(value, file) == value;
+		return std::fclose(file) == 0 && written;
+	}
+
+	bool read_char(core::content & content, void * data)
+	{
+		if (content.size() == 0)
+			return false;
+
+		*static_cast<char *>(data) = *static_cast<const char *>(content.data());
+		return true;
+	}
+}
+
+TEST_CASE("try_read_file reads files in the way that suits their size", "[core][native]")
+{
+	REQUIRE(write_file("native.file", 5));
+
+	char value = 0;
+
+	SECTION("small files are copied")
+	{
+		const core::native::read_statistics before = core::native::get_read_statistics();
+
+		CHECK(core::native::try_read_file(ful::cstr_utf8("native.file"), read_char, &value) == 1);
+		CHECK(value == 5);
+
+		const core::native::read_statistics after = core::native::get_read_statistics();
+		CHECK(after.buffered - before.buffered == 1);
+		CHECK(after.populated - before.populated == 0);
+		CHECK(after.mapped - before.mapped == 0);
+	}
+
+	SECTION("bigger files are mapped and paged in at once")
+	{
+		core::native::set_read_sizes(0, core::native::default_populate_file_size);
+
+		const core::native::read_statistics before = core::native::get_read_statistics();
+
+		CHECK(core::native::try_read_file(ful::cstr_utf8("native.file"), read_char, &value) == 1);
+		CHECK(value == 5);
+
+		const core::native::read_statistics after = core::native::get_read_statistics();
+		CHECK(after.buffered - before.buffered == 0);
+		CHECK(after.populated - before.populated == 1);
+		CHECK(after.mapped - before.mapped == 0);
+	}
+
+	SECTION("huge files are mapped")
+	{
+		core::native::set_read_sizes(0, 0);
+
+		const core::native::read_statistics before = core::native::get_read_statistics();
+
+		CHECK(core::native::try_read_file(ful::cstr_utf8("native.file"), read_char, &value) == 1);
+		CHECK(value == 5);
+
+		const core::native::read_statistics after = core::native::get_read_statistics();
+		CHECK(after.buffered - before.buffered == 0);
+		CHECK(after.populated - before.populated == 0);
+		CHECK(after.mapped - before.mapped == 1);
+	}
+
+	core::native::set_read_sizes(core::native::default_small_file_size, core::native::default_populate_file_size);
+	std::remove("native.file");
+}
+
+#endif
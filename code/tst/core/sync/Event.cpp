@@ -0,0 +1,139 @@
+#include "core/async/Thread.hpp"
+#include "core/sync/Event.hpp"
+#include "core/sync/Semaphore.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <atomic>
+
+namespace
+{
+	struct Counter
+	{
+		core::sync::Semaphore semaphore;
+		std::atomic_int count{0};
+
+		static core::async::thread_return thread_decl wait_twice(core::async::thread_param arg)
+		{
+			Counter & counter = *static_cast<Counter *>(arg);
+
+			for (int i = 0; i < 2; i++)
+			{
+				counter.semaphore.wait();
+				counter.count.fetch_add(1, std::memory_order_relaxed);
+			}
+			return core::async::thread_return{};
+		}
+	};
+
+	struct Gate
+	{
+		core::sync::Event<true> open;
+		std::atomic_int passed{0};
+
+		static core::async::thread_return thread_decl pass(core::async::thread_param arg)
+		{
+			Gate & gate = *static_cast<Gate *>(arg);
+
+			gate.open.wait();
+			gate.passed.fetch_add(1, std::memory_order_relaxed);
+			return core::async::thread_return{};
+		}
+	};
+}
+
+TEST_CASE("auto reset event", "[core][sync]")
+{
+	core::sync::Event<false> event;
+
+	SECTION("times out when not set")
+	{
+		CHECK_FALSE(event.wait(1));
+	}
+
+	SECTION("lets one wait through per set")
+	{
+		event.set();
+		event.set();
+		CHECK(event.wait(1));
+		CHECK_FALSE(event.wait(1));
+	}
+
+	SECTION("can start out set")
+	{
+		core::sync::Event<false> initially_set(true);
+		CHECK(initially_set.wait());
+		CHECK_FALSE(initially_set.wait(1));
+	}
+}
+
+TEST_CASE("manual reset event", "[core][sync]")
+{
+	Gate gate;
+
+	SECTION("stays set until reset")
+	{
+		gate.open.set();
+		CHECK(gate.open.wait());
+		CHECK(gate.open.wait(1));
+
+		gate.open.reset();
+		CHECK_FALSE(gate.open.wait(1));
+	}
+
+	SECTION("releases everyone waiting")
+	{
+		core::async::Thread threads[4];
+		for (auto & thread : threads)
+		{
+			thread = core::async::Thread(Gate::pass, &gate);
+		}
+
+		gate.open.set();
+
+		for (auto & thread : threads)
+		{
+			thread.join();
+		}
+		CHECK(gate.passed.load() == 4);
+	}
+}
+
+TEST_CASE("semaphore", "[core][sync]")
+{
+	Counter counter;
+
+	SECTION("times out when not signaled")
+	{
+		CHECK_FALSE(counter.semaphore.try_wait());
+		CHECK_FALSE(counter.semaphore.wait(1));
+	}
+
+	SECTION("lets one wait through per signal")
+	{
+		core::sync::Semaphore semaphore(2);
+		CHECK(semaphore.try_wait());
+		CHECK(semaphore.wait(1));
+		CHECK_FALSE(semaphore.try_wait());
+	}
+
+	SECTION("wakes waiting threads")
+	{
+		core::async::Thread threads[2] = {
+			core::async::Thread(Counter::wait_twice, &counter),
+			core::async::Thread(Counter::wait_twice, &counter),
+		};
+
+		for (int i = 0; i < 4; i++)
+		{
+			counter.semaphore.signal();
+		}
+
+		for (auto & thread : threads)
+		{
+			thread.join();
+		}
+		CHECK(counter.count.load() == 4);
+		CHECK_FALSE(counter.semaphore.try_wait());
+	}
+}
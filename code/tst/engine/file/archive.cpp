@@ -0,0 +1,90 @@
+#include "engine/file/archive.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <cstring>
+#include <memory>
+
+namespace
+{
+	struct packed_archive
+	{
+		std::unique_ptr<char[]> buffer;
+		engine::file::archive archive;
+	};
+
+	bool pack(packed_archive & packed, const char * const (& names)[3])
+	{
+		engine::file::archive_builder builder;
+		for (const char * name : names)
+		{
+			if (!builder.add(ful::view_utf8(name, std::strlen(name)), std::strlen(name)))
+				return false;
+		}
+
+		if (!builder.finish())
+			return false;
+
+		packed.buffer.reset(new char[builder.size() + engine::file::archive_alignment]);
+		// the archive is expected to be aligned, like it is when mapped
+		char * const data = reinterpret_cast<char *>((reinterpret_cast<std::uintptr_t>(packed.buffer.get()) + (engine::file::archive_alignment - 1)) & ~std::uintptr_t(engine::file::archive_alignment - 1));
+
+		builder.write_index(data);
+		for (const engine::file::archive_entry & entry : builder)
+		{
+			// every file holds its own name
+			std::memcpy(data + entry.offset, builder.name(entry).data(), entry.size);
+		}
+
+		return packed.archive.open(data, builder.size());
+	}
+}
+
+TEST_CASE("archive", "[engine][file]")
+{
+	const char * const names[] = {"a.txt", "folder/b.json", "folder/sub/c.png"};
+
+	packed_archive packed;
+	REQUIRE(pack(packed, names));
+
+	SECTION("can find its files")
+	{
+		for (const char * name : names)
+		{
+			const engine::file::archive_entry * const entry = packed.archive.find(ful::view_utf8(name, std::strlen(name)));
+			REQUIRE(entry);
+			CHECK(entry->size == std::strlen(name));
+			CHECK(entry->offset % engine::file::archive_alignment == 0);
+			CHECK(std::memcmp(packed.archive.payload(*entry), name, entry->size) == 0);
+		}
+	}
+
+	SECTION("does not find what it does not have")
+	{
+		CHECK_FALSE(packed.archive.find(ful::view_utf8("b.json", 6)));
+		CHECK_FALSE(packed.archive.find(ful::view_utf8("folder/b.jso", 12)));
+	}
+
+	SECTION("lists all of its files")
+	{
+		CHECK(packed.archive.end() - packed.archive.begin() == 3);
+	}
+
+	SECTION("rejects data that is broken")
+	{
+		engine::file::archive archive;
+		CHECK_FALSE(archive.open(packed.archive.payload(*packed.archive.begin()), 5));
+
+		char * const data = const_cast<char *>(static_cast<const char *>(packed.archive.payload(*packed.archive.begin()))) - packed.archive.begin()->offset;
+		CHECK_FALSE(archive.open(data, packed.archive.begin()->offset));
+	}
+}
+
+TEST_CASE("archive builder rejects names that are added twice", "[engine][file]")
+{
+	engine::file::archive_builder builder;
+	REQUIRE(builder.add(ful::view_utf8("a.txt", 5), 1));
+	REQUIRE(builder.add(ful::view_utf8("a.txt", 5), 2));
+
+	CHECK_FALSE(builder.finish());
+}
@@ -20,7 +20,7 @@ static_hashes("tmpdir", "tree.root", "dependency.1", "dependency.2", "dependency
 
 namespace
 {
-	ext::ssize write_char(engine::file::system & /*filesystem*/, core::content & content, utility::any && data)
+	ext::ssize write_char(engine::file::system & /*filesystem*/, core::content & content, engine::task::any && data)
 	{
 		if (!debug_assert(data.type_id() == utility::type_id<char>()))
 			return 0;
@@ -65,8 +65,8 @@ TEST_CASE("file loader can read files", "[engine][file]")
 		ful::assign(filepath1, ful::cstr_utf8("maybe.exists"));
 		ful::heap_string_utf8 filepath2;
 		ful::assign(filepath2, ful::cstr_utf8("folder/maybe.exists"));
-		engine::file::write(filesystem, tmpdir, std::move(filepath1), engine::Hash{}, write_char, utility::any(char(2)));
-		engine::file::write(filesystem, tmpdir, std::move(filepath2), engine::Hash{}, write_char, utility::any(char(3)), engine::file::flags::CREATE_DIRECTORIES);
+		engine::file::write(filesystem, tmpdir, std::move(filepath1), engine::Hash{}, write_char, engine::task::any(char(2)));
+		engine::file::write(filesystem, tmpdir, std::move(filepath2), engine::Hash{}, write_char, engine::task::any(char(3)), engine::file::flags::CREATE_DIRECTORIES);
 
 		engine::file::scoped_library tmplib(fileloader, tmpdir);
 
@@ -81,7 +81,7 @@ TEST_CASE("file loader can read files", "[engine][file]")
 		engine::file::scoped_filetype filetype(
 			fileloader,
 			engine::Asset("tmpfiletype"),
-			[](engine::file::loader & /*fileloader*/, core::content & content, utility::any & stash, engine::Asset file)
+			[](engine::file::loader & /*fileloader*/, core::content & content, engine::task::any & stash, engine::Asset file)
 		{
 			FileData & file_data = stash.emplace<FileData>();
 
@@ -97,7 +97,7 @@ TEST_CASE("file loader can read files", "[engine][file]")
 				debug_fail();
 			}
 		},
-			[](engine::file::loader & /*fileloader*/, utility::any & stash, engine::Asset file)
+			[](engine::file::loader & /*fileloader*/, engine::task::any & stash, engine::Asset file)
 		{
 			if (!debug_assert(stash.type_id() == utility::type_id<FileData>()))
 				return;
@@ -139,7 +139,7 @@ TEST_CASE("file loader can read files", "[engine][file]")
 			engine::Token(engine::Asset("my independent load")),
 			engine::Asset(u8"maybe.exists"),
 			filetype,
-			[](engine::file::loader & /*fileloader*/, utility::any & data, engine::Asset /*name*/, const utility::any & stash, engine::Asset /*file*/)
+			[](engine::file::loader & /*fileloader*/, engine::task::any & data, engine::Asset /*name*/, const engine::task::any & stash, engine::Asset /*file*/)
 		{
 			if (!debug_assert(data.type_id() == utility::type_id<SyncData *>()))
 				return;
@@ -155,7 +155,7 @@ TEST_CASE("file loader can read files", "[engine][file]")
 			sync_data->ready_value = file_data.value;
 			sync_data->ready_event.set();
 		},
-			[](engine::file::loader & /*fileloader*/, utility::any & data, engine::Asset /*name*/, const utility::any & stash, engine::Asset /*file*/)
+			[](engine::file::loader & /*fileloader*/, engine::task::any & data, engine::Asset /*name*/, const engine::task::any & stash, engine::Asset /*file*/)
 		{
 			if (!debug_assert(data.type_id() == utility::type_id<SyncData *>()))
 				return;
@@ -167,14 +167,14 @@ TEST_CASE("file loader can read files", "[engine][file]")
 
 			sync_data->ready_value -= file_data.value;
 		},
-			utility::any(sync_data + 0));
+			engine::task::any(sync_data + 0));
 
 		engine::file::load_independent(
 			fileloader,
 			engine::Token(engine::Asset("my other independent load")),
 			engine::Asset(u8"folder/maybe.exists"),
 			filetype,
-			[](engine::file::loader & /*fileloader*/, utility::any & data, engine::Asset /*name*/, const utility::any & stash, engine::Asset /*file*/)
+			[](engine::file::loader & /*fileloader*/, engine::task::any & data, engine::Asset /*name*/, const engine::task::any & stash, engine::Asset /*file*/)
 		{
 			if (!debug_assert(data.type_id() == utility::type_id<SyncData *>()))
 				return;
@@ -190,7 +190,7 @@ TEST_CASE("file loader can read files", "[engine][file]")
 			sync_data->ready_value = file_data.value;
 			sync_data->ready_event.set();
 		},
-			[](engine::file::loader & /*fileloader*/, utility::any & data, engine::Asset /*name*/, const utility::any & stash, engine::Asset /*file*/)
+			[](engine::file::loader & /*fileloader*/, engine::task::any & data, engine::Asset /*name*/, const engine::task::any & stash, engine::Asset /*file*/)
 		{
 			if (!debug_assert(data.type_id() == utility::type_id<SyncData *>()))
 				return;
@@ -202,7 +202,7 @@ TEST_CASE("file loader can read files", "[engine][file]")
 
 			sync_data->ready_value -= file_data.value;
 		},
-			utility::any(sync_data + 1));
+			engine::task::any(sync_data + 1));
 
 		REQUIRE(sync_data[0].ready_event.wait(timeout));
 		REQUIRE(sync_data[1].ready_event.wait(timeout));
@@ -244,7 +244,7 @@ namespace
 		core::sync::Event<true> unload_event;
 	} sync_data;
 
-	void tree_ready(engine::file::loader & /*fileloader*/, utility::any & data, engine::Asset name, const utility::any & stash, engine::Asset /*file*/)
+	void tree_ready(engine::file::loader & /*fileloader*/, engine::task::any & data, engine::Asset name, const engine::task::any & stash, engine::Asset /*file*/)
 	{
 		if (!debug_assert(data.type_id() == utility::type_id<SyncData *>()))
 			return;
@@ -290,7 +290,7 @@ namespace
 		}
 	}
 
-	void tree_unready(engine::file::loader & /*fileloader*/, utility::any & data, engine::Asset name, const utility::any & /*stash*/, engine::Asset /*file*/)
+	void tree_unready(engine::file::loader & /*fileloader*/, engine::task::any & data, engine::Asset name, const engine::task::any & /*stash*/, engine::Asset /*file*/)
 	{
 		if (!debug_assert(data.type_id() == utility::type_id<SyncData *>()))
 			return;
@@ -322,32 +322,32 @@ namespace
 		}
 	}
 
-	void tree_load(engine::file::loader & fileloader, core::content & content, utility::any & stash, engine::Asset file)
+	void tree_load(engine::file::loader & fileloader, core::content & content, engine::task::any & stash, engine::Asset file)
 	{
 		TreeFileData & file_data = stash.emplace<TreeFileData>();
 
 		switch (file)
 		{
 		case engine::Hash(u8"tree.root"):
-			engine::file::load_dependency(fileloader, file, engine::Asset(u8"dependency.1"), engine::Asset("tmpfiletype"), tree_ready, tree_unready, utility::any(&sync_data));
-			engine::file::load_dependency(fileloader, file, engine::Asset(u8"dependency.2"), engine::Asset("tmpfiletype"), tree_ready, tree_unready, utility::any(&sync_data));
-			engine::file::load_dependency(fileloader, file, engine::Asset(u8"dependency.3"), engine::Asset("tmpfiletype"), tree_ready, tree_unready, utility::any(&sync_data));
+			engine::file::load_dependency(fileloader, file, engine::Asset(u8"dependency.1"), engine::Asset("tmpfiletype"), tree_ready, tree_unready, engine::task::any(&sync_data));
+			engine::file::load_dependency(fileloader, file, engine::Asset(u8"dependency.2"), engine::Asset("tmpfiletype"), tree_ready, tree_unready, engine::task::any(&sync_data));
+			engine::file::load_dependency(fileloader, file, engine::Asset(u8"dependency.3"), engine::Asset("tmpfiletype"), tree_ready, tree_unready, engine::task::any(&sync_data));
 			file_data.value += int(read_char(content));
 			break;
 		case engine::Hash(u8"dependency.1"):
 			file_data.value += int(read_char(content));
 			break;
 		case engine::Hash(u8"dependency.2"):
-			engine::file::load_dependency(fileloader, file, engine::Asset(u8"dependency.3"), engine::Asset("tmpfiletype"), tree_ready, tree_unready, utility::any(&sync_data));
-			engine::file::load_dependency(fileloader, file, engine::Asset(u8"dependency.4"), engine::Asset("tmpfiletype"), tree_ready, tree_unready, utility::any(&sync_data));
+			engine::file::load_dependency(fileloader, file, engine::Asset(u8"dependency.3"), engine::Asset("tmpfiletype"), tree_ready, tree_unready, engine::task::any(&sync_data));
+			engine::file::load_dependency(fileloader, file, engine::Asset(u8"dependency.4"), engine::Asset("tmpfiletype"), tree_ready, tree_unready, engine::task::any(&sync_data));
 			file_data.value += int(read_char(content));
 			break;
 		case engine::Hash(u8"dependency.3"):
-			engine::file::load_dependency(fileloader, file, engine::Asset(u8"dependency.1"), engine::Asset("tmpfiletype"), tree_ready, tree_unready, utility::any(&sync_data));
+			engine::file::load_dependency(fileloader, file, engine::Asset(u8"dependency.1"), engine::Asset("tmpfiletype"), tree_ready, tree_unready, engine::task::any(&sync_data));
 			file_data.value += int(read_char(content));
 			break;
 		case engine::Hash(u8"dependency.4"):
-			engine::file::load_dependency(fileloader, file, engine::Asset(u8"dependency.5"), engine::Asset("tmpfiletype"), tree_ready, tree_unready, utility::any(&sync_data));
+			engine::file::load_dependency(fileloader, file, engine::Asset(u8"dependency.5"), engine::Asset("tmpfiletype"), tree_ready, tree_unready, engine::task::any(&sync_data));
 			file_data.value += int(read_char(content));
 			break;
 		case engine::Hash(u8"dependency.5"):
@@ -358,7 +358,7 @@ namespace
 		}
 	}
 
-	void tree_unload(engine::file::loader & /*fileloader*/, utility::any & stash, engine::Asset file)
+	void tree_unload(engine::file::loader & /*fileloader*/, engine::task::any & stash, engine::Asset file)
 	{
 		if (!debug_assert(stash.type_id() == utility::type_id<TreeFileData>()))
 			return;
@@ -419,18 +419,18 @@ TEST_CASE("file loader can load tree", "[engine][file]")
 		ful::assign(filepath4, ful::cstr_utf8("dependency.4"));
 		ful::heap_string_utf8 filepath5;
 		ful::assign(filepath5, ful::cstr_utf8("dependency.5"));
-		engine::file::write(filesystem, tmpdir, std::move(filepath0), engine::Asset{}, write_char, utility::any(char(1)));
-		engine::file::write(filesystem, tmpdir, std::move(filepath1), engine::Asset{}, write_char, utility::any(char(11)));
-		engine::file::write(filesystem, tmpdir, std::move(filepath2), engine::Asset{}, write_char, utility::any(char(12)));
-		engine::file::write(filesystem, tmpdir, std::move(filepath3), engine::Asset{}, write_char, utility::any(char(13)));
-		engine::file::write(filesystem, tmpdir, std::move(filepath4), engine::Asset{}, write_char, utility::any(char(14)));
-		engine::file::write(filesystem, tmpdir, std::move(filepath5), engine::Asset{}, write_char, utility::any(char(15)));
+		engine::file::write(filesystem, tmpdir, std::move(filepath0), engine::Asset{}, write_char, engine::task::any(char(1)));
+		engine::file::write(filesystem, tmpdir, std::move(filepath1), engine::Asset{}, write_char, engine::task::any(char(11)));
+		engine::file::write(filesystem, tmpdir, std::move(filepath2), engine::Asset{}, write_char, engine::task::any(char(12)));
+		engine::file::write(filesystem, tmpdir, std::move(filepath3), engine::Asset{}, write_char, engine::task::any(char(13)));
+		engine::file::write(filesystem, tmpdir, std::move(filepath4), engine::Asset{}, write_char, engine::task::any(char(14)));
+		engine::file::write(filesystem, tmpdir, std::move(filepath5), engine::Asset{}, write_char, engine::task::any(char(15)));
 
 		engine::file::scoped_library tmplib(fileloader, tmpdir);
 
 		engine::file::scoped_filetype filetype(fileloader, engine::Asset("tmpfiletype"), tree_load, tree_unload);
 
-		engine::file::load_independent(fileloader, engine::Token(engine::Asset("tree root")), engine::Asset(u8"tree.root"), filetype, tree_ready, tree_unready, utility::any(&sync_data));
+		engine::file::load_independent(fileloader, engine::Token(engine::Asset("tree root")), engine::Asset(u8"tree.root"), filetype, tree_ready, tree_unready, engine::task::any(&sync_data));
 
 		REQUIRE(sync_data.ready_event.wait(timeout));
 		CHECK(sync_data.ready_values[0] == 1);
@@ -443,7 +443,7 @@ TEST_CASE("file loader can load tree", "[engine][file]")
 		sync_data.watch_event.reset();
 
 		ful::assign(filepath2, ful::cstr_utf8("dependency.2"));
-		engine::file::write(filesystem, tmpdir, std::move(filepath2), engine::Asset{}, write_char, utility::any(char(21)), engine::file::flags::OVERWRITE_EXISTING);
+		engine::file::write(filesystem, tmpdir, std::move(filepath2), engine::Asset{}, write_char, engine::task::any(char(21)), engine::file::flags::OVERWRITE_EXISTING);
 
 		REQUIRE(sync_data.watch_event.wait(timeout));
 		CHECK(sync_data.ready_values[0] == 1);
@@ -1,7 +1,10 @@
+#include "config.h"
+
 #include "core/content.hpp"
 #include "core/debug.hpp"
 #include "core/sync/Event.hpp"
 
+#include "engine/file/archive.hpp"
 #include "engine/file/config.hpp"
 #include "engine/file/scoped_directory.hpp"
 #include "engine/file/system.hpp"
@@ -15,7 +18,10 @@
 
 #include <catch2/catch.hpp>
 
-static_hashes("tmpdir", "my read", "my scan", "strand");
+#include <atomic>
+#include <cstring>
+
+static_hashes("tmpdir", "my read", "my scan", "strand", "my archive");
 
 namespace
 {
@@ -35,7 +41,7 @@ namespace
 		{}
 	};
 
-	ext::ssize write_char(engine::file::system & /*filesystem*/, core::content & content, utility::any && data)
+	ext::ssize write_char(engine::file::system & /*filesystem*/, core::content & content, engine::task::any && data)
 	{
 		if (!debug_assert(data.type_id() == utility::type_id<char>()))
 			return 0;
@@ -91,8 +97,8 @@ TEST_CASE("file system can read files", "[engine][file]")
 		ful::assign(filepath1, ful::cstr_utf8("maybe.exists"));
 		ful::heap_string_utf8 filepath2;
 		ful::assign(filepath2, ful::cstr_utf8("folder/maybe.exists"));
-		engine::file::write(filesystem, tmpdir, std::move(filepath1), engine::Hash{}, write_char, utility::any(char(2)));
-		engine::file::write(filesystem, tmpdir, std::move(filepath2), engine::Hash{}, write_char, utility::any(char(3)), engine::file::flags::CREATE_DIRECTORIES);
+		engine::file::write(filesystem, tmpdir, std::move(filepath1), engine::Hash{}, write_char, engine::task::any(char(2)));
+		engine::file::write(filesystem, tmpdir, std::move(filepath2), engine::Hash{}, write_char, engine::task::any(char(3)), engine::file::flags::CREATE_DIRECTORIES);
 
 		ful::assign(filepath1, ful::cstr_utf8("maybe.exists"));
 		engine::file::read(
@@ -101,7 +107,7 @@ TEST_CASE("file system can read files", "[engine][file]")
 			tmpdir,
 			std::move(filepath1),
 			engine::Hash{},
-			[](engine::file::system & /*filesystem*/, core::content & content, utility::any & data)
+			[](engine::file::system & /*filesystem*/, core::content & content, engine::task::any & data)
 			{
 				if (!debug_assert(data.type_id() == utility::type_id<SyncData *>()))
 					return;
@@ -112,7 +118,7 @@ TEST_CASE("file system can read files", "[engine][file]")
 				sync_data.value = content.filepath() == u8"maybe.exists" ? int(read_char(content)) : -1;
 				sync_data.event.set();
 			},
-			utility::any(sync_data + 0));
+			engine::task::any(sync_data + 0));
 		ful::assign(filepath2, ful::cstr_utf8("folder/maybe.exists"));
 		engine::file::read(
 			filesystem,
@@ -120,7 +126,7 @@ TEST_CASE("file system can read files", "[engine][file]")
 			tmpdir,
 			std::move(filepath2),
 			engine::Hash{},
-			[](engine::file::system & /*filesystem*/, core::content & content, utility::any & data)
+			[](engine::file::system & /*filesystem*/, core::content & content, engine::task::any & data)
 			{
 				if (!debug_assert(data.type_id() == utility::type_id<SyncData *>()))
 					return;
@@ -131,7 +137,7 @@ TEST_CASE("file system can read files", "[engine][file]")
 				sync_data.value = content.filepath() == u8"folder/maybe.exists" ? int(read_char(content)) : -1;
 				sync_data.event.set();
 			},
-			utility::any(sync_data + 1));
+			engine::task::any(sync_data + 1));
 
 		REQUIRE(sync_data[0].event.wait(timeout));
 		REQUIRE(sync_data[1].event.wait(timeout));
@@ -139,6 +145,87 @@ TEST_CASE("file system can read files", "[engine][file]")
 		CHECK(sync_data[1].value == 3);
 	}
 
+	SECTION("more of them than can be in flight at once")
+	{
+		// the reads are batched, at most a few hundred at a time
+		constexpr int file_count = 600;
+
+		struct SyncData
+		{
+			std::atomic_int written{0};
+			core::sync::Event<true> written_event;
+			std::atomic_int count{0};
+			std::atomic_int sum{0};
+			core::sync::Event<true> event;
+		} sync_data;
+
+		const auto make_filepath = [](int i)
+		{
+			ful::heap_string_utf8 filepath;
+			ful::assign(filepath, ful::cstr_utf8("many/"));
+			ful::push_back(filepath, ful::char8{static_cast<char>('a' + i / 26)});
+			ful::push_back(filepath, ful::char8{static_cast<char>('a' + i % 26)});
+			return filepath;
+		};
+
+		for (int i = 0; i < file_count; i++)
+		{
+			engine::file::write(
+				filesystem,
+				tmpdir,
+				make_filepath(i),
+				engine::Hash{},
+				[](engine::file::system & /*filesystem*/, core::content & content, engine::task::any && data) -> ext::ssize
+				{
+					if (!debug_assert(data.type_id() == utility::type_id<SyncData *>()))
+						return 0;
+
+					auto & sync_data = *utility::any_cast<SyncData *>(data);
+
+					if (++sync_data.written == file_count)
+					{
+						sync_data.written_event.set();
+					}
+
+					if (content.size() == 0)
+						return 0;
+
+					*static_cast<char *>(content.data()) = 1;
+					return 1;
+				},
+				engine::task::any(&sync_data),
+				engine::file::flags::CREATE_DIRECTORIES);
+		}
+		REQUIRE(sync_data.written_event.wait(timeout));
+
+		for (int i = 0; i < file_count; i++)
+		{
+			engine::file::read(
+				filesystem,
+				engine::Token{},
+				tmpdir,
+				make_filepath(i),
+				engine::Hash{},
+				[](engine::file::system & /*filesystem*/, core::content & content, engine::task::any & data)
+				{
+					if (!debug_assert(data.type_id() == utility::type_id<SyncData *>()))
+						return;
+
+					auto & sync_data = *utility::any_cast<SyncData *>(data);
+
+					sync_data.sum += read_char(content);
+					if (++sync_data.count == file_count)
+					{
+						sync_data.event.set();
+					}
+				},
+				engine::task::any(&sync_data));
+		}
+
+		REQUIRE(sync_data.event.wait(timeout));
+		CHECK(sync_data.sum == file_count);
+	}
+
 	SECTION("and watch later changes")
 	{
 		struct SyncData
@@ -156,7 +243,7 @@ TEST_CASE("file system can read files", "[engine][file]")
 
 		ful::heap_string_utf8 filepath1;
 		ful::assign(filepath1, ful::cstr_utf8("folder/maybe.exists"));
-		engine::file::write(filesystem, tmpdir, std::move(filepath1), engine::Hash("strand"), write_char, utility::any(char(3)), engine::file::flags::CREATE_DIRECTORIES);
+		engine::file::write(filesystem, tmpdir, std::move(filepath1), engine::Hash("strand"), write_char, engine::task::any(char(3)), engine::file::flags::CREATE_DIRECTORIES);
 
 		ful::assign(filepath1, ful::cstr_utf8("folder/maybe.exists"));
 		engine::file::read(
@@ -165,7 +252,7 @@ TEST_CASE("file system can read files", "[engine][file]")
 			tmpdir,
 			std::move(filepath1),
 			engine::Hash("strand"),
-			[](engine::file::system & /*filesystem*/, core::content & content, utility::any & data)
+			[](engine::file::system & /*filesystem*/, core::content & content, engine::task::any & data)
 		{
 			if (!debug_assert(data.type_id() == utility::type_id<SyncData *>()))
 				return;
@@ -192,7 +279,7 @@ TEST_CASE("file system can read files", "[engine][file]")
 				sync_data.event_7.set();
 			}
 		},
-			utility::any(&sync_data),
+			engine::task::any(&sync_data),
 			engine::file::flags::ADD_WATCH);
 
 		scoped_watch watch(filesystem, engine::Token(engine::Hash("my read")));
@@ -201,7 +288,7 @@ TEST_CASE("file system can read files", "[engine][file]")
 		CHECK(sync_data.value_3 == 3);
 
 		ful::assign(filepath1, ful::cstr_utf8("folder/maybe.exists"));
-		engine::file::write(filesystem, tmpdir, std::move(filepath1), engine::Hash("strand"), write_char, utility::any(char(7)), engine::file::flags::OVERWRITE_EXISTING);
+		engine::file::write(filesystem, tmpdir, std::move(filepath1), engine::Hash("strand"), write_char, engine::task::any(char(7)), engine::file::flags::OVERWRITE_EXISTING);
 
 		REQUIRE(sync_data.event_7.wait(timeout));
 		CHECK(sync_data.value_7 == 7);
@@ -228,7 +315,7 @@ TEST_CASE("file system can scan directories", "[engine][file]")
 			engine::Token{},
 			tmpdir,
 			engine::Hash{},
-			[](engine::file::system & /*filesystem*/, engine::Hash directory, ful::heap_string_utf8 && existing_files, ful::heap_string_utf8 && /*removed_files*/, utility::any & data)
+			[](engine::file::system & /*filesystem*/, engine::Hash directory, ful::heap_string_utf8 && existing_files, ful::heap_string_utf8 && /*removed_files*/, engine::task::any & data)
 		{
 			if (!debug_assert(data.type_id() == utility::type_id<SyncData *>()))
 				return;
@@ -252,7 +339,7 @@ TEST_CASE("file system can scan directories", "[engine][file]")
 			}
 			sync_data.event.set();
 		},
-			utility::any(&sync_data));
+			engine::task::any(&sync_data));
 
 		REQUIRE(sync_data.event.wait(timeout));
 		REQUIRE(sync_data.count == 1);
@@ -270,15 +357,15 @@ TEST_CASE("file system can scan directories", "[engine][file]")
 		ful::assign(filepath1, ful::cstr_utf8("file.whatever"));
 		ful::heap_string_utf8 filepath2;
 		ful::assign(filepath2, ful::cstr_utf8("folder/maybe.exists"));
-		engine::file::write(filesystem, tmpdir, std::move(filepath1), engine::Hash{}, write_char, utility::any(char(2)));
-		engine::file::write(filesystem, tmpdir, std::move(filepath2), engine::Hash{}, write_char, utility::any(char(3)), engine::file::flags::CREATE_DIRECTORIES);
+		engine::file::write(filesystem, tmpdir, std::move(filepath1), engine::Hash{}, write_char, engine::task::any(char(2)));
+		engine::file::write(filesystem, tmpdir, std::move(filepath2), engine::Hash{}, write_char, engine::task::any(char(3)), engine::file::flags::CREATE_DIRECTORIES);
 
 		engine::file::scan(
 			filesystem,
 			engine::Token{},
 			tmpdir,
 			engine::Hash{},
-			[](engine::file::system & /*filesystem*/, engine::Hash directory, ful::heap_string_utf8 && existing_files, ful::heap_string_utf8 && /*removed_files*/, utility::any & data)
+			[](engine::file::system & /*filesystem*/, engine::Hash directory, ful::heap_string_utf8 && existing_files, ful::heap_string_utf8 && /*removed_files*/, engine::task::any & data)
 		{
 			if (!debug_assert(data.type_id() == utility::type_id<SyncData *>()))
 				return;
@@ -302,7 +389,7 @@ TEST_CASE("file system can scan directories", "[engine][file]")
 			}
 			sync_data.event.set();
 		},
-			utility::any(&sync_data),
+			engine::task::any(&sync_data),
 			engine::file::flags::RECURSE_DIRECTORIES);
 
 		REQUIRE(sync_data.event.wait(timeout));
@@ -322,7 +409,7 @@ TEST_CASE("file system can scan directories", "[engine][file]")
 			engine::Token(engine::Hash("my scan")),
 			tmpdir,
 			engine::Hash{},
-			[](engine::file::system & /*filesystem*/, engine::Hash directory, ful::heap_string_utf8 && existing_files, ful::heap_string_utf8 && /*removed_files*/, utility::any & data)
+			[](engine::file::system & /*filesystem*/, engine::Hash directory, ful::heap_string_utf8 && existing_files, ful::heap_string_utf8 && /*removed_files*/, engine::task::any & data)
 			{
 				if (!debug_assert(data.type_id() == utility::type_id<SyncData *>()))
 					return;
@@ -355,7 +442,7 @@ TEST_CASE("file system can scan directories", "[engine][file]")
 				}
 				sync_data.event.set();
 			},
-			utility::any(&sync_data),
+			engine::task::any(&sync_data),
 			engine::file::flags::RECURSE_DIRECTORIES | engine::file::flags::ADD_WATCH);
 
 		scoped_watch watch(filesystem, engine::Token(engine::Hash("my scan")));
@@ -366,7 +453,7 @@ TEST_CASE("file system can scan directories", "[engine][file]")
 
 		ful::heap_string_utf8 filepath1;
 		ful::assign(filepath1, ful::cstr_utf8("file.whatever"));
-		engine::file::write(filesystem, tmpdir, std::move(filepath1), engine::Hash{}, write_char, utility::any(char(2)));
+		engine::file::write(filesystem, tmpdir, std::move(filepath1), engine::Hash{}, write_char, engine::task::any(char(2)));
 
 		REQUIRE(sync_data.event.wait(timeout));
 		REQUIRE(sync_data.count == 2);
@@ -374,7 +461,7 @@ TEST_CASE("file system can scan directories", "[engine][file]")
 
 		ful::heap_string_utf8 filepath2;
 		ful::assign(filepath2, ful::cstr_utf8("folder/maybe.exists"));
-		engine::file::write(filesystem, tmpdir, std::move(filepath2), engine::Hash{}, write_char, utility::any(char(3)), engine::file::flags::CREATE_DIRECTORIES);
+		engine::file::write(filesystem, tmpdir, std::move(filepath2), engine::Hash{}, write_char, engine::task::any(char(3)), engine::file::flags::CREATE_DIRECTORIES);
 
 		REQUIRE(sync_data.event.wait(timeout));
 		REQUIRE(sync_data.count == 3);
@@ -402,8 +489,8 @@ TEST_CASE("file system can write files", "[engine][file]")
 		ful::assign(filepath1, ful::cstr_utf8("new.file"));
 		ful::heap_string_utf8 filepath2;
 		ful::assign(filepath2, ful::cstr_utf8("new.file"));
-		engine::file::write(filesystem, tmpdir, std::move(filepath1), engine::Hash("strand"), write_char, utility::any(char(2)));
-		engine::file::write(filesystem, tmpdir, std::move(filepath2), engine::Hash("strand"), write_char, utility::any(char(3)));
+		engine::file::write(filesystem, tmpdir, std::move(filepath1), engine::Hash("strand"), write_char, engine::task::any(char(2)));
+		engine::file::write(filesystem, tmpdir, std::move(filepath2), engine::Hash("strand"), write_char, engine::task::any(char(3)));
 
 		ful::assign(filepath1, ful::cstr_utf8("new.file"));
 		engine::file::read(
@@ -412,7 +499,7 @@ TEST_CASE("file system can write files", "[engine][file]")
 			tmpdir,
 			std::move(filepath1),
 			engine::Hash("strand"),
-			[](engine::file::system & /*filesystem*/, core::content & content, utility::any & data)
+			[](engine::file::system & /*filesystem*/, core::content & content, engine::task::any & data)
 			{
 				if (!debug_assert(data.type_id() == utility::type_id<SyncData *>()))
 					return;
@@ -422,7 +509,7 @@ TEST_CASE("file system can write files", "[engine][file]")
 				sync_data.value = content.filepath() == u8"new.file" ? int(read_char(content)) + int(read_char(content, 1)) : -1;
 				sync_data.event.set();
 			},
-			utility::any(&sync_data));
+			engine::task::any(&sync_data));
 
 		REQUIRE(sync_data.event.wait(timeout));
 		CHECK(sync_data.value == 2 - 1);
@@ -443,8 +530,8 @@ TEST_CASE("file system can write files", "[engine][file]")
 		ful::assign(filepath1, ful::cstr_utf8("new.file"));
 		ful::heap_string_utf8 filepath2;
 		ful::assign(filepath2, ful::cstr_utf8("new.file"));
-		engine::file::write(filesystem, tmpdir, std::move(filepath1), engine::Hash("strand"), write_char, utility::any(char(2)));
-		engine::file::write(filesystem, tmpdir, std::move(filepath2), engine::Hash("strand"), write_char, utility::any(char(3)), engine::file::flags::OVERWRITE_EXISTING);
+		engine::file::write(filesystem, tmpdir, std::move(filepath1), engine::Hash("strand"), write_char, engine::task::any(char(2)));
+		engine::file::write(filesystem, tmpdir, std::move(filepath2), engine::Hash("strand"), write_char, engine::task::any(char(3)), engine::file::flags::OVERWRITE_EXISTING);
 
 		ful::assign(filepath1, ful::cstr_utf8("new.file"));
 		engine::file::read(
@@ -453,7 +540,7 @@ TEST_CASE("file system can write files", "[engine][file]")
 			tmpdir,
 			std::move(filepath1),
 			engine::Hash("strand"),
-			[](engine::file::system & /*filesystem*/, core::content & content, utility::any & data)
+			[](engine::file::system & /*filesystem*/, core::content & content, engine::task::any & data)
 			{
 				if (!debug_assert(data.type_id() == utility::type_id<SyncData *>()))
 					return;
@@ -463,7 +550,7 @@ TEST_CASE("file system can write files", "[engine][file]")
 				sync_data.value = content.filepath() == u8"new.file" ? int(read_char(content)) + int(read_char(content, 1)) : -1;
 				sync_data.event.set();
 			},
-			utility::any(&sync_data));
+			engine::task::any(&sync_data));
 
 		REQUIRE(sync_data.event.wait(timeout));
 		CHECK(sync_data.value == 3 - 1);
@@ -484,8 +571,8 @@ TEST_CASE("file system can write files", "[engine][file]")
 		ful::assign(filepath1, ful::cstr_utf8("new.file"));
 		ful::heap_string_utf8 filepath2;
 		ful::assign(filepath2, ful::cstr_utf8("new.file"));
-		engine::file::write(filesystem, tmpdir, std::move(filepath1), engine::Hash("strand"), write_char, utility::any(char(2)));
-		engine::file::write(filesystem, tmpdir, std::move(filepath2), engine::Hash("strand"), write_char, utility::any(char(3)), engine::file::flags::APPEND_EXISTING);
+		engine::file::write(filesystem, tmpdir, std::move(filepath1), engine::Hash("strand"), write_char, engine::task::any(char(2)));
+		engine::file::write(filesystem, tmpdir, std::move(filepath2), engine::Hash("strand"), write_char, engine::task::any(char(3)), engine::file::flags::APPEND_EXISTING);
 
 		ful::assign(filepath1, ful::cstr_utf8("new.file"));
 		engine::file::read(
@@ -494,7 +581,7 @@ TEST_CASE("file system can write files", "[engine][file]")
 			tmpdir,
 			std::move(filepath1),
 			engine::Hash("strand"),
-			[](engine::file::system & /*filesystem*/, core::content & content, utility::any & data)
+			[](engine::file::system & /*filesystem*/, core::content & content, engine::task::any & data)
 			{
 				if (!debug_assert(data.type_id() == utility::type_id<SyncData *>()))
 					return;
@@ -504,11 +591,434 @@ TEST_CASE("file system can write files", "[engine][file]")
 				sync_data.value = content.filepath() == u8"new.file" ? int(read_char(content)) + int(read_char(content, 1)) + int(read_char(content, 2)) : -1;
 				sync_data.event.set();
 			},
-			utility::any(&sync_data));
+			engine::task::any(&sync_data));
 
 		REQUIRE(sync_data.event.wait(timeout));
 		CHECK(sync_data.value == 5 - 1);
 	}
 }
 
+#if FILE_SYSTEM_USE_POSIX
+
+TEST_CASE("file system reads files in the way that suits their size", "[engine][file]")
+{
+	struct SyncData
+	{
+		int value = 0;
+		core::sync::Event<true> event;
+
+		static void read(engine::file::system & /*filesystem*/, core::content & content, engine::task::any & data)
+		{
+			if (!debug_assert(data.type_id() == utility::type_id<SyncData *>()))
+				return;
+
+			auto & sync_data = *utility::any_cast<SyncData *>(data);
+
+			sync_data.value = int(read_char(content));
+			sync_data.event.set();
+		}
+	};
+
+	engine::file::config_t config;
+
+	// note small files that are read through io_uring are counted as
+	// ring reads rather than buffered ones, bigger files are mapped by
+	// the read threads either way
+
+	SECTION("small files are copied")
+	{
+		engine::task::scheduler taskscheduler(1);
+		engine::file::system filesystem(taskscheduler, engine::file::directory::working_directory(), std::move(config));
+		engine::file::scoped_directory tmpdir(filesystem, engine::Hash("tmpdir"));
+
+		SyncData sync_data;
+
+		ful::heap_string_utf8 filepath;
+		ful::assign(filepath, ful::cstr_utf8("small.file"));
+		engine::file::write(filesystem, tmpdir, std::move(filepath), engine::Hash("strand"), write_char, engine::task::any(char(5)), engine::file::flags::OVERWRITE_EXISTING);
+		ful::assign(filepath, ful::cstr_utf8("small.file"));
+		engine::file::read(filesystem, engine::Token{}, tmpdir, std::move(filepath), engine::Hash("strand"), SyncData::read, engine::task::any(&sync_data));
+
+		REQUIRE(sync_data.event.wait(timeout));
+		CHECK(sync_data.value == 5);
+
+		const engine::file::read_statistics statistics = engine::file::get_read_statistics(filesystem);
+		CHECK(statistics.buffered + statistics.ring == 1);
+		CHECK(statistics.populated == 0);
+		CHECK(statistics.mapped == 0);
+	}
+
+	SECTION("bigger files are mapped and paged in at once")
+	{
+		config.small_file_size = 0;
+
+		engine::task::scheduler taskscheduler(1);
+		engine::file::system filesystem(taskscheduler, engine::file::directory::working_directory(), std::move(config));
+		engine::file::scoped_directory tmpdir(filesystem, engine::Hash("tmpdir"));
+
+		SyncData sync_data;
+
+		ful::heap_string_utf8 filepath;
+		ful::assign(filepath, ful::cstr_utf8("small.file"));
+		engine::file::write(filesystem, tmpdir, std::move(filepath), engine::Hash("strand"), write_char, engine::task::any(char(6)), engine::file::flags::OVERWRITE_EXISTING);
+		ful::assign(filepath, ful::cstr_utf8("small.file"));
+		engine::file::read(filesystem, engine::Token{}, tmpdir, std::move(filepath), engine::Hash("strand"), SyncData::read, engine::task::any(&sync_data));
+
+		REQUIRE(sync_data.event.wait(timeout));
+		CHECK(sync_data.value == 6);
+
+		const engine::file::read_statistics statistics = engine::file::get_read_statistics(filesystem);
+		CHECK(statistics.populated == 1);
+		CHECK(statistics.mapped == 0);
+		CHECK(statistics.buffered == 0);
+		CHECK(statistics.ring == 0);
+	}
+
+	SECTION("huge files are mapped")
+	{
+		config.small_file_size = 0;
+		config.populate_file_size = 0;
+
+		engine::task::scheduler taskscheduler(1);
+		engine::file::system filesystem(taskscheduler, engine::file::directory::working_directory(), std::move(config));
+		engine::file::scoped_directory tmpdir(filesystem, engine::Hash("tmpdir"));
+
+		SyncData sync_data;
+
+		ful::heap_string_utf8 filepath;
+		ful::assign(filepath, ful::cstr_utf8("small.file"));
+		engine::file::write(filesystem, tmpdir, std::move(filepath), engine::Hash("strand"), write_char, engine::task::any(char(7)), engine::file::flags::OVERWRITE_EXISTING);
+		ful::assign(filepath, ful::cstr_utf8("small.file"));
+		engine::file::read(filesystem, engine::Token{}, tmpdir, std::move(filepath), engine::Hash("strand"), SyncData::read, engine::task::any(&sync_data));
+
+		REQUIRE(sync_data.event.wait(timeout));
+		CHECK(sync_data.value == 7);
+
+		const engine::file::read_statistics statistics = engine::file::get_read_statistics(filesystem);
+		CHECK(statistics.mapped == 1);
+		CHECK(statistics.populated == 0);
+		CHECK(statistics.buffered == 0);
+		CHECK(statistics.ring == 0);
+	}
+}
+
+TEST_CASE("file system calls back the reads on a strand in the order they were requested", "[engine][file]")
+{
+	struct SyncData
+	{
+		int values[2] = {-1, -1};
+		std::atomic_int count{0};
+		core::sync::Event<true> event;
+
+		static void read(engine::file::system & /*filesystem*/, core::content & content, engine::task::any & data)
+		{
+			if (!debug_assert(data.type_id() == utility::type_id<SyncData *>()))
+				return;
+
+			auto & sync_data = *utility::any_cast<SyncData *>(data);
+
+			const int index = sync_data.count++;
+			if (index < 2)
+			{
+				sync_data.values[index] = int(read_char(content));
+			}
+			if (index == 1)
+			{
+				sync_data.event.set();
+			}
+		}
+	};
+
+	// the first file is mapped on a read thread, which takes longer than
+	// copying the second one, especially if it is read on the ring
+	engine::file::config_t config;
+	config.small_file_size = 1;
+
+	engine::task::scheduler taskscheduler(1);
+	engine::file::system filesystem(taskscheduler, engine::file::directory::working_directory(), std::move(config));
+	engine::file::scoped_directory tmpdir(filesystem, engine::Hash("tmpdir"));
+
+	SyncData sync_data;
+
+	ful::heap_string_utf8 filepath;
+	ful::assign(filepath, ful::cstr_utf8("big.file"));
+	engine::file::write(
+		filesystem,
+		tmpdir,
+		std::move(filepath),
+		engine::Hash("strand"),
+		[](engine::file::system & /*filesystem*/, core::content & content, engine::task::any && /*data*/) -> ext::ssize
+		{
+			if (content.size() < 2)
+				return 0;
+
+			const char numbers[] = {char(2), char(2)};
+			return ful::memcopy(numbers + 0, numbers + 2, static_cast<char *>(content.data())) - static_cast<char *>(content.data());
+		},
+		engine::task::any(),
+		engine::file::flags::OVERWRITE_EXISTING);
+	ful::assign(filepath, ful::cstr_utf8("small.file"));
+	engine::file::write(filesystem, tmpdir, std::move(filepath), engine::Hash("strand"), write_char, engine::task::any(char(3)), engine::file::flags::OVERWRITE_EXISTING);
+
+	ful::assign(filepath, ful::cstr_utf8("big.file"));
+	engine::file::read(filesystem, engine::Token{}, tmpdir, std::move(filepath), engine::Hash("strand"), SyncData::read, engine::task::any(&sync_data));
+	ful::assign(filepath, ful::cstr_utf8("small.file"));
+	engine::file::read(filesystem, engine::Token{}, tmpdir, std::move(filepath), engine::Hash("strand"), SyncData::read, engine::task::any(&sync_data));
+
+	REQUIRE(sync_data.event.wait(timeout));
+	CHECK(sync_data.values[0] == 2);
+	CHECK(sync_data.values[1] == 3);
+
+	const engine::file::read_statistics statistics = engine::file::get_read_statistics(filesystem);
+	CHECK(statistics.populated == 1);
+	CHECK(statistics.buffered + statistics.ring == 1);
+}
+
+#endif
+
+TEST_CASE("file system can stream files", "[engine][file]")
+{
+	engine::file::config_t config;
+	config.stream_size = 4;
+
+	engine::task::scheduler taskscheduler(1);
+	engine::file::system filesystem(taskscheduler, engine::file::directory::working_directory(), std::move(config));
+	engine::file::scoped_directory tmpdir(filesystem, engine::Hash("tmpdir"));
+
+	struct SyncData
+	{
+		int chunks = 0;
+		int limit = 100;
+		char text[16] = {};
+		ext::usize file_size = 0;
+		core::sync::Event<true> event;
+
+		static bool stream(engine::file::system & /*filesystem*/, core::content & chunk, ext::usize offset, ext::usize file_size, engine::task::any & data)
+		{
+			if (!debug_assert(data.type_id() == utility::type_id<SyncData *>()))
+				return false;
+
+			auto & sync_data = *utility::any_cast<SyncData *>(data);
+
+			sync_data.chunks++;
+			sync_data.file_size = file_size;
+			if (offset + chunk.size() <= sizeof sync_data.text)
+			{
+				ful::memcopy(static_cast<const char *>(chunk.data()), static_cast<const char *>(chunk.data()) + chunk.size(), sync_data.text + offset);
+			}
+
+			// the last chunk is the one that reaches the end of the file
+			if (offset + chunk.size() == file_size || sync_data.chunks == sync_data.limit)
+			{
+				sync_data.event.set();
+				return false;
+			}
+			return true;
+		}
+	};
+
+	// note strand must be set in order for the reads and writes not to
+	// collide, since they all operate on the same file
+
+	ful::heap_string_utf8 filepath;
+	ful::assign(filepath, ful::cstr_utf8("stream.file"));
+	engine::file::write(
+		filesystem,
+		tmpdir,
+		std::move(filepath),
+		engine::Hash("strand"),
+		[](engine::file::system & /*filesystem*/, core::content & content, engine::task::any && /*data*/) -> ext::ssize
+		{
+			const char digits[] = "0123456789";
+			if (content.size() < sizeof digits - 1)
+				return 0;
+
+			return ful::memcopy(digits + 0, digits + sizeof digits - 1, static_cast<char *>(content.data())) - static_cast<char *>(content.data());
+		},
+		engine::task::any(),
+		engine::file::flags::OVERWRITE_EXISTING);
+
+	SECTION("in chunks")
+	{
+		SyncData sync_data;
+
+		ful::assign(filepath, ful::cstr_utf8("stream.file"));
+		engine::file::stream(filesystem, tmpdir, std::move(filepath), engine::Hash("strand"), SyncData::stream, engine::task::any(&sync_data));
+
+		REQUIRE(sync_data.event.wait(timeout));
+		CHECK(sync_data.chunks == 3);
+		CHECK(sync_data.file_size == 10);
+		CHECK(ful::cstr_utf8(sync_data.text) == u8"0123456789");
+	}
+
+	SECTION("and stop early")
+	{
+		SyncData sync_data;
+		sync_data.limit = 2;
+
+		ful::assign(filepath, ful::cstr_utf8("stream.file"));
+		engine::file::stream(filesystem, tmpdir, std::move(filepath), engine::Hash("strand"), SyncData::stream, engine::task::any(&sync_data));
+
+		REQUIRE(sync_data.event.wait(timeout));
+		CHECK(sync_data.chunks == 2);
+		CHECK(ful::cstr_utf8(sync_data.text) == u8"01234567");
+	}
+
+	SECTION("and report those that are missing")
+	{
+		SyncData sync_data;
+
+		ful::assign(filepath, ful::cstr_utf8("missing.file"));
+		engine::file::stream(filesystem, tmpdir, std::move(filepath), engine::Hash("strand"), SyncData::stream, engine::task::any(&sync_data));
+
+		REQUIRE(sync_data.event.wait(timeout));
+		CHECK(sync_data.chunks == 1);
+		CHECK(sync_data.file_size == 0);
+	}
+}
+
+#if FILE_SYSTEM_USE_POSIX
+
+TEST_CASE("file system can read archives", "[engine][file]")
+{
+	engine::task::scheduler taskscheduler(1);
+	engine::file::system filesystem(taskscheduler, engine::file::directory::working_directory(), engine::file::config_t{});
+	engine::file::scoped_directory tmpdir(filesystem, engine::Hash("tmpdir"));
+
+	struct SyncData
+	{
+		int value = 0;
+		core::sync::Event<true> event;
+
+		static ext::ssize pack(engine::file::system & /*filesystem*/, core::content & content, engine::task::any && /*data*/)
+		{
+			// every file holds the first letter of its name
+			engine::file::archive_builder builder;
+			if (!(builder.add(ful::view_utf8("a.txt", 5), 1) && builder.add(ful::view_utf8("folder/b.txt", 12), 1) && builder.finish()))
+				return 0;
+
+			if (!debug_assert(builder.size() <= content.size()))
+				return 0;
+
+			char * const data = static_cast<char *>(content.data());
+			builder.write_index(data);
+			for (const engine::file::archive_entry & entry : builder)
+			{
+				const ful::view_utf8 name = builder.name(entry);
+				data[entry.offset] = name.end()[-5];
+			}
+			return static_cast<ext::ssize>(builder.size());
+		}
+
+		static void read(engine::file::system & /*filesystem*/, core::content & content, engine::task::any & data)
+		{
+			if (!debug_assert(data.type_id() == utility::type_id<SyncData *>()))
+				return;
+
+			auto & sync_data = *utility::any_cast<SyncData *>(data);
+
+			sync_data.value = int(read_char(content));
+			sync_data.event.set();
+		}
+
+		static void scan(engine::file::system & /*filesystem*/, engine::Hash directory, ful::heap_string_utf8 && existing_files, ful::heap_string_utf8 && removed_files, engine::task::any & data)
+		{
+			if (!debug_assert(data.type_id() == utility::type_id<SyncData *>()))
+				return;
+
+			auto & sync_data = *utility::any_cast<SyncData *>(data);
+
+			if (directory == engine::Hash("my archive") && removed_files == u8"")
+			{
+				if (existing_files == u8"a.txt")
+				{
+					sync_data.value = 1;
+				}
+				else if (existing_files == u8"a.txt;folder/b.txt" || existing_files == u8"folder/b.txt;a.txt")
+				{
+					sync_data.value = 2;
+				}
+				else
+				{
+					sync_data.value = -1;
+				}
+			}
+			else
+			{
+				sync_data.value = -1;
+			}
+			sync_data.event.set();
+		}
+	};
+
+	{
+		SyncData sync_data;
+
+		ful::heap_string_utf8 filepath;
+		ful::assign(filepath, ful::cstr_utf8("packed.fiwa"));
+		engine::file::write(filesystem, tmpdir, std::move(filepath), engine::Hash("strand"), SyncData::pack, engine::task::any());
+		ful::assign(filepath, ful::cstr_utf8("packed.fiwa"));
+		engine::file::read(filesystem, engine::Token{}, tmpdir, std::move(filepath), engine::Hash("strand"), SyncData::read, engine::task::any(&sync_data));
+
+		REQUIRE(sync_data.event.wait(timeout));
+	}
+
+	ful::heap_string_utf8 archivepath;
+	ful::assign(archivepath, ful::cstr_utf8("packed.fiwa"));
+	engine::file::register_archive(filesystem, engine::Hash("my archive"), std::move(archivepath), tmpdir);
+
+	SECTION("that have the file")
+	{
+		SyncData sync_data;
+
+		ful::heap_string_utf8 filepath;
+		ful::assign(filepath, ful::cstr_utf8("folder/b.txt"));
+		engine::file::read(filesystem, engine::Token{}, engine::Hash("my archive"), std::move(filepath), engine::Hash{}, SyncData::read, engine::task::any(&sync_data));
+
+		REQUIRE(sync_data.event.wait(timeout));
+		CHECK(sync_data.value == 'b');
+
+		const engine::file::read_statistics statistics = engine::file::get_read_statistics(filesystem);
+		CHECK(statistics.archived == 1);
+	}
+
+	SECTION("that do not have the file")
+	{
+		SyncData sync_data;
+
+		ful::heap_string_utf8 filepath;
+		ful::assign(filepath, ful::cstr_utf8("b.txt"));
+		engine::file::read(filesystem, engine::Token{}, engine::Hash("my archive"), std::move(filepath), engine::Hash{}, SyncData::read, engine::task::any(&sync_data));
+
+		REQUIRE(sync_data.event.wait(timeout));
+		CHECK(sync_data.value == -1);
+	}
+
+	SECTION("that are scanned")
+	{
+		SyncData sync_data;
+
+		engine::file::scan(filesystem, engine::Token{}, engine::Hash("my archive"), engine::Hash{}, SyncData::scan, engine::task::any(&sync_data));
+
+		REQUIRE(sync_data.event.wait(timeout));
+		CHECK(sync_data.value == 1);
+	}
+
+	SECTION("that are scanned recursively")
+	{
+		SyncData sync_data;
+
+		scoped_watch watch(filesystem, engine::Token(engine::Hash("my scan")));
+
+		engine::file::scan(filesystem, engine::Token(engine::Hash("my scan")), engine::Hash("my archive"), engine::Hash{}, SyncData::scan, engine::task::any(&sync_data), engine::file::flags::RECURSE_DIRECTORIES | engine::file::flags::ADD_WATCH);
+
+		REQUIRE(sync_data.event.wait(timeout));
+		CHECK(sync_data.value == 2);
+	}
+
+	engine::file::unregister_directory(filesystem, engine::Hash("my archive"));
+}
+
+#endif
+
 #endif
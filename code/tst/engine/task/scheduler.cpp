@@ -1,13 +1,17 @@
+#include "config.h"
+
 #include "core/debug.hpp"
 #include "core/sync/Event.hpp"
 
 #include "engine/task/scheduler.hpp"
 
 #include "utility/any.hpp"
+#include "utility/container/vector.hpp"
 
 #include <catch2/catch.hpp>
 
 #include <atomic>
+#include <chrono>
 
 namespace
 {
@@ -53,7 +57,7 @@ TEST_CASE("task scheduler", "[engine][task]")
 			engine::task::post_work(
 				taskscheduler,
 				anystrand,
-				[](engine::task::scheduler & scheduler, engine::Hash strand, utility::any && data)
+				[](engine::task::scheduler & scheduler, engine::Hash strand, engine::task::any && data)
 				{
 					if (!debug_assert(data.type_id() == utility::type_id<Data *>()))
 						return;
@@ -70,7 +74,7 @@ TEST_CASE("task scheduler", "[engine][task]")
 						}
 					}
 				},
-				utility::any(&data));
+				engine::task::any(&data));
 		}
 
 		REQUIRE(data.event.wait(timeout));
@@ -80,53 +84,655 @@ TEST_CASE("task scheduler", "[engine][task]")
 	{
 		constexpr engine::Hash mystrand = engine::Hash("mystrand");
 
-		Data data(taskscheduler, mystrand);
+		struct OverlapData
+		{
+			Data data;
+
+			std::atomic_int inside{};
+			std::atomic_int overlaps{};
+
+			explicit OverlapData(engine::task::scheduler & scheduler, engine::Hash strand)
+				: data(scheduler, strand)
+			{}
+		};
+
+		OverlapData data(taskscheduler, mystrand);
 
+		// note the priorities differ, so that the strand is scheduled
+		// again as more urgent works are posted to it
 		for (int i = 0; i < many_tasks; i++)
 		{
 			engine::task::post_work(
 				taskscheduler,
 				mystrand,
-				[](engine::task::scheduler & scheduler, engine::Hash strand, utility::any && data)
+				engine::task::priority::background,
+				[](engine::task::scheduler & scheduler, engine::Hash strand, engine::task::any && data)
 				{
-					if (!debug_assert(data.type_id() == utility::type_id<Data *>()))
+					if (!debug_assert(data.type_id() == utility::type_id<OverlapData *>()))
 						return;
 
-					Data * const d = utility::any_cast<Data *>(data);
+					OverlapData * const d = utility::any_cast<OverlapData *>(data);
 
-					if (d->scheduler == scheduler &&
-					    d->strand == strand &&
-					    d->count % 2 == 0)
+					if (d->inside++ != 0)
 					{
-						d->count++;
+						d->overlaps++;
 					}
+
+					if (d->data.scheduler == scheduler &&
+					    d->data.strand == strand &&
+					    d->data.count % 2 == 0)
+					{
+						d->data.count++;
+					}
+
+					d->inside--;
 				},
-				utility::any(&data));
+				engine::task::any(&data));
 
 			engine::task::post_work(
 				taskscheduler,
 				mystrand,
-				[](engine::task::scheduler & scheduler, engine::Hash strand, utility::any && data)
+				engine::task::priority::interactive,
+				[](engine::task::scheduler & scheduler, engine::Hash strand, engine::task::any && data)
 				{
-					if (!debug_assert(data.type_id() == utility::type_id<Data *>()))
+					if (!debug_assert(data.type_id() == utility::type_id<OverlapData *>()))
 						return;
 
-					Data * const d = utility::any_cast<Data *>(data);
+					OverlapData * const d = utility::any_cast<OverlapData *>(data);
 
-					if (d->scheduler == scheduler &&
-					    d->strand == strand &&
-					    d->count % 2 == 1)
+					if (d->inside++ != 0)
 					{
-						d->count++;
-						if (d->count == 2 * many_tasks)
-						{
-							d->event.set();
-						}
+						d->overlaps++;
+					}
+
+					const bool last = d->data.count + 1 == 2 * many_tasks;
+					if (d->data.scheduler == scheduler &&
+					    d->data.strand == strand &&
+					    d->data.count % 2 == 1)
+					{
+						d->data.count++;
+					}
+
+					d->inside--;
+
+					if (last)
+					{
+						d->data.event.set();
 					}
 				},
-				utility::any(&data));
+				engine::task::any(&data));
 		}
 
+		REQUIRE(data.data.event.wait(timeout));
+		CHECK(data.data.count == 2 * many_tasks);
+		CHECK(data.overlaps == 0);
+	}
+
+	SECTION("calls works within a strand in order")
+	{
+		constexpr engine::Hash mystrand = engine::Hash("mystrand");
+
+		struct OrderData
+		{
+			Data data;
+
+			std::atomic_int inside{};
+			std::atomic_int overlaps{};
+			std::atomic_int disorders{};
+
+			explicit OrderData(engine::task::scheduler & scheduler, engine::Hash strand)
+				: data(scheduler, strand)
+			{}
+		};
+
+		OrderData data(taskscheduler, mystrand);
+
+		for (int i = 0; i < many_tasks; i++)
+		{
+			engine::task::post_work(
+				taskscheduler,
+				mystrand,
+				[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, engine::task::any && data)
+				{
+					if (!debug_assert(data.type_id() == (utility::type_id<std::pair<OrderData *, int>>())))
+						return;
+
+					const auto p = utility::any_cast<std::pair<OrderData *, int>>(data);
+					OrderData * const d = p.first;
+
+					if (d->inside++ != 0)
+					{
+						d->overlaps++;
+					}
+
+					if (d->data.count != p.second)
+					{
+						d->disorders++;
+					}
+					d->data.count++;
+
+					d->inside--;
+
+					if (d->data.count == many_tasks)
+					{
+						d->data.event.set();
+					}
+				},
+				engine::task::any(std::make_pair(&data, i)));
+		}
+
+		REQUIRE(data.data.event.wait(timeout));
+		CHECK(data.overlaps == 0);
+		CHECK(data.disorders == 0);
+	}
+}
+
+TEST_CASE("task scheduler parallel for", "[engine][task]")
+{
+	engine::task::scheduler taskscheduler(max_threads);
+
+	constexpr int many_values = 1000;
+
+	utility::heap_vector<int> values;
+	REQUIRE(values.try_reserve(many_values));
+	for (int i = 0; i < many_values; i++)
+	{
+		REQUIRE(values.try_emplace_back(i));
+	}
+
+	SECTION("calls every value exactly once")
+	{
+		std::atomic_int calls{};
+
+		engine::task::parallel_for(
+			taskscheduler,
+			utility::span<int>(values.data(), values.size()),
+			7,
+			[&](utility::span<int> chunk)
+			{
+				CHECK(chunk.size() <= 7);
+
+				calls++;
+
+				for (int & value : chunk)
+				{
+					value = -value;
+				}
+			});
+
+		CHECK(calls == (many_values + 6) / 7);
+		for (int i = 0; i < many_values; i++)
+		{
+			CHECK(values[i] == -i);
+		}
+	}
+
+	SECTION("does nothing for an empty span")
+	{
+		std::atomic_int calls{};
+
+		engine::task::parallel_for(
+			taskscheduler,
+			utility::span<int>(values.data(), 0),
+			7,
+			[&](utility::span<int> /*chunk*/)
+			{
+				calls++;
+			});
+
+		CHECK(calls == 0);
+	}
+
+	SECTION("frees a range that is never joined")
+	{
+		engine::task::join_handle handle = engine::task::fork_range(
+			taskscheduler,
+			many_values,
+			10,
+			[](engine::task::scheduler & /*scheduler*/, ext::usize /*begin*/, ext::usize /*end*/, void * /*data*/)
+			{
+			},
+			nullptr);
+
+		CHECK(handle);
+	}
+
+	SECTION("can be nested in a chunk")
+	{
+		std::atomic_int sum{};
+
+		engine::task::parallel_for(
+			taskscheduler,
+			utility::span<int>(values.data(), values.size()),
+			100,
+			[&](utility::span<int> chunk)
+			{
+				engine::task::parallel_for(
+					taskscheduler,
+					chunk,
+					10,
+					[&](utility::span<int> subchunk)
+					{
+						for (int value : subchunk)
+						{
+							sum += value;
+						}
+					});
+			});
+
+		CHECK(sum == many_values * (many_values - 1) / 2);
+	}
+}
+
+namespace
+{
+#if TASK_USE_POOL
+	constexpr int max_blockers = max_threads;
+#else
+	constexpr int max_blockers = 1;
+#endif
+
+	// keeps the scheduler busy until the gate is opened, note that it
+	// has to outlive the scheduler
+	struct Blockers
+	{
+		std::atomic_int started{};
+		core::sync::Event<true> all_started;
+		core::sync::Event<true> gate;
+
+		void post(engine::task::scheduler & scheduler)
+		{
+			for (int i = 0; i < max_blockers; i++)
+			{
+				engine::task::post_work(
+					scheduler,
+					engine::Hash{},
+					[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, engine::task::any && data)
+					{
+						if (!debug_assert(data.type_id() == utility::type_id<Blockers *>()))
+							return;
+
+						Blockers * const b = utility::any_cast<Blockers *>(data);
+
+						if (++b->started == max_blockers)
+						{
+							b->all_started.set();
+						}
+						b->gate.wait(timeout);
+					},
+					engine::task::any(this));
+			}
+		}
+	};
+
+	struct PriorityData
+	{
+		std::atomic_int called{};
+		std::atomic_int called_before{-1};
+		core::sync::Event<true> all_called;
+		int total;
+
+		explicit PriorityData(int total)
+			: total(total)
+		{}
+	};
+
+	void count_work(engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, engine::task::any && data)
+	{
+		if (!debug_assert(data.type_id() == utility::type_id<PriorityData *>()))
+			return;
+
+		PriorityData * const d = utility::any_cast<PriorityData *>(data);
+
+		if (++d->called == d->total)
+		{
+			d->all_called.set();
+		}
+	}
+
+	void mark_work(engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, engine::task::any && data)
+	{
+		if (!debug_assert(data.type_id() == utility::type_id<PriorityData *>()))
+			return;
+
+		PriorityData * const d = utility::any_cast<PriorityData *>(data);
+
+		d->called_before = d->called.load();
+
+		if (++d->called == d->total)
+		{
+			d->all_called.set();
+		}
+	}
+}
+
+TEST_CASE("task scheduler calls interactive works before background works", "[engine][task]")
+{
+	Blockers blockers;
+	PriorityData data(many_tasks + 1);
+
+	engine::task::scheduler taskscheduler(max_threads);
+	{
+		blockers.post(taskscheduler);
+		REQUIRE(blockers.all_started.wait(timeout));
+
+		for (int i = 0; i < many_tasks; i++)
+		{
+			engine::task::post_work(taskscheduler, engine::Hash{}, engine::task::priority::background, count_work, engine::task::any(&data));
+		}
+		engine::task::post_work(taskscheduler, engine::Hash{}, engine::task::priority::interactive, mark_work, engine::task::any(&data));
+
+		blockers.gate.set();
+
+		REQUIRE(data.all_called.wait(timeout));
+	}
+
+	// every thread may give the background works a turn once before
+	// getting to the interactive work
+	CHECK(data.called_before >= 0);
+	CHECK(data.called_before <= max_blockers);
+
+	const engine::task::priority_stats interactive = engine::task::get_stats(taskscheduler, engine::task::priority::interactive);
+	CHECK(interactive.posted == 1);
+	CHECK(interactive.called == 1);
+
+	const engine::task::priority_stats background = engine::task::get_stats(taskscheduler, engine::task::priority::background);
+	CHECK(background.posted == many_tasks);
+	CHECK(background.called == many_tasks);
+	CHECK(interactive.max_wait_microseconds <= background.max_wait_microseconds);
+}
+
+TEST_CASE("task scheduler calls a strand at the priority of its most urgent work", "[engine][task]")
+{
+	constexpr engine::Hash mystrand = engine::Hash("mystrand");
+
+	Blockers blockers;
+	PriorityData data(many_tasks + 1);
+
+	engine::task::scheduler taskscheduler(max_threads);
+	{
+		blockers.post(taskscheduler);
+		REQUIRE(blockers.all_started.wait(timeout));
+
+		for (int i = 0; i < many_tasks; i++)
+		{
+			engine::task::post_work(taskscheduler, engine::Hash{}, engine::task::priority::normal, count_work, engine::task::any(&data));
+		}
+		engine::task::post_work(taskscheduler, mystrand, engine::task::priority::interactive, mark_work, engine::task::any(&data));
+
+		blockers.gate.set();
+
+		REQUIRE(data.all_called.wait(timeout));
+	}
+
+	CHECK(data.called_before >= 0);
+	CHECK(data.called_before <= max_blockers);
+}
+
+TEST_CASE("task scheduler calls every posted work before it is destroyed", "[engine][task]")
+{
+	Blockers blockers;
+	PriorityData data(2 * many_tasks);
+
+	{
+		engine::task::scheduler taskscheduler(max_threads);
+
+		blockers.post(taskscheduler);
+		REQUIRE(blockers.all_started.wait(timeout));
+
+		for (int i = 0; i < many_tasks; i++)
+		{
+			engine::task::post_work(taskscheduler, engine::Hash{}, engine::task::priority::background, count_work, engine::task::any(&data));
+			engine::task::post_work(taskscheduler, engine::Hash{}, engine::task::priority::normal, count_work, engine::task::any(&data));
+		}
+
+		// note the gate is left closed, so that the scheduler is told to
+		// stop before it gets to any of the works
+	}
+
+	CHECK(data.called == 2 * many_tasks);
+}
+
+TEST_CASE("task scheduler timers", "[engine][task]")
+{
+	struct TimerData
+	{
+		std::chrono::steady_clock::time_point posted = std::chrono::steady_clock::now();
+		std::atomic<std::chrono::steady_clock::rep> elapsed{};
+		std::atomic_int calls{};
+		core::sync::Event<true> event;
+	};
+
+	TimerData data;
+
+	engine::task::scheduler taskscheduler(max_threads);
+
+	SECTION("can call works after a delay")
+	{
+		const engine::task::timer_id timer = engine::task::post_work_after(
+			taskscheduler,
+			engine::Hash{},
+			20,
+			[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, engine::task::any && data)
+			{
+				if (!debug_assert(data.type_id() == utility::type_id<TimerData *>()))
+					return;
+
+				TimerData * const d = utility::any_cast<TimerData *>(data);
+
+				d->elapsed = (std::chrono::steady_clock::now() - d->posted).count();
+				d->calls++;
+				d->event.set();
+			},
+			engine::task::any(&data));
+		CHECK(timer != engine::task::timer_id{});
+
 		REQUIRE(data.event.wait(timeout));
+		CHECK(data.calls == 1);
+		CHECK(std::chrono::steady_clock::duration(data.elapsed) >= std::chrono::milliseconds(20));
+
+		CHECK_FALSE(engine::task::cancel_timer(taskscheduler, timer));
+	}
+
+	SECTION("does not call cancelled works")
+	{
+		const engine::task::timer_id timer = engine::task::post_work_after(
+			taskscheduler,
+			engine::Hash{},
+			20,
+			[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, engine::task::any && data)
+			{
+				if (!debug_assert(data.type_id() == utility::type_id<TimerData *>()))
+					return;
+
+				TimerData * const d = utility::any_cast<TimerData *>(data);
+
+				d->calls++;
+				d->event.set();
+			},
+			engine::task::any(&data));
+
+		CHECK(engine::task::cancel_timer(taskscheduler, timer));
+		CHECK_FALSE(data.event.wait(100));
+		CHECK(data.calls == 0);
+	}
+
+	SECTION("can call works periodically")
+	{
+		constexpr engine::Hash mystrand = engine::Hash("mystrand");
+
+		const engine::task::timer_id timer = engine::task::post_work_every(
+			taskscheduler,
+			mystrand,
+			5,
+			[](engine::task::scheduler & /*scheduler*/, engine::Hash strand, engine::task::any & data)
+			{
+				if (!debug_assert(data.type_id() == (utility::type_id<std::pair<TimerData *, int>>())))
+					return;
+
+				auto & p = *utility::any_cast<std::pair<TimerData *, int>>(&data);
+
+				// the data is kept between calls
+				if (strand == mystrand && p.second == p.first->calls)
+				{
+					p.second++;
+					if (++p.first->calls == 5)
+					{
+						p.first->event.set();
+					}
+				}
+			},
+			engine::task::any(std::make_pair(&data, 0)));
+
+		REQUIRE(data.event.wait(timeout));
+		CHECK(engine::task::cancel_timer(taskscheduler, timer));
+
+		const int calls = data.calls;
+		CHECK(calls >= 5);
+		CHECK(calls <= 6);
+	}
+}
+
+TEST_CASE("task scheduler calls works whose deadline has run out first", "[engine][task]")
+{
+	Blockers blockers;
+	PriorityData data(many_tasks + 1);
+
+	engine::task::scheduler taskscheduler(max_threads);
+	{
+		blockers.post(taskscheduler);
+		REQUIRE(blockers.all_started.wait(timeout));
+
+		for (int i = 0; i < many_tasks; i++)
+		{
+			engine::task::post_work(taskscheduler, engine::Hash{}, engine::task::priority::interactive, count_work, engine::task::any(&data));
+		}
+		engine::task::post_work(taskscheduler, engine::Hash{}, engine::task::priority::background, 0, mark_work, engine::task::any(&data));
+
+		blockers.gate.set();
+
+		REQUIRE(data.all_called.wait(timeout));
+	}
+
+	CHECK(data.called_before >= 0);
+	CHECK(data.called_before <= max_blockers);
+
+	const engine::task::priority_stats background = engine::task::get_stats(taskscheduler, engine::task::priority::background);
+	CHECK(background.called == 1);
+	CHECK(background.promoted == 1);
+}
+
+#if TASK_USE_POOL
+
+TEST_CASE("task scheduler calls works in parallel", "[engine][task]")
+{
+	engine::task::scheduler taskscheduler(max_threads);
+
+	struct Data
+	{
+		std::atomic_int started{};
+		std::atomic_int parallel{};
+		std::atomic_int finished{};
+		core::sync::Event<true> all_started;
+		core::sync::Event<true> all_finished;
+	};
+
+	constexpr engine::Hash anystrand = engine::Hash{};
+
+	Data data;
+
+	for (int i = 0; i < max_threads; i++)
+	{
+		engine::task::post_work(
+			taskscheduler,
+			anystrand,
+			[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, engine::task::any && data)
+			{
+				if (!debug_assert(data.type_id() == utility::type_id<Data *>()))
+					return;
+
+				Data * const d = utility::any_cast<Data *>(data);
+
+				if (++d->started == max_threads)
+				{
+					d->all_started.set();
+				}
+
+				if (d->all_started.wait(timeout))
+				{
+					d->parallel++;
+				}
+
+				if (++d->finished == max_threads)
+				{
+					d->all_finished.set();
+				}
+			},
+			engine::task::any(&data));
+	}
+
+	REQUIRE(data.all_finished.wait(timeout * (max_threads + 1)));
+	CHECK(data.parallel == max_threads);
+}
+
+#endif
+
+#if TASK_USE_POOL
+
+TEST_CASE("task scheduler calls works on different strands in parallel", "[engine][task]")
+{
+	engine::task::scheduler taskscheduler(max_threads);
+
+	struct Data
+	{
+		std::atomic_int started{};
+		std::atomic_int parallel{};
+		std::atomic_int finished{};
+		core::sync::Event<true> all_started;
+		core::sync::Event<true> all_finished;
+	};
+
+	Data data;
+
+	for (int i = 0; i < max_threads; i++)
+	{
+		const engine::Hash strand = engine::Hash(static_cast<engine::Hash::value_type>(i + 1));
+
+		// the second work on each strand must not be called until the
+		// first one is done
+		for (int j = 0; j < 2; j++)
+		{
+			engine::task::post_work(
+				taskscheduler,
+				strand,
+				[](engine::task::scheduler & /*scheduler*/, engine::Hash /*strand*/, engine::task::any && data)
+				{
+					if (!debug_assert(data.type_id() == utility::type_id<Data *>()))
+						return;
+
+					Data * const d = utility::any_cast<Data *>(data);
+
+					if (++d->started == max_threads)
+					{
+						d->all_started.set();
+					}
+
+					if (d->all_started.wait(timeout))
+					{
+						d->parallel++;
+					}
+
+					if (++d->finished == 2 * max_threads)
+					{
+						d->all_finished.set();
+					}
+				},
+				engine::task::any(&data));
+		}
 	}
+
+	REQUIRE(data.all_finished.wait(timeout * (2 * max_threads + 1)));
+	CHECK(data.parallel == 2 * max_threads);
 }
+
+#endif
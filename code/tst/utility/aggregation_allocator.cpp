@@ -1,4 +1,5 @@
 #include "utility/aggregation_allocator.hpp"
+#include "utility/aligned_allocator.hpp"
 #include "utility/heap_allocator.hpp"
 #include "utility/null_allocator.hpp"
 
@@ -102,3 +103,19 @@ TEST_CASE("aggregation allocator (heap, char, char, short, int) can allocate non
 	aa.destroy(p);
 	aa.deallocate(p, 1);
 }
+
+TEST_CASE("aggregation allocator (aligned, char, char, short, int) aligns every column", "[allocator][utility]")
+{
+	utility::aggregation_allocator<utility::aligned_to<utility::cache_line_alignment>::allocator, char, char, short, int> aa;
+
+	char * const p = aa.allocate(3);
+	REQUIRE(p);
+
+	CHECK(reinterpret_cast<std::uintptr_t>(p) % utility::cache_line_alignment == 0);
+	CHECK(reinterpret_cast<std::uintptr_t>(aa.address<0>(p, 3)) % utility::cache_line_alignment == 0);
+	CHECK(reinterpret_cast<std::uintptr_t>(aa.address<1>(p, 3)) % utility::cache_line_alignment == 0);
+	CHECK(reinterpret_cast<std::uintptr_t>(aa.address<2>(p, 3)) % utility::cache_line_alignment == 0);
+	CHECK(static_cast<void *>(aa.address<0>(p, 3)) != static_cast<void *>(p));
+
+	aa.deallocate(p, 3);
+}
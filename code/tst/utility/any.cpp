@@ -50,7 +50,7 @@ TEST_CASE("any empty", "[utility][any]")
 
 TEST_CASE("any small", "[utility][any]")
 {
-	static_assert(std::is_same<utility::detail::any_small<int>, utility::detail::any_data::any_type<int>>::value, "expected int to be a small type");
+	static_assert(std::is_same<utility::detail::any_small<sizeof(void *), int>, utility::detail::any_data<sizeof(void *)>::any_type<int>>::value, "expected int to be a small type");
 
 	utility::any a1(utility::in_place_type<int>, 1);
 	CHECK(a1.has_value());
@@ -124,7 +124,7 @@ TEST_CASE("any small", "[utility][any]")
 
 TEST_CASE("any big", "[utility][any]")
 {
-	static_assert(std::is_same<utility::detail::any_big<std::string>, utility::detail::any_data::any_type<std::string>>::value, "expected std::string to be a big type");
+	static_assert(std::is_same<utility::detail::any_big<sizeof(void *), std::string>, utility::detail::any_data<sizeof(void *)>::any_type<std::string>>::value, "expected std::string to be a big type");
 
 	utility::any a1(utility::in_place_type<std::string>, "111");
 	CHECK(a1.has_value());
@@ -234,3 +234,24 @@ TEST_CASE( "any reset", "[utility][any]" )
 		CHECK(a1.type_id() == utility::type_id<void>());
 	}
 }
+
+TEST_CASE("any with a bigger buffer", "[utility][any]")
+{
+	using big_any = utility::basic_any<4 * sizeof(std::string)>;
+	static_assert(std::is_same<utility::detail::any_small<4 * sizeof(std::string), std::string>, utility::detail::any_data<4 * sizeof(std::string)>::any_type<std::string>>::value, "expected std::string to be a small type");
+
+	const std::size_t spills = utility::any_spill_count();
+
+	big_any a1(std::string("111"));
+	CHECK(utility::any_spill_count() == spills);
+	REQUIRE(a1.type_id() == utility::type_id<std::string>());
+	CHECK(utility::any_cast<std::string>(a1) == "111");
+
+	big_any a2 = std::move(a1);
+	CHECK(!a1.has_value());
+	REQUIRE(a2.type_id() == utility::type_id<std::string>());
+	CHECK(utility::any_cast<std::string>(a2) == "111");
+
+	utility::any a3(std::string("111"));
+	CHECK(utility::any_spill_count() == spills + 1);
+}
@@ -36,6 +36,22 @@ namespace
 
 	ext::usize construction_counter::construction_count = ext::usize(-1);
 	ext::usize construction_counter::destruction_count = ext::usize(-1);
+
+	// owns its value, but does not care where it lives
+	struct relocatable_box
+	{
+		std::unique_ptr<int> value;
+
+		explicit relocatable_box(int value)
+			: value(new int(value))
+		{}
+	};
+}
+
+namespace utility
+{
+	template <>
+	struct is_trivially_relocatable<relocatable_box> : mpl::true_type {};
 }
 
 TEST_CASE("", "")
@@ -613,3 +629,55 @@ TEST_CASE("heap vector", "[utility][container][vector]")
 		}
 	}
 }
+
+TEST_CASE("heap vector of trivially relocatable items", "[utility][container][vector]")
+{
+	static_assert(utility::storage_traits<utility::heap_storage<int>>::unpacked::reallocatable::value, "");
+	static_assert(utility::storage_traits<utility::heap_storage<relocatable_box>>::unpacked::reallocatable::value, "");
+	static_assert(!utility::storage_traits<utility::heap_storage<construction_counter>>::unpacked::reallocatable::value, "");
+	static_assert(!utility::storage_traits<utility::heap_storage<int, double>>::unpacked::reallocatable::value, "");
+
+	SECTION("keeps its items when growing")
+	{
+		utility::heap_vector<int> a;
+		for (int i = 0; i < 100000; i++)
+		{
+			REQUIRE(a.try_emplace_back(i));
+		}
+		REQUIRE(a.size() == 100000);
+		CHECK(a.capacity() >= 100000);
+		CHECK(a.data()[0] == 0);
+		CHECK(a.data()[99999] == 99999);
+	}
+
+	SECTION("moves nontrivial items without touching them")
+	{
+		utility::heap_vector<relocatable_box> a;
+		for (int i = 0; i < 1000; i++)
+		{
+			REQUIRE(a.try_emplace_back(i));
+		}
+		REQUIRE(a.size() == 1000);
+		CHECK(*a.data()[0].value == 0);
+		CHECK(*a.data()[999].value == 999);
+	}
+}
+
+TEST_CASE("aligned heap vector", "[utility][container][vector]")
+{
+	utility::aligned_heap_vector<utility::simd_alignment, float, double> vector;
+
+	for (int i = 0; i < 100; i++)
+	{
+		REQUIRE(vector.try_emplace_back(float(i), double(i)));
+
+		CHECK(reinterpret_cast<std::uintptr_t>(std::get<0>(vector.data())) % utility::simd_alignment == 0);
+		CHECK(reinterpret_cast<std::uintptr_t>(std::get<1>(vector.data())) % utility::simd_alignment == 0);
+	}
+	CHECK(std::get<0>(vector.data())[99] == 99.f);
+	CHECK(std::get<1>(vector.data())[99] == 99.);
+
+	utility::aligned_heap_vector<utility::page_alignment, char> big;
+	REQUIRE(big.try_emplace_back('a'));
+	CHECK(reinterpret_cast<std::uintptr_t>(big.data()) % utility::page_alignment == 0);
+}
@@ -0,0 +1,97 @@
+#include "utility/container/vector.hpp"
+#include "utility/frame_allocator.hpp"
+
+#include <catch2/catch.hpp>
+
+TEST_CASE("frame arena hands out aligned memory from a single block", "[allocator][utility]")
+{
+	utility::frame_arena arena;
+	REQUIRE(arena.reserve(1024));
+
+	void * const a = arena.allocate(1);
+	void * const b = arena.allocate(3);
+	CHECK(arena.owns(a));
+	CHECK(arena.owns(b));
+	CHECK(a != b);
+	CHECK(reinterpret_cast<std::uintptr_t>(b) % alignof(std::max_align_t) == 0);
+
+	CHECK(arena.current_frame().allocations == 2);
+	CHECK(arena.current_frame().used == 2 * alignof(std::max_align_t));
+	CHECK(arena.current_frame().overflows == 0);
+}
+
+TEST_CASE("frame arena gives back the latest allocation", "[allocator][utility]")
+{
+	utility::frame_arena arena;
+	REQUIRE(arena.reserve(1024));
+
+	void * const a = arena.allocate(16);
+	void * const b = arena.allocate(16);
+
+	arena.deallocate(a, 16);
+	CHECK(arena.current_frame().used == arena.current_frame().peak);
+
+	arena.deallocate(b, 16);
+	CHECK(arena.allocate(32) == b);
+}
+
+TEST_CASE("frame arena overflows to the heap and grows on reset", "[allocator][utility]")
+{
+	utility::frame_arena arena;
+	REQUIRE(arena.reserve(64));
+
+	void * const a = arena.allocate(64);
+	void * const b = arena.allocate(64);
+	CHECK(arena.owns(a));
+	CHECK_FALSE(arena.owns(b));
+	CHECK(arena.current_frame().overflows == 1);
+
+	arena.deallocate(b, 64);
+	arena.reset();
+
+	CHECK(arena.last_frame().allocations == 2);
+	CHECK(arena.last_frame().peak == 64);
+	CHECK(arena.last_frame().overflows == 1);
+	CHECK(arena.last_frame().overflow_bytes == 64);
+	CHECK(arena.current_frame().allocations == 0);
+	CHECK(arena.capacity() >= 128);
+
+	CHECK(arena.owns(arena.allocate(64)));
+	CHECK(arena.owns(arena.allocate(64)));
+	CHECK(arena.current_frame().overflows == 0);
+}
+
+TEST_CASE("frame arena cannot be replaced while in use", "[allocator][utility]")
+{
+	utility::frame_arena arena;
+	REQUIRE(arena.reserve(64));
+
+	fiw_unused(arena.allocate(1));
+	CHECK_FALSE(arena.reserve(128));
+
+	arena.reset();
+	CHECK(arena.reserve(128));
+}
+
+TEST_CASE("frame vector allocates from the thread arena", "[allocator][utility]")
+{
+	utility::frame_arena & arena = utility::frame_arena::this_thread();
+	arena.reset();
+
+	{
+		utility::frame_vector<int, double> vector;
+		for (int i = 0; i < 100; i++)
+		{
+			REQUIRE(vector.try_emplace_back(i, i * .5));
+		}
+		CHECK(arena.owns(std::get<0>(vector.data())));
+		CHECK(vector.size() == 100);
+		CHECK(std::get<0>(vector.data())[99] == 99);
+		CHECK(std::get<1>(vector.data())[99] == 49.5);
+	}
+
+	CHECK(arena.current_frame().allocations > 0);
+	arena.reset();
+	CHECK(arena.current_frame().used == 0);
+	CHECK(arena.last_frame().overflows == 0);
+}
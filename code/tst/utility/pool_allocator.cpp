@@ -0,0 +1,128 @@
+#include "core/async/Thread.hpp"
+
+#include "utility/pool_allocator.hpp"
+#include "utility/shared_ptr.hpp"
+#include "utility/weak_ptr.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+	// every test uses blocks of its own size, so that the pools do not
+	// share statistics
+	template <std::size_t Size>
+	struct Block
+	{
+		char data[Size];
+	};
+}
+
+TEST_CASE("pool allocator reuses freed blocks", "[allocator][utility]")
+{
+	using allocator = utility::pool_allocator<Block<1000>>;
+	allocator a;
+
+	Block<1000> * const p = a.allocate(1);
+	REQUIRE(p);
+	CHECK(reinterpret_cast<std::uintptr_t>(p) % alignof(std::max_align_t) == 0);
+	CHECK(allocator::stats().live == 1);
+
+	a.deallocate(p, 1);
+	CHECK(allocator::stats().live == 0);
+	CHECK(allocator::stats().peak == 1);
+
+	Block<1000> * const q = a.allocate(1);
+	CHECK(q == p);
+	a.deallocate(q, 1);
+}
+
+TEST_CASE("pool allocator grows by whole slabs", "[allocator][utility]")
+{
+	using allocator = utility::pool_allocator<Block<1100>>;
+	allocator a;
+
+	std::vector<Block<1100> *> blocks;
+	for (int i = 0; i < 200; i++)
+	{
+		blocks.push_back(a.allocate(1));
+		REQUIRE(blocks.back());
+	}
+	std::sort(blocks.begin(), blocks.end());
+	CHECK(std::adjacent_find(blocks.begin(), blocks.end()) == blocks.end());
+
+	CHECK(allocator::stats().live == 200);
+	CHECK(allocator::stats().peak == 200);
+	CHECK(allocator::stats().slabs == (200 + allocator::pool_type::blocks_per_slab - 1) / allocator::pool_type::blocks_per_slab);
+
+	for (auto block : blocks)
+	{
+		a.deallocate(block, 1);
+	}
+	CHECK(allocator::stats().live == 0);
+}
+
+TEST_CASE("pool allocator gives arrays to the heap", "[allocator][utility]")
+{
+	using allocator = utility::pool_allocator<Block<1200>>;
+	allocator a;
+
+	Block<1200> * const p = a.allocate(3);
+	REQUIRE(p);
+	CHECK(allocator::stats().live == 0);
+	a.deallocate(p, 3);
+}
+
+TEST_CASE("pool allocator is shared between threads", "[allocator][utility]")
+{
+	using allocator = utility::pool_allocator<Block<1300>>;
+
+	core::async::Thread threads[4];
+	for (auto & thread : threads)
+	{
+		thread = core::async::Thread([]()
+		{
+			allocator a;
+			std::vector<Block<1300> *> blocks;
+			for (int j = 0; j < 1000; j++)
+			{
+				blocks.push_back(a.allocate(1));
+				blocks.back()->data[0] = 1;
+				if (j % 3 == 0)
+				{
+					a.deallocate(blocks[j / 2], 1);
+					blocks[j / 2] = a.allocate(1);
+				}
+			}
+			for (auto block : blocks)
+			{
+				a.deallocate(block, 1);
+			}
+		});
+	}
+
+	for (auto & thread : threads)
+	{
+		thread.join();
+	}
+	CHECK(allocator::stats().live == 0);
+	CHECK(allocator::stats().peak >= 1000);
+}
+
+TEST_CASE("pool shared ptr", "[allocator][utility]")
+{
+	using allocator = utility::pool_allocator<ext::detail::shared_data<Block<1400>>>;
+
+	ext::pool_shared_ptr<Block<1400>> s(utility::in_place);
+	REQUIRE(s);
+	CHECK(allocator::stats().live == 1);
+
+	ext::pool_weak_ptr<Block<1400>> w = s;
+	s.reset();
+	CHECK(allocator::stats().live == 1);
+
+	w.reset();
+	CHECK(allocator::stats().live == 0);
+}
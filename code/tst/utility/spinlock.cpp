@@ -0,0 +1,117 @@
+#include "core/async/delay.hpp"
+#include "core/async/Thread.hpp"
+
+#include "utility/spinlock.hpp"
+
+#include <catch2/catch.hpp>
+
+#include <mutex>
+
+namespace
+{
+	template <typename Lock>
+	struct Counter
+	{
+		Lock & lock;
+		int count_per_thread;
+		int count;
+
+		static core::async::thread_return thread_decl count_up(core::async::thread_param arg)
+		{
+			Counter & counter = *static_cast<Counter *>(arg);
+
+			for (int j = 0; j < counter.count_per_thread; j++)
+			{
+				std::lock_guard<Lock> guard(counter.lock);
+				counter.count++;
+			}
+			return core::async::thread_return{};
+		}
+	};
+
+	template <typename Lock>
+	int count_concurrently(Lock & lock, int count_per_thread)
+	{
+		Counter<Lock> counter{lock, count_per_thread, 0};
+
+		core::async::Thread threads[4];
+		for (auto & thread : threads)
+		{
+			thread = core::async::Thread(Counter<Lock>::count_up, &counter);
+		}
+
+		for (auto & thread : threads)
+		{
+			thread.join();
+		}
+		return counter.count;
+	}
+
+	template <typename Lock>
+	core::async::thread_return thread_decl lock_and_unlock(core::async::thread_param arg)
+	{
+		Lock & lock = *static_cast<Lock *>(arg);
+
+		lock.lock();
+		lock.unlock();
+		return core::async::thread_return{};
+	}
+}
+
+TEMPLATE_TEST_CASE("spinlock", "[utility]", utility::spinlock, utility::ticket_spinlock, utility::instrumented_spinlock, utility::instrumented_ticket_spinlock)
+{
+	TestType lock;
+
+	SECTION("can only be taken once")
+	{
+		CHECK(lock.try_lock());
+		CHECK_FALSE(lock.try_lock());
+		lock.unlock();
+		CHECK(lock.try_lock());
+		lock.unlock();
+	}
+
+	SECTION("is mutually exclusive")
+	{
+		CHECK(count_concurrently(lock, 10000) == 4 * 10000);
+	}
+}
+
+TEMPLATE_TEST_CASE("instrumented spinlock", "[utility]", utility::instrumented_spinlock, utility::instrumented_ticket_spinlock)
+{
+	TestType lock;
+
+	SECTION("counts acquisitions")
+	{
+		lock.lock();
+		lock.unlock();
+		CHECK(lock.try_lock());
+		CHECK_FALSE(lock.try_lock());
+		lock.unlock();
+
+		const auto stats = lock.stats();
+		CHECK(stats.acquisitions == 2);
+		CHECK(stats.contended == 0);
+		CHECK(stats.spins == 0);
+		CHECK(stats.wait_nanoseconds == 0);
+		CHECK(stats.max_wait_nanoseconds == 0);
+	}
+
+	SECTION("counts waits")
+	{
+		lock.lock();
+
+		core::async::Thread thread(lock_and_unlock<TestType>, &lock);
+
+		core::async::delay(10);
+		lock.unlock();
+		thread.join();
+
+		const auto stats = lock.stats();
+		CHECK(stats.acquisitions == 2);
+		CHECK(stats.contended == 1);
+		CHECK(stats.spins > 0);
+		CHECK(stats.wait_nanoseconds > 0);
+		CHECK(stats.max_wait_nanoseconds == stats.wait_nanoseconds);
+	}
+}